@@ -0,0 +1,41 @@
+# cmake -DINPUTS=<a.spv|b.spv|...> -DOUTPUT=<file.cpp> -P embed_spirv.cmake
+# writes every SPIR-V binary as a constexpr word array plus the table behind GetEmbeddedShader
+# inputs are "|" separated because ";" does not survive add_custom_command arguments
+
+string(REPLACE "|" ";" INPUTS "${INPUTS}")
+
+set(ARRAYS "")
+set(ENTRIES "")
+foreach (input IN LISTS INPUTS)
+	get_filename_component(name ${input} NAME_WE)
+	string(TOUPPER ${name} arrayName)
+
+	file(READ ${input} hex HEX)
+	# SPIR-V is a stream of little endian 32 bit words
+	string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1," words "${hex}")
+
+	string(APPEND ARRAYS "\tuint32_t constexpr ${arrayName}[]{ ${words} };\n")
+	if (ENTRIES STREQUAL "")
+		string(APPEND ENTRIES "\t\tEmbeddedShader{ \"${name}\", ${arrayName} }\n")
+	else ()
+		string(APPEND ENTRIES "\t\t, EmbeddedShader{ \"${name}\", ${arrayName} }\n")
+	endif ()
+endforeach ()
+
+file(WRITE ${OUTPUT}
+     "// generated by cmake/embed_spirv.cmake from the compiled shaders, do not edit\n"
+     "#include \"embedded_shaders.h\"\n"
+     "\n"
+     "namespace\n"
+     "{\n"
+     "${ARRAYS}"
+     "\n"
+     "\tEmbeddedShader constexpr SHADERS[]{\n"
+     "${ENTRIES}"
+     "\t};\n"
+     "}\n"
+     "\n"
+     "std::span<EmbeddedShader const> GetEmbeddedShaders()\n"
+     "{\n"
+     "\treturn SHADERS;\n"
+     "}\n")
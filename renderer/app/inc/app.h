@@ -1,14 +1,29 @@
 #ifndef APP_H
 #define APP_H
+#include <array>
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <optional>
+#include <span>
 
 #include "buffer.h"
 #include "context.h"
 #include "camera.h"
 #include "descriptor_set.h"
+#include "launch_options.h"
+#include "lut_baker.h"
+#include "sky_history.h"
+#include "skyview_schedule.h"
+#include "sweep.h"
+#include "tracer.h"
 #include "VkBootstrap.h"
 
+class FrameTimer;
+class ImageWriter;
+class PipelineCache;
 class TimingQueryPool;
+class VolumeImage;
 
 namespace vkc
 {
@@ -20,14 +35,27 @@ namespace vkc
 	class Image;
 	class Pipeline;
 	class PipelineLayout;
+	class ShaderStage;
 }
 
 class App final
 {
+	static uint32_t constexpr HEADLESS_FRAMES_IN_FLIGHT{ 2 };
+	static size_t constexpr   IMAGE_WRITER_QUEUE_DEPTH{ 8 }; // readbacks waiting for a writer thread, also lent batch readback slots
+	static size_t constexpr   FRAME_LOG_CAPACITY{ 1024 };    // frame records waiting for the log writer
+	static size_t constexpr   TRACE_CAPACITY{ 1 << 18 };     // trace events kept in memory, about 10 MB
+	// amortized sky-view updates fall back to a full redraw past these, see SkyviewSchedule
+	static float constexpr SKYVIEW_MAX_SUN_DRIFT{ .0175f };     // radians, about one degree
+	static float constexpr SKYVIEW_MAX_ALTITUDE_DRIFT{ 100.f }; // meters
+	// the temporal sky reprojects the previous frame unless one of these changed more within a frame
+	static float constexpr SKY_HISTORY_MAX_SUN_DRIFT{ .0175f };    // radians, about one degree
+	static float constexpr SKY_HISTORY_MAX_CAMERA_DRIFT{ 100.f };  // meters
+	static float constexpr SKY_HISTORY_MAX_ROTATION{ .35f };       // radians of camera forward, about 20 degrees
+
 public:
 	template<typename T>
 	using uptr = std::unique_ptr<T>;
-	App(int width, int height);
+	explicit App(LaunchOptions options);
 	~App();
 
 	App(App&&)                 = delete;
@@ -36,6 +64,9 @@ public:
 	App& operator=(App&&)      = delete;
 
 	void Run();
+	// sweep only, called instead of Run, renders the benchmark views in linear HDR with and without the sky-view LUT
+	// and takes the median GPU time of every pass at the launch QualitySettings
+	[[nodiscard]] QualityMeasurement MeasureQuality();
 
 	static void KeyCallback(GLFWwindow* window, int key, int, int action, int)
 	{
@@ -45,16 +76,42 @@ public:
 		{
 			app->m_UseSkyview = !app->m_UseSkyview;
 		}
+		if (key == GLFW_KEY_F2 && action == GLFW_PRESS)
+		{
+			app->m_RequestedTier = static_cast<QualityTier>((static_cast<uint32_t>(app->m_Options.Tier) + 1) % QUALITY_TIER_COUNT);
+		}
 	}
 
 private:
 	std::tuple<vkc::Pipeline, vkc::Image, vkc::ImageView> GenerateTempImageAndPipeline(bool hdr);
 	void                                                  RenderSkyToImage
 	(vkc::CommandBuffer& commandBuffer, vkc::Image& stagingImage, vkc::ImageView& stagingImageView, vkc::Pipeline& pipeline);
+	// benchmark only, the sky ray marched at 1/skyScale resolution over a cleared depth buffer and upsampled into the staging image
+	void RenderLowResSkyToImage
+	(vkc::CommandBuffer& commandBuffer, vkc::Image& stagingImage, vkc::ImageView& stagingImageView, uint32_t skyScale);
 
 	void RenderAtmosphereToAFile(bool hdr = false);
 	void ProfilePipelinesAndDump();
 	void RenderAllConfigsToFiles();
+	// renders every job of the manifest, readback buffers form a ring so the next job renders while the last one is written
+	void RenderBatch();
+	// bakes the static LUTs on 1, 2, 4... threads up to every hardware thread and diffs them against the GPU LUTs
+	void BenchmarkLUTBake();
+	// times every pass of the fixed scenario suite in benchmark.h and writes the results as json
+	void RunBenchmark();
+	// RGBA16F targets are read back as four planes by a compute pass, slot selects a descriptor set bound by BindPlanarReadback
+	void RecordReadback(vkc::CommandBuffer& commandBuffer, vkc::Image& image, vkc::Buffer& buffer, uint32_t slot);
+	void BindPlanarReadback(uint32_t slot, vkc::ImageView& imageView, vkc::Buffer& buffer);
+	void RecordPlanarReadback(vkc::CommandBuffer& commandBuffer, vkc::Image& image, uint32_t slot);
+	// path without extension, the format picks .exr or .png
+	// queued on m_ImageWriter, which encodes straight from pixels and calls release once it no longer reads them
+	void SaveImage(void const* pixels, VkExtent2D extent, bool hdr, std::filesystem::path path, std::function<void()> release) const;
+
+	void RunWindowed();
+
+	[[nodiscard]] float GetSceneTime() const;
+	// mirrors GetSunAltitude in atmosphere_functions.glsl
+	[[nodiscard]] float GetSunAltitude() const;
 
 	void CreateWindow(int width, int height);
 	void CreateInstance();
@@ -62,6 +119,8 @@ private:
 	void CreateDevice();
 	void CreateSwapchain();
 	void CreateSyncObjects();
+	// interactive only, skipped for queues without timestamp support, also feed the tracer when --trace is set
+	void CreateFrameTimers();
 	void CreateDescriptorPool();
 	void CreateDescriptorSets();
 	void CreateVertexBuffer();
@@ -69,30 +128,169 @@ private:
 	void CreateCmdPool();
 	void CreateDescriptorSetLayouts();
 	void CreateResources();
+	// the LUT images, pipelines and descriptor sets below depend on m_Options.Quality and are built again for every tier
+	void CreateLUTImages();
+	void CreateLUTPipelines();
+	void CreateComputeLUTPipelines();
 	void CreateDepth();
+	// sky target of --sky-scale, null at full resolution, the benchmark always creates it at half resolution
+	// with --sky-temporal it holds the shaded pattern, and a full resolution history is created per frame in flight
+	void CreateLowResSky();
+	void DestroyLowResSky();
+	// depth and low resolution sky of the frame sets, again after the swapchain is recreated
+	void WriteRenderTargetDescriptors(std::span<vkc::DescriptorSet> descriptorSets);
 	void GenerateTransmittanceLUT(vkc::CommandBuffer& commandBuffer);
 	void GenerateMultScatteringLUT(vkc::CommandBuffer& commandBuffer);
-	void GenerateSkyviewLUT(vkc::CommandBuffer& commandBuffer);
+	// empty rows redraw the whole sky-view LUT, otherwise only the listed bands are redrawn and the rest is kept
+	void GenerateSkyviewLUT(vkc::CommandBuffer& commandBuffer, std::span<SkyviewRows const> rows = {});
+	// compute variants, readerStages are the stages other than compute that sample the LUT on the recording queue
+	void CreateComputePipelines();
+	void DispatchLUT
+	(
+		vkc::CommandBuffer&     commandBuffer
+		, vkc::Image&           image
+		, VkPipeline            pipeline
+		, vkc::DescriptorSet&   descriptorSet
+		, VkPipelineStageFlags2 readerStages
+		, std::span<SkyviewRows const> rows = {}
+	);
+	void GenerateTransmittanceLUTCompute(vkc::CommandBuffer& commandBuffer);
+	void GenerateMultScatteringLUTCompute(vkc::CommandBuffer& commandBuffer);
+	// cumulative optical depth to the top of the atmosphere, compute only since it is neither baked on the CPU nor cached
+	void GenerateOpticalDepthLUT(vkc::CommandBuffer& commandBuffer);
+	void GenerateSkyviewLUTCompute
+	(vkc::CommandBuffer& commandBuffer, VkPipelineStageFlags2 readerStages, std::span<SkyviewRows const> rows = {});
+	void RecordSkyviewLUT(vkc::CommandBuffer& commandBuffer, std::span<SkyviewRows const> rows = {});
+	// sky-view LUT for evenly spaced sun elevations at a fixed camera, the per-frame LUT blends the two nearest slices
+	// rebaked once the camera moved SKYVIEW_MAX_ALTITUDE_DRIFT away from the baked altitude
+	void UpdateSkyviewArray();
+	// offline commands move the camera between bakes, they march the sky-view LUT while the array is stale
+	[[nodiscard]] bool IsSkyviewArrayCurrent() const;
+	void BakeSkyviewArray(vkc::CommandBuffer& commandBuffer);
+	void ResolveSkyviewArray(vkc::CommandBuffer& commandBuffer, VkPipelineStageFlags2 readerStages);
+	void PushComputeConstants(vkc::CommandBuffer& commandBuffer) const;
+	// in-scattering and transmittance of the first kilometers of every camera ray, sampled by the geometry pass
+	void GenerateAerialPerspective(vkc::CommandBuffer& commandBuffer);
+	// toGraphics moves the freshly written LUT to the sky pass, otherwise the sampled LUT goes back to the compute queue
+	void TransferSkyviewOwnership(vkc::CommandBuffer& commandBuffer, bool toGraphics, bool release);
+	// transmittance and multiple scattering only depend on atmosphere constants and m_Spectral
+	void InvalidateStaticLUTs();
+	void UpdateStaticLUTs();
+	void UploadStaticLUTs(std::span<std::byte const> transmittance, std::span<std::byte const> multScattering);
+	void CopyLUTToBuffer(vkc::CommandBuffer& commandBuffer, vkc::Image& image, vkc::Buffer& buffer, VkDeviceSize offset);
+	[[nodiscard]] BakedLUTs BakeStaticLUTsOnCpu(uint32_t threadCount) const;
+
+	// constant_id 0 is m_Spectral, 1 to 5 the ray march settings of QualitySettings, 6 writes march steps to alpha for the sweep
+	// and 7 switches the ray march to the optical depth LUT
+	[[nodiscard]] std::array<uint32_t, 8> GetSpecializationConstants() const;
+	void                                  AddSpecializationConstants(vkc::ShaderStage& stage) const;
+
+	[[nodiscard]] uint64_t      CalculateLUTCacheKey() const;
+	[[nodiscard]] static size_t GetLUTByteSize(vkc::Image const& image);
+
+	void ReportFirstPixel();
 	void RecreateSwapchain();
-	void RecordCommandBuffer(vkc::CommandBuffer& commandBuffer, size_t imageIndex);
+	void RecordCommandBuffer(vkc::CommandBuffer& commandBuffer, size_t imageIndex, std::span<SkyviewRows const> skyviewRows);
+	void RecordGeometryPass(vkc::CommandBuffer& commandBuffer, size_t imageIndex);
+	void RecordSkyPass(vkc::CommandBuffer& commandBuffer, size_t imageIndex);
+	// fullscreen triangle with the frame set and the sky push constants over extent from the top left of target
+	// depthTest binds the depth image as a read only attachment, it has to be in attachment or depth read only layout
+	void DrawFullscreenSky
+	(
+		vkc::CommandBuffer&  commandBuffer
+		, VkImageView        target
+		, VkExtent2D         extent
+		, VkAttachmentLoadOp loadOp
+		, vkc::Pipeline&     pipeline
+		, uint32_t           skyScale
+		, bool               depthTest
+	);
+	// ray marches into m_LowResSkyImage and upsamples it into target with the depth aware filter of sky_upsample.frag
+	void RecordLowResSky(vkc::CommandBuffer& commandBuffer, VkImageView target, uint32_t skyScale);
+	// ray marches the pattern of m_SkyFrame, fills the other pixels from the previous frame's history and composites into target
+	void RecordTemporalSky(vkc::CommandBuffer& commandBuffer, VkImageView target);
+	// mirrors FindCameraRay in sky_rays.glsl, right, up and forward around the planet up rather than the view matrix's world up
+	[[nodiscard]] glm::mat3 GetSkyRayBasis() const;
+	// ray marched pixels over all pixels of the sky pass this frame, written to the frame log
+	[[nodiscard]] float GetSkyShadedFraction() const;
 	void Submit(vkc::CommandBuffer& commandBuffer) const;
+	// sky-view LUT on the dedicated compute queue overlapping the geometry pass
+	void RecordAndSubmitAsyncFrame(vkc::CommandBuffer& commandBuffer, size_t imageIndex, std::span<SkyviewRows const> skyviewRows);
+	void ReportSkyviewStaleness() const;
+	void ReportSkyHistory() const;
+	void ReportFrameTimings() const;
+	// interactive only, waits for the device, reports the GPU time of the outgoing tier and swaps in the resources of the new one
+	// a tier is built the first time it is selected and kept until exit, so switching back only waits for the device
+	void SelectQualityTier(QualityTier tier);
+	// GPU timestamp and matching steady_clock time, from VK_EXT_calibrated_timestamps when enabled, otherwise from a submission
+	[[nodiscard]] Tracer::Calibration CalibrateGpuClock();
 	void Present(uint32_t imageIndex);
 	void End();
 
+	std::chrono::steady_clock::time_point m_StartTime;
+
+	LaunchOptions m_Options;
+	bool const    m_Headless;
+
 	uptr<Camera> m_Camera;
 	vkc::Context m_Context{};
 
+	VkExtent2D m_RenderExtent{}; // swapchain extent when windowed, requested resolution when headless
+	VkFormat   m_ColorFormat{};
+
 	uptr<vkc::DescriptorSetLayout> m_FrameDescSetLayout{};
 	uptr<vkc::DescriptorPool>      m_DescPool{};
 
+	uptr<vkc::DescriptorSetLayout>  m_ComputeDescSetLayout{};
+	uptr<vkc::DescriptorPool>       m_ComputeDescPool{};
+	// transmittance, multiple scattering, sky-view, aerial perspective, sky-view array bake and resolve, optical depth
+	std::vector<vkc::DescriptorSet> m_ComputeDescriptorSets{};
+
+	// headless only, planar readback of hdr renders, one set per readback slot
+	uptr<vkc::DescriptorSetLayout>  m_ReadbackDescSetLayout{};
+	uptr<vkc::DescriptorPool>       m_ReadbackDescPool{};
+	std::vector<vkc::DescriptorSet> m_ReadbackDescriptorSets{};
+
 	uptr<vkc::PipelineLayout> m_PipelineLayout;
 	uptr<vkc::PipelineLayout> m_EmptyPipelineLayout;
+	uptr<vkc::PipelineLayout> m_ComputePipelineLayout;
+	uptr<vkc::PipelineLayout> m_ReadbackPipelineLayout;
 
 	uptr<vkc::Pipeline> m_Pipeline{};
 	uptr<vkc::Pipeline> m_TransmittancePipeline{};
 	uptr<vkc::Pipeline> m_MultipleScatteringPipeline{};
 	uptr<vkc::Pipeline> m_SkyviewPipeline{};
 	uptr<vkc::Pipeline> m_SkyRenderPipeline{};
+	uptr<vkc::Pipeline> m_LowResSkyPipeline{};  // null without m_LowResSkyImage, the shaded pattern with --sky-temporal
+	uptr<vkc::Pipeline> m_SkyUpsamplePipeline{}; // same, composites the history at scale 1 with --sky-temporal
+	uptr<vkc::Pipeline> m_SkyResolvePipeline{};  // --sky-temporal only
+
+	// push constants of every sky shader, the full resolution ones declare the block up to UseSkyView
+	struct SkyPushConstants
+	{
+		glm::vec3 CameraPosition;
+		float     Fov;
+		glm::vec3 CameraForward;
+		float     AspectRatio;
+		float     Time;
+		uint32_t  UseSkyView;
+		uint32_t  SkyScale;
+		uint32_t  SkyPhase;
+		glm::vec4 PreviousSkyBasis[3]; // mat3 columns are padded to vec4 in the shader block
+		uint32_t  HistoryValid;
+	};
+
+	uptr<vkc::ShaderStage>                m_FullscreenStage{};
+	std::array<uptr<vkc::ShaderStage>, 2> m_OfflineSkyStages{}; // sdr and hdr, built on first use
+
+	VkPipeline m_TransmittanceComputePipeline{};
+	VkPipeline m_MultScatteringComputePipeline{};
+	VkPipeline m_SkyviewComputePipeline{};
+	VkPipeline m_AerialPerspectivePipeline{};
+	VkPipeline m_SkyviewBakePipeline{};
+	VkPipeline m_OpticalDepthPipeline{};
+	VkPipeline m_SkyviewResolvePipeline{};
+	VkPipeline m_PlanarReadbackPipeline{};
 
 	uptr<vkc::Image>     m_SkyviewImage{};
 	uptr<vkc::ImageView> m_SkyviewImageView{};
@@ -103,15 +301,39 @@ private:
 	uptr<vkc::Image>     m_TransmittanceImage{};
 	uptr<vkc::ImageView> m_TransmittanceImageView{};
 
+	uptr<vkc::Image>     m_OpticalDepthImage{};
+	uptr<vkc::ImageView> m_OpticalDepthImageView{};
+
+	uptr<VolumeImage> m_AerialPerspectiveImage{};
+	uptr<VolumeImage> m_SkyviewArrayImage{};    // null unless --skyview-bake is set and compute LUTs are available
+	float             m_SkyviewArrayAltitude{}; // meters, the camera altitude the array was baked at
+
+	uptr<SkyviewSchedule> m_SkyviewSchedule{}; // interactive only, offline renders always redraw the whole sky-view LUT
+
 	VkFormat             m_DepthFormat{};
 	uptr<vkc::Image>     m_DepthImage{};
 	uptr<vkc::ImageView> m_DepthImageView{};
+	uptr<vkc::Image>     m_LowResSkyImage{}; // linear radiance and sky coverage, see sky_color_lowres.frag
+	uptr<vkc::ImageView> m_LowResSkyImageView{};
+	// --sky-temporal only, linear sky per frame in flight, the resolve of a frame reads the one of the frame before
+	std::vector<vkc::Image>     m_SkyHistoryImages{};
+	std::vector<vkc::ImageView> m_SkyHistoryImageViews{};
+	uptr<SkyHistory>            m_SkyHistory{};
+	SkyHistory::Frame           m_SkyFrame{};
 	VkSampler            m_Sampler{};
 
 	std::vector<vkc::Image>     m_SwapchainImages;
 	std::vector<vkc::ImageView> m_SwapchainImageViews;
 
 	uptr<vkc::CommandPool> m_CommandPool{};
+	uptr<vkc::CommandPool> m_GeometryCommandPool{}; // async compute only, one allocation per pool per frame
+	uptr<vkc::CommandPool> m_ComputeCommandPool{};
+
+	VkPhysicalDeviceProperties m_DeviceProperties{};
+
+	VkQueue  m_ComputeQueue{}; // dedicated compute queue, null when the device has none or compute LUTs are off
+	uint32_t m_GraphicsQueueFamily{};
+	uint32_t m_ComputeQueueFamily{};
 
 	uptr<vkc::Buffer>        m_VertexBuffer{};
 	std::vector<vkc::Buffer> m_MVPUBOs{};
@@ -122,12 +344,76 @@ private:
 	std::vector<VkSemaphore> m_RenderFinishedSemaphores{};
 	std::vector<VkFence>     m_InFlightFences{};
 
+	// async compute only, both count frames: the sky-view LUT of frame N is ready / frame N stopped sampling it
+	VkSemaphore m_LUTTimeline{};
+	VkSemaphore m_FrameTimeline{};
+	uint64_t    m_FrameNumber{};
+
 	uptr<TimingQueryPool> m_QueryPool;
+	uptr<PipelineCache>   m_PipelineCache;
+	uptr<ImageWriter>     m_ImageWriter; // headless only
+
+	// per-pass GPU time of the interactive loop, the sky-view LUT is timed on the compute timer when it runs on the dedicated queue
+	struct FrameScopes
+	{
+		uint32_t AerialPerspective{};
+		uint32_t Geometry{};
+		uint32_t SkyviewLUT{};
+		uint32_t Sky{};
+	};
+
+	uptr<FrameTimer> m_FrameTimer;
+	uptr<FrameTimer> m_ComputeFrameTimer;
+	FrameScopes      m_FrameScopes{};
+	uptr<Tracer>     m_Tracer; // interactive only, --trace
+
+	// everything built from QualitySettings, the active tier lives in the members above and the others are parked here
+	struct TierResources
+	{
+		uptr<vkc::Image>                TransmittanceImage;
+		uptr<vkc::ImageView>            TransmittanceImageView;
+		uptr<vkc::Image>                MultScatteringImage;
+		uptr<vkc::ImageView>            MultScatteringImageView;
+		uptr<vkc::Image>                SkyviewImage;
+		uptr<vkc::ImageView>            SkyviewImageView;
+		uptr<vkc::Image>                OpticalDepthImage;
+		uptr<vkc::ImageView>            OpticalDepthImageView;
+		uptr<VolumeImage>               SkyviewArrayImage;
+		float                           SkyviewArrayAltitude{};
+		uptr<SkyviewSchedule>           Schedule;
+		uptr<vkc::Pipeline>             TransmittancePipeline;
+		uptr<vkc::Pipeline>             MultipleScatteringPipeline;
+		uptr<vkc::Pipeline>             SkyviewPipeline;
+		uptr<vkc::Pipeline>             SkyRenderPipeline;
+		uptr<vkc::Pipeline>             LowResSkyPipeline;
+		uptr<vkc::Pipeline>             SkyResolvePipeline;
+		VkPipeline                      TransmittanceComputePipeline{};
+		VkPipeline                      MultScatteringComputePipeline{};
+		VkPipeline                      SkyviewComputePipeline{};
+		VkPipeline                      AerialPerspectivePipeline{};
+		VkPipeline                      SkyviewBakePipeline{};
+		VkPipeline                      OpticalDepthPipeline{};
+		std::vector<vkc::DescriptorSet> FrameDescriptorSets;
+		std::vector<vkc::DescriptorSet> ComputeDescriptorSets;
+		bool                            SkyviewReleased{ false };
+	};
+
+	void SwapTierResources(TierResources& tier);
+
+	std::array<TierResources, QUALITY_TIER_COUNT> m_Tiers{}; // the slot of the active tier is empty
+	std::optional<QualityTier>                    m_RequestedTier{};
 
 	uint32_t m_FramesInFlight{};
 	uint32_t m_CurrentFrame{};
 
 	bool       m_UseSkyview{ false };
+	bool       m_StaticLUTsDirty{ true };
+	bool       m_SkyviewArrayDirty{ true };
+	bool       m_LUTCacheHit{ false };
+	bool       m_FirstPixelReported{ false };
+	bool       m_ComputeLUTs{ false };
+	bool       m_CalibratedTimestamps{ false }; // the device and steady_clock time domains can be sampled together
+	bool       m_SkyviewReleased{ false };      // async compute only, the last sky pass released the sky-view LUT to the compute queue
 	bool const m_Spectral{ true }; // requires changes made to pipelines, not adapted for runtime toggle
 };
 
@@ -0,0 +1,84 @@
+#ifndef VULKANRESEARCH_BENCHMARK_H
+#define VULKANRESEARCH_BENCHMARK_H
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+struct BenchmarkScenario
+{
+	std::string Name;
+	glm::vec3   CameraPosition; // meters, like --camera
+	glm::vec3   CameraForward;
+	float       Time; // seconds fed to GetSunAltitude
+};
+
+// fixed suite so results stay comparable between builds and machines, every scenario renders with and without the sky-view LUT
+std::vector<BenchmarkScenario> GetBenchmarkScenarios();
+
+struct PassSamples
+{
+	std::string         Name;
+	std::vector<double> Milliseconds;
+};
+
+struct ScenarioResult
+{
+	BenchmarkScenario        Scenario;
+	std::vector<PassSamples> Passes;
+};
+
+struct BenchmarkDevice
+{
+	std::string Name;
+	uint32_t    VendorID;
+	uint32_t    DeviceID;
+	uint32_t    DriverVersion;
+	uint32_t    ApiVersion;
+};
+
+struct BenchmarkSettings
+{
+	uint32_t    Width;
+	uint32_t    Height;
+	uint32_t    Samples;
+	uint32_t    BatchRepetitions; // 0 when every sample was submitted on its own
+	uint32_t    BatchWarmup;
+	bool        Spectral;
+	bool        ComputeLUTs;
+	std::string Quality; // name of the quality tier, see QualityTier
+	bool        AdaptiveMarch;
+	bool        OpticalDepthLUT;
+};
+
+struct SampleSummary
+{
+	double Min{};
+	double P5{};
+	double Median{};
+	double P95{};
+	double P99{};
+	double MedianAbsoluteDeviation{};
+	double MedianLow{}; // 95% confidence interval of the median
+	double MedianHigh{};
+	size_t Count{};
+};
+
+// nearest-rank percentiles, the median interval comes from order statistics and assumes independent samples
+[[nodiscard]] SampleSummary Summarize(std::vector<double> samples);
+
+// static passes do not depend on the scenario and are timed once
+// throws std::runtime_error when the file cannot be written
+void WriteBenchmarkResults
+(
+	std::filesystem::path const&      path
+	, BenchmarkDevice const&          device
+	, BenchmarkSettings const&        settings
+	, std::span<PassSamples const>    staticPasses
+	, std::span<ScenarioResult const> scenarios
+);
+
+#endif //VULKANRESEARCH_BENCHMARK_H
@@ -83,6 +83,24 @@ public:
 		RecalculateProjection();
 	}
 
+	void SetFov(float fov)
+	{
+		m_Fov = fov;
+		RecalculateProjection();
+	}
+
+	void SetPosition(glm::vec3 const& position)
+	{
+		m_Position = position;
+	}
+
+	void SetForward(glm::vec3 const& forward)
+	{
+		m_Forward    = glm::normalize(forward);
+		m_TotalYaw   = glm::degrees(atan2f(m_Forward.z, m_Forward.x));
+		m_TotalPitch = glm::degrees(asinf(m_Forward.y));
+	}
+
 	[[nodiscard]] float GetFov() const
 	{
 		return m_Fov;
@@ -0,0 +1,20 @@
+#ifndef VULKANRESEARCH_COMPUTEPIPELINE_H
+#define VULKANRESEARCH_COMPUTEPIPELINE_H
+#include <cstdint>
+#include <span>
+
+#include "context.h"
+#include "pipeline_cache.h"
+
+// vkc::PipelineBuilder only covers graphics pipelines
+// specialization constants are assigned to constant_id 0, 1, ... in the given order
+VkPipeline CreateComputePipeline
+(
+	vkc::Context const&         context
+	, PipelineCache&            cache
+	, std::span<uint32_t const> code
+	, VkPipelineLayout          layout
+	, std::span<uint32_t const> specializationConstants
+);
+
+#endif //VULKANRESEARCH_COMPUTEPIPELINE_H
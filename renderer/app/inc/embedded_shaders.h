@@ -0,0 +1,25 @@
+#ifndef VULKANRESEARCH_EMBEDDEDSHADERS_H
+#define VULKANRESEARCH_EMBEDDEDSHADERS_H
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// SPIR-V of every shader in SHADER_SOURCES, optimized and compiled into the App library at build time
+// names are the shader file names without extension, e.g. "sky_color"
+struct EmbeddedShader
+{
+	std::string_view          Name;
+	std::span<uint32_t const> Code;
+};
+
+// defined in the generated embedded_shaders_data.cpp, see cmake/embed_spirv.cmake
+std::span<EmbeddedShader const> GetEmbeddedShaders();
+
+// throws std::runtime_error for unknown names
+std::span<uint32_t const> GetEmbeddedShader(std::string_view name);
+
+// vkc::ShaderStage takes the code as a byte vector
+std::vector<char> CopyEmbeddedShader(std::string_view name);
+
+#endif //VULKANRESEARCH_EMBEDDEDSHADERS_H
@@ -2,6 +2,8 @@
 #define VULKANRESEARCH_FILESAVER_H
 #include <filesystem>
 
+// data is four planes of width * height halves in R, G, B, A order, see planar_readback.comp
+// both throw std::runtime_error when the file cannot be encoded or written
 void SaveEXRFile(void const* data, int width, int height, std::filesystem::path const& outputPath);
 
 void SavePNGFile(void const* data, int width, int height, std::filesystem::path const& outputPath);
@@ -0,0 +1,71 @@
+#ifndef VULKANRESEARCH_FRAMELOG_H
+#define VULKANRESEARCH_FRAMELOG_H
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+// fixed size so pushing a frame never allocates
+struct FrameRecord
+{
+	static size_t constexpr MAX_GPU_PASSES{ 8 };
+
+	uint64_t Frame;
+	float    CpuMilliseconds; // world_time::GetElapsedSec
+	float    FenceWaitMilliseconds;
+	float    AcquireMilliseconds;
+	float    PresentMilliseconds;
+	float    SkyShadedFraction; // share of the pixels the sky pass ray marched, see App::GetSkyShadedFraction
+	// NaN when no new result was collected this frame, results belong to the frame that last used the same frame slot
+	std::array<float, MAX_GPU_PASSES> GpuMilliseconds;
+};
+
+// per-frame statistics for soak runs, the render thread hands records to a writer thread through a single-producer single-consumer ring
+// Push is wait-free and does no I/O, the writer appends csv lines and flushes about once a second
+// a full ring drops the record instead of blocking the render thread, the count is written at the end of the file
+class FrameLog final
+{
+public:
+	// capacity is rounded up to a power of two, passNames label the GpuMilliseconds columns in order
+	// throws std::runtime_error when the file cannot be opened or there are more passes than MAX_GPU_PASSES
+	FrameLog(std::filesystem::path const& path, std::span<std::string const> passNames, size_t capacity);
+	// writes every pushed record before joining the writer
+	~FrameLog();
+
+	FrameLog(FrameLog&&)                 = delete;
+	FrameLog(FrameLog const&)            = delete;
+	FrameLog& operator=(FrameLog&&)      = delete;
+	FrameLog& operator=(FrameLog const&) = delete;
+
+	// render thread only
+	bool Push(FrameRecord const& record) noexcept;
+
+	[[nodiscard]] uint64_t GetDropped() const
+	{
+		return m_Dropped;
+	}
+
+private:
+	void Work();
+	void Write(FrameRecord const& record);
+
+	std::vector<FrameRecord> m_Ring;
+	size_t const             m_Mask;
+	size_t const             m_PassCount;
+	uint64_t                 m_Dropped{}; // render thread only
+
+	// head is written by the render thread and tail by the writer, kept on separate cache lines
+	alignas(64) std::atomic<size_t> m_Head{};
+	alignas(64) std::atomic<size_t> m_Tail{};
+	std::atomic<bool>               m_Stopping{ false };
+
+	std::ofstream m_File;
+	std::thread   m_Writer;
+};
+
+#endif //VULKANRESEARCH_FRAMELOG_H
@@ -0,0 +1,108 @@
+#ifndef VULKANRESEARCH_FRAMETIMER_H
+#define VULKANRESEARCH_FRAMETIMER_H
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "context.h"
+#include "command_buffer.h"
+
+class Tracer;
+
+// GPU timings of the live loop without stalling it, TimingQueryPool stays for the blocking profiling paths
+// every frame in flight owns a query pool that is read back when its slot comes around again, after the in-flight fence
+// results the GPU has not made available by then are dropped instead of waited for
+// records into command buffers of one queue only, a second queue needs its own timer
+class FrameTimer final
+{
+	static uint32_t constexpr DEFAULT_MAX_SCOPES = 16;
+
+public:
+	using Scope = uint32_t;
+
+	struct Statistics
+	{
+		uint64_t Frames{};
+		uint64_t Dropped{}; // recorded but not available when the slot was read back
+		double   TotalMilliseconds{};
+		double   MaxMilliseconds{};
+		double   LastMilliseconds{};
+		bool     Updated{ false }; // LastMilliseconds was collected by the latest BeginFrame
+	};
+
+	FrameTimer() = delete;
+	FrameTimer(vkc::Context const& context, float timestampPeriod, uint32_t framesInFlight, uint32_t maxScopes = DEFAULT_MAX_SCOPES);
+	~FrameTimer() = default;
+
+	FrameTimer(FrameTimer&&)                 = delete;
+	FrameTimer(FrameTimer const&)            = delete;
+	FrameTimer& operator=(FrameTimer&&)      = delete;
+	FrameTimer& operator=(FrameTimer const&) = delete;
+
+	void Destroy(vkc::Context const& context) const;
+
+	// allocates, call while setting up, the per-frame calls only take the returned scope
+	// the same label always returns the same scope
+	[[nodiscard]] Scope Intern(std::string_view label);
+
+	// collects what the frame previously recorded into this slot wrote, then resets the slot's queries
+	// has to be recorded before any scope of the frame, in the first command buffer submitted for it on the timer's queue
+	void BeginFrame(vkc::Context const& context, vkc::CommandBuffer const& commandBuffer, uint32_t frame);
+
+	// collects every slot that was submitted and not read back yet, call with the device idle so nothing is dropped
+	void CollectPending(vkc::Context const& context);
+	// starts the statistics over, labels and scopes are kept
+	void ResetStatistics();
+
+	void Begin(vkc::CommandBuffer const& commandBuffer, Scope scope) const;
+	void End(vkc::CommandBuffer const& commandBuffer, Scope scope);
+
+	template<typename FunctionType>
+	void Record(vkc::CommandBuffer const& commandBuffer, Scope scope, FunctionType function)
+	{
+		Begin(commandBuffer, scope);
+		function();
+		End(commandBuffer, scope);
+	}
+
+	// every collected scope is also added to the tracer on the given GPU track
+	void SetTracer(Tracer* tracer, uint32_t queue)
+	{
+		m_Tracer      = tracer;
+		m_TracerQueue = queue;
+	}
+
+	[[nodiscard]] std::span<Statistics const> GetStatistics() const
+	{
+		return m_Statistics;
+	}
+
+	[[nodiscard]] std::string_view GetLabel(Scope scope) const
+	{
+		return m_Labels[scope];
+	}
+
+private:
+	struct Slot
+	{
+		VkQueryPool       QueryPool{};
+		std::vector<bool> Recorded; // scopes ended since the slot was last reset
+		bool              Submitted{ false };
+	};
+
+	void Collect(vkc::Context const& context, Slot& slot);
+
+	std::vector<Slot>        m_Slots;
+	std::vector<std::string> m_Labels;
+	std::vector<Statistics>  m_Statistics;
+	std::vector<uint64_t>    m_Results; // value and availability of every query of a slot
+	Slot*                    m_Current{};
+	Tracer*                  m_Tracer{};
+	uint32_t                 m_TracerQueue{};
+	uint32_t                 m_MaxScopes;
+	float                    m_TimestampPeriod;
+};
+
+#endif //VULKANRESEARCH_FRAMETIMER_H
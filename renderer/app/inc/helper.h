@@ -44,6 +44,14 @@ namespace help
 		throw std::runtime_error("failed to find supported format");
 	}
 
+	inline bool SupportsOptimalTilingFeatures(VkPhysicalDevice physicalDevice, VkFormat format, VkFormatFeatureFlags features)
+	{
+		VkFormatProperties properties{};
+		vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &properties);
+
+		return (properties.optimalTilingFeatures & features) == features;
+	}
+
 	inline bool HasStencilComponent(VkFormat format)
 	{
 		return format == VK_FORMAT_D24_UNORM_S8_UINT || format == VK_FORMAT_D32_SFLOAT_S8_UINT;
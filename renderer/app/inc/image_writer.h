@@ -0,0 +1,84 @@
+#ifndef VULKANRESEARCH_IMAGEWRITER_H
+#define VULKANRESEARCH_IMAGEWRITER_H
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+// encodes and writes PNG and EXR files on worker threads straight from the caller's pixels, nothing is copied
+// the queue is bounded, Submit blocks while it is full instead of letting readbacks pile up in memory
+class ImageWriter final
+{
+public:
+	struct Statistics
+	{
+		uint32_t Images{};
+		uint32_t Failed{}; // counted in Images as well
+		double   EncodeSeconds{};  // summed over workers, encoding and writing only
+		double   BlockedSeconds{}; // time Submit waited for a free queue slot
+	};
+
+	// workerCount of 0 uses every hardware thread
+	ImageWriter(uint32_t workerCount, size_t maxQueued);
+	// writes whatever is still queued before joining the workers
+	~ImageWriter();
+
+	ImageWriter(ImageWriter&&)                 = delete;
+	ImageWriter(ImageWriter const&)            = delete;
+	ImageWriter& operator=(ImageWriter&&)      = delete;
+	ImageWriter& operator=(ImageWriter const&) = delete;
+
+	// pixels are four RGBA16F planes for hdr and RGBA8 otherwise, the path gets .exr or .png appended
+	// pixels are borrowed until release is called from the worker, after the file is written or has failed
+	void Submit
+	(
+		std::span<std::byte const> pixels
+		, int                      width
+		, int                      height
+		, bool                     hdr
+		, std::filesystem::path    path
+		, std::function<void()>    release
+	);
+	// blocks until every submitted image is on disk
+	void Flush();
+
+	[[nodiscard]] Statistics GetStatistics() const;
+
+	[[nodiscard]] uint32_t GetWorkerCount() const
+	{
+		return static_cast<uint32_t>(m_Workers.size());
+	}
+
+private:
+	struct Job
+	{
+		std::span<std::byte const> Pixels;
+		int                        Width;
+		int                        Height;
+		bool                       Hdr;
+		std::filesystem::path      Path;
+		std::function<void()>      Release;
+	};
+
+	void Work();
+
+	std::vector<std::thread> m_Workers;
+	std::deque<Job>          m_Queue;
+	size_t const             m_MaxQueued;
+	size_t                   m_Busy{}; // jobs taken by a worker and not written yet
+	bool                     m_Stopping{ false };
+	Statistics               m_Statistics{};
+
+	mutable std::mutex      m_Mutex;
+	std::condition_variable m_JobAvailable;
+	std::condition_variable m_SlotAvailable;
+	std::condition_variable m_Idle;
+};
+
+#endif //VULKANRESEARCH_IMAGEWRITER_H
@@ -0,0 +1,26 @@
+#ifndef VULKANRESEARCH_JOBMANIFEST_H
+#define VULKANRESEARCH_JOBMANIFEST_H
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "launch_options.h"
+
+struct RenderJob
+{
+	std::string          Name; // output file name without extension
+	glm::vec3            CameraPosition;
+	glm::vec3            CameraForward;
+	float                Fov;
+	std::optional<float> Time;
+	bool                 Hdr;
+	bool                 UseSkyview;
+};
+
+// one job per line: a name followed by any of --camera, --forward, --fov, --time, --hdr and --skyview
+// values a line does not set come from defaults, empty lines and lines starting with # are skipped
+// throws std::runtime_error with the file and line on malformed input or duplicate names
+std::vector<RenderJob> LoadJobManifest(std::filesystem::path const& path, LaunchOptions const& defaults);
+
+#endif //VULKANRESEARCH_JOBMANIFEST_H
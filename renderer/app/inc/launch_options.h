@@ -0,0 +1,114 @@
+#ifndef VULKANRESEARCH_LAUNCHOPTIONS_H
+#define VULKANRESEARCH_LAUNCHOPTIONS_H
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "glm/glm.hpp"
+
+enum class Command
+{
+	Interactive
+	, Render
+	, Profile
+	, AllConfigs
+	, Batch
+	, LUTBake
+	, Benchmark // only started by the benchmark executable
+	, Sweep     // only started by the sweep executable, see App::MeasureQuality
+};
+
+enum class LUTPath
+{
+	Fragment
+	, Compute // falls back to Fragment when the LUT formats cannot be used as storage images
+	, Cpu     // baked on every hardware thread and uploaded, see lut_baker.h
+};
+
+// ray march sample counts reach the shaders as specialization constants 1 to 4, see atmosphere_constants.glsl
+// the defaults are the values the shaders were tuned with
+struct QualitySettings
+{
+	uint32_t   OpticalDepthSamples{ 40 };       // transmittance LUT
+	uint32_t   MultipleScatteringSamples{ 20 }; // along every direction of the multiple scattering LUT
+	uint32_t   ScatteringSamples{ 40 };         // sky-view LUT, aerial perspective and the ray marched sky
+	uint32_t   SqrtSamples{ 20 };               // directions per multiple scattering texel, squared
+	glm::uvec2 TransmittanceExtent{ 256, 64 };
+	glm::uvec2 MultScatteringExtent{ 32, 32 };
+	glm::uvec2 SkyviewExtent{ 200, 100 };
+	bool       AdaptiveScattering{ false }; // specialization constant 5, ScatteringSamples becomes the most steps a ray takes, see PlanScatteringMarch
+	bool       OpticalDepthLUT{ false };    // specialization constant 7, the sky ray march reads transmittance from the optical depth LUT, see SampleOpticalDepthLUT
+
+	bool operator==(QualitySettings const&) const = default;
+};
+
+// named QualitySettings, the interactive window cycles through them with F2, see App::SelectQualityTier
+enum class QualityTier
+{
+	Low
+	, Medium
+	, High      // the QualitySettings defaults
+	, Reference // ground truth of the quality sweep, far from real time
+};
+
+uint32_t constexpr QUALITY_TIER_COUNT{ 4 };
+
+[[nodiscard]] QualitySettings  GetQualitySettings(QualityTier tier);
+[[nodiscard]] std::string_view GetQualityTierName(QualityTier tier);
+
+// sampling of the profile and benchmark commands
+struct ProfileBatching
+{
+	uint32_t Repetitions{}; // timed back to back in one submission, 0 submits and waits for every sample
+	uint32_t Warmup{ 2 };   // untimed repetitions ahead of the timed ones in every batched submission
+};
+
+struct LaunchOptions
+{
+	Command               Mode{ Command::Interactive };
+	int                   Width{ 1920 };
+	int                   Height{ 1080 };
+	glm::vec3             CameraPosition{ .0f, 1000.f, .0f };
+	glm::vec3             CameraForward{ 1.f, .0f, .0f };
+	float                 Fov{ 45.f };
+	std::optional<float>  Time{}; // seconds fed to GetSunAltitude, run time when not set
+	std::filesystem::path OutputDirectory{ "." };
+	std::filesystem::path LUTCachePath{ "lut_cache.bin" }; // empty disables the on-disk LUT cache
+	std::filesystem::path PipelineCachePath{ "pipeline_cache.bin" }; // empty keeps the pipeline cache in memory only
+	std::filesystem::path JobManifest{};                             // batch only, see job_manifest.h
+	std::filesystem::path FrameLogPath{};                            // interactive only, empty disables the per-frame csv log
+	std::filesystem::path TracePath{};                               // interactive only, empty disables the Chrome trace
+	std::filesystem::path BenchmarkResults{ "benchmark.json" };      // benchmark only, relative to OutputDirectory
+	uint32_t              BenchmarkSamples{ 200 };                   // timed samples per pass and scenario
+	bool                  BenchmarkResolutions{ false };             // benchmark only, runs the suite at 1080p, 1440p and 4K
+	ProfileBatching       Profiling{};
+	QualityTier           Tier{ QualityTier::High }; // the sweep sets Quality directly and leaves the tier as is
+	QualitySettings       Quality{};
+	glm::uvec3            AerialPerspectiveResolution{ 32, 32, 32 }; // froxels across, down and in depth
+	uint32_t              SkyviewRowsPerFrame{}; // sky-view LUT rows redrawn per frame, 0 redraws the whole LUT
+	uint32_t              SkyviewArraySlices{};  // sun elevations pre-baked into a sky-view array, 0 ray marches the LUT every frame
+	uint32_t              SkyScale{ 1 };         // interactive only, pixels per sky texel along each axis, 1 renders the sky at full resolution
+	uint32_t              SkyPattern{ 1 };       // interactive only, 2 or 4 ray marches 1 of that many pixels per frame, see SkyHistory
+	LUTPath               LUTs{ LUTPath::Compute };
+	bool                  Hdr{ false };
+	bool                  UseSkyview{ false };
+
+	// every command except the interactive one renders offscreen without a window, surface or swapchain
+	[[nodiscard]] bool IsHeadless() const
+	{
+		return Mode != Command::Interactive;
+	}
+};
+
+// throws std::runtime_error with the reason on malformed input
+LaunchOptions ParseLaunchOptions(int argc, char const* const argv[]);
+
+// shared with the job manifest, option names the value in the error message
+float     ParseFloat(std::string_view text, std::string_view option);
+// expects "x,y,z"
+glm::vec3 ParseVec3(std::string_view text, std::string_view option);
+
+std::string GetUsage();
+
+#endif //VULKANRESEARCH_LAUNCHOPTIONS_H
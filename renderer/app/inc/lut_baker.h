@@ -0,0 +1,62 @@
+#ifndef VULKANRESEARCH_LUTBAKER_H
+#define VULKANRESEARCH_LUTBAKER_H
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// CPU port of TransmittanceLUTTexel and MultScatteringLUTTexel for devices where the GPU LUT passes run on a software rasterizer
+// texels are laid out like the LUT images: RGBA16 UNORM transmittance and RGBA16 SFLOAT multiple scattering, rows from uv.y = 0
+struct LUTSize
+{
+	uint32_t Width;
+	uint32_t Height;
+};
+
+// sample counts of the LUT ray marches, the specialization constants of QualitySettings on the GPU
+struct LUTSamples
+{
+	uint32_t OpticalDepth;
+	uint32_t MultipleScattering;
+	uint32_t Sqrt; // directions per multiple scattering texel, squared
+};
+
+struct BakedLUTs
+{
+	std::vector<uint16_t> Transmittance;
+	std::vector<uint16_t> MultScattering;
+	uint32_t              ThreadCount{};
+	double                TransmittanceMilliseconds{};
+	double                MultScatteringMilliseconds{};
+};
+
+// rows are spread over threadCount threads, 0 uses every hardware thread
+// multiple scattering samples the baked transmittance with the filtering and addressing of the LUT sampler
+[[nodiscard]] BakedLUTs BakeStaticLUTs
+(
+	bool         spectral
+	, LUTSamples samples
+	, LUTSize    transmittance
+	, LUTSize    multScattering
+	, uint32_t   threadCount
+);
+
+struct LUTDifference
+{
+	float MaxAbsolute{};
+	float RootMeanSquare{};
+	float MaxExpected{}; // largest reference value, for scale
+};
+
+// compares the first channelCount channels of every texel, halfFloat selects SFLOAT over UNORM decoding
+[[nodiscard]] LUTDifference CompareLUTs
+(
+	std::span<uint16_t const>   expected
+	, std::span<uint16_t const> actual
+	, bool                      halfFloat
+	, uint32_t                  channelCount
+);
+
+// decodes an IEEE half, for the RGBA16 SFLOAT LUTs and readbacks
+[[nodiscard]] float FromHalf(uint16_t value);
+
+#endif //VULKANRESEARCH_LUTBAKER_H
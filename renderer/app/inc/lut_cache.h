@@ -0,0 +1,39 @@
+#ifndef VULKANRESEARCH_LUTCACHE_H
+#define VULKANRESEARCH_LUTCACHE_H
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+
+#include "mapped_file.h"
+
+uint64_t constexpr HASH_SEED{ 0xcbf29ce484222325ull };
+
+// 64-bit FNV-1a, chain calls through seed to hash several inputs into one key
+uint64_t HashBytes(std::span<std::byte const> bytes, uint64_t seed = HASH_SEED);
+
+template<typename T>
+uint64_t HashValue(T const& value, uint64_t seed = HASH_SEED)
+{
+	return HashBytes(std::as_bytes(std::span{ &value, 1 }), seed);
+}
+
+// texel data of the static LUTs, views point into the mapped cache file
+struct LUTCacheEntry
+{
+	MappedFile                 File;
+	std::span<std::byte const> Transmittance;
+	std::span<std::byte const> MultScattering;
+};
+
+// returns nothing when the file is missing, corrupted, or was written for a different key or LUT sizes
+std::optional<LUTCacheEntry> LoadLUTCache
+(std::filesystem::path const& path, uint64_t key, size_t transmittanceSize, size_t multScatteringSize);
+
+void SaveLUTCache
+(
+	std::filesystem::path const& path, uint64_t key
+	, std::span<std::byte const> transmittance, std::span<std::byte const> multScattering
+);
+
+#endif //VULKANRESEARCH_LUTCACHE_H
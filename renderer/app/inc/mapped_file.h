@@ -0,0 +1,37 @@
+#ifndef VULKANRESEARCH_MAPPEDFILE_H
+#define VULKANRESEARCH_MAPPEDFILE_H
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+// read-only view of a whole file mapped into the address space
+class MappedFile final
+{
+public:
+	MappedFile() = default;
+	// throws std::runtime_error when the file cannot be opened or mapped
+	explicit MappedFile(std::filesystem::path const& path);
+	~MappedFile();
+
+	MappedFile(MappedFile&& other) noexcept;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+	MappedFile(MappedFile const&)            = delete;
+	MappedFile& operator=(MappedFile const&) = delete;
+
+	[[nodiscard]] std::span<std::byte const> GetData() const
+	{
+		return { static_cast<std::byte const*>(m_Data), m_Size };
+	}
+
+private:
+	void Unmap();
+
+	void const* m_Data{};
+	size_t      m_Size{};
+#ifdef _WIN32
+	void* m_FileHandle{};
+	void* m_MappingHandle{};
+#endif
+};
+
+#endif //VULKANRESEARCH_MAPPEDFILE_H
@@ -0,0 +1,116 @@
+#ifndef VULKANRESEARCH_PIPELINECACHE_H
+#define VULKANRESEARCH_PIPELINECACHE_H
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <type_traits>
+
+#include "context.h"
+
+// one VkPipelineCache shared by every pipeline the device creates, persisted between runs
+// pipelines are created through it explicitly, see Build and CreateComputePipelines
+class PipelineCache final
+{
+public:
+	struct Statistics
+	{
+		uint32_t Pipelines{};
+		uint32_t Hits{}; // reported by the driver through pipeline creation feedback
+		double   Milliseconds{};
+	};
+
+	// starts empty when the file is missing, corrupted, or was written by another device or driver
+	// an empty path keeps the cache in memory only
+	// throws std::runtime_error when the cache object cannot be created
+	PipelineCache(vkc::Context const& context, VkPhysicalDeviceProperties const& properties, std::filesystem::path path);
+	~PipelineCache() = default;
+
+	PipelineCache(PipelineCache&&)                 = delete;
+	PipelineCache(PipelineCache const&)            = delete;
+	PipelineCache& operator=(PipelineCache&&)      = delete;
+	PipelineCache& operator=(PipelineCache const&) = delete;
+
+	// vkc::PipelineBuilder takes no cache, so build runs with the context's graphics pipeline creation routed through this one
+	// the dispatch table is restored when build returns or throws, pipelines built outside it do not see the cache
+	template<typename BuildFunction>
+	[[nodiscard]] std::invoke_result_t<BuildFunction> Build(vkc::Context& context, BuildFunction&& build)
+	{
+		Scope const scope{ *this, context };
+		return build();
+	}
+
+	[[nodiscard]] VkResult CreateComputePipelines
+	(
+		vkc::Context const&                            context
+		, std::span<VkComputePipelineCreateInfo const> createInfos
+		, VkPipeline*                                  pipelines
+	);
+
+	// writes the cache next to the target and renames it, failures are reported and otherwise ignored
+	void Save(vkc::Context const& context) const;
+	void Destroy(vkc::Context const& context) const;
+
+	[[nodiscard]] Statistics const& GetStatistics() const
+	{
+		return m_Statistics;
+	}
+
+	[[nodiscard]] bool WasLoaded() const
+	{
+		return m_Loaded;
+	}
+
+private:
+	// routes the context's graphics pipeline creation through the cache for its lifetime on the constructing thread
+	class Scope final
+	{
+	public:
+		Scope(PipelineCache& cache, vkc::Context& context);
+		~Scope();
+
+		Scope(Scope&&)                 = delete;
+		Scope(Scope const&)            = delete;
+		Scope& operator=(Scope&&)      = delete;
+		Scope& operator=(Scope const&) = delete;
+
+	private:
+		// the dispatch table calls carry no user data, so the active scope of the thread is looked up instead
+		static VKAPI_ATTR VkResult VKAPI_CALL CreateGraphicsPipelines
+		(
+			VkDevice                              device
+			, VkPipelineCache                     cache
+			, uint32_t                            count
+			, VkGraphicsPipelineCreateInfo const* createInfos
+			, VkAllocationCallbacks const*        allocator
+			, VkPipeline*                         pipelines
+		);
+
+		static thread_local Scope* m_Active;
+
+		PipelineCache&                m_Cache;
+		vkc::Context&                 m_Context;
+		PFN_vkCreateGraphicsPipelines m_Create;
+		Scope*                        m_Previous;
+	};
+
+	// calls without a cache get this one with creation feedback chained in, and feed the statistics
+	template<typename CreateInfo, typename CreateFunction>
+	VkResult CreatePipelines
+	(
+		CreateFunction                 create
+		, VkDevice                     device
+		, VkPipelineCache              cache
+		, uint32_t                     count
+		, CreateInfo const*            createInfos
+		, VkAllocationCallbacks const* allocator
+		, VkPipeline*                  pipelines
+	);
+
+	VkPipelineCache            m_Cache{};
+	std::filesystem::path      m_Path;
+	VkPhysicalDeviceProperties m_Properties{};
+	Statistics                 m_Statistics{};
+	bool                       m_Loaded{ false };
+};
+
+#endif //VULKANRESEARCH_PIPELINECACHE_H
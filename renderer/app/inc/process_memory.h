@@ -0,0 +1,8 @@
+#ifndef VULKANRESEARCH_PROCESSMEMORY_H
+#define VULKANRESEARCH_PROCESSMEMORY_H
+#include <cstddef>
+
+// highest resident set size of the process so far in bytes, 0 when the platform does not report it
+size_t GetPeakResidentBytes();
+
+#endif //VULKANRESEARCH_PROCESSMEMORY_H
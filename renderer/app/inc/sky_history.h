@@ -0,0 +1,69 @@
+#ifndef VULKANRESEARCH_SKYHISTORY_H
+#define VULKANRESEARCH_SKYHISTORY_H
+#include <cstdint>
+#include <optional>
+
+#include "glm/glm.hpp"
+
+// decides which pixels the temporal sky ray marches each frame and whether the previous frame can be reprojected
+// a pattern of 2 shades a checkerboard and 4 one pixel of every 2x2 block, see sky_temporal.glsl
+class SkyHistory final
+{
+public:
+	struct Frame
+	{
+		uint32_t  Phase{};
+		bool      HistoryValid{ false }; // false ray marches every pixel of the frame
+		glm::mat3 PreviousBasis{ 1.f };  // right, up and forward of the previous frame's sky rays
+	};
+
+	SkyHistory(uint32_t pattern, float maxSunDrift, float maxCameraDrift, float maxRotation);
+
+	// basis as in FindCameraRay of sky_rays.glsl, the history is rejected when the sun, the camera position or its forward
+	// moved past the limits since the previous frame
+	[[nodiscard]] Frame Advance(float sunAltitude, glm::vec3 cameraPosition, glm::mat3 const& basis);
+	// the next Advance rejects the history, e.g. after the render targets or the LUTs were rebuilt
+	void Invalidate();
+
+	// share of the pixels ray marched by the last Advance, geometry is counted as shaded
+	[[nodiscard]] float GetShadedFraction() const
+	{
+		return m_LastFrame && m_LastFrame->HistoryValid ? 1.f / static_cast<float>(m_Pattern) : 1.f;
+	}
+
+	// mean of GetShadedFraction since construction
+	[[nodiscard]] double GetMeanShadedFraction() const
+	{
+		return m_Frame ? m_ShadedFractionSum / static_cast<double>(m_Frame) : 0.;
+	}
+
+	[[nodiscard]] uint64_t GetRejectedCount() const
+	{
+		return m_RejectedCount;
+	}
+
+	[[nodiscard]] uint64_t GetFrameCount() const
+	{
+		return m_Frame;
+	}
+
+private:
+	struct State
+	{
+		float     SunAltitude;
+		glm::vec3 CameraPosition;
+		glm::mat3 Basis;
+	};
+
+	uint32_t const       m_Pattern;
+	float const          m_MaxSunDrift;
+	float const          m_MaxCameraDrift;
+	float const          m_MinForwardCos;
+	std::optional<State> m_Previous{};
+	std::optional<Frame> m_LastFrame{};
+	uint64_t             m_Frame{};
+	uint64_t             m_RejectedCount{};
+	double               m_ShadedFractionSum{};
+};
+
+#endif //VULKANRESEARCH_SKYHISTORY_H
@@ -0,0 +1,77 @@
+#ifndef VULKANRESEARCH_SKYVIEWSCHEDULE_H
+#define VULKANRESEARCH_SKYVIEWSCHEDULE_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct SkyviewRows
+{
+	uint32_t First;
+	uint32_t Count;
+};
+
+// decides which rows of the sky-view LUT are redrawn each frame and how stale the remaining rows are
+// rows are split into bands, the band holding the horizon is redrawn every frame and the others round-robin
+class SkyviewSchedule final
+{
+public:
+	struct Staleness
+	{
+		uint64_t Frames{};
+		float    SunAngle{};       // radians
+		float    CameraAltitude{}; // meters
+	};
+
+	// rowsPerFrame of 0 or at least rowCount disables amortization
+	SkyviewSchedule(uint32_t rowCount, uint32_t rowsPerFrame, float maxSunDrift, float maxAltitudeDrift);
+
+	// bands to redraw this frame, empty when the whole LUT has to be redrawn
+	// a full redraw is forced whenever the oldest band drifted past the sun or altitude limit
+	[[nodiscard]] std::vector<SkyviewRows> Advance(float sunAltitude, float cameraAltitude);
+	// the next Advance redraws the whole LUT, e.g. after the LUTs it samples were regenerated
+	void Invalidate();
+
+	[[nodiscard]] bool IsAmortized() const
+	{
+		return m_Bands.size() > 1;
+	}
+
+	// worst staleness sampled by the sky pass since construction
+	[[nodiscard]] Staleness const& GetWorstStaleness() const
+	{
+		return m_WorstStaleness;
+	}
+
+	[[nodiscard]] uint64_t GetForcedRefreshCount() const
+	{
+		return m_ForcedRefreshCount;
+	}
+
+	[[nodiscard]] uint64_t GetFrameCount() const
+	{
+		return m_Frame;
+	}
+
+private:
+	struct Band
+	{
+		SkyviewRows Rows;
+		uint64_t    Frame{};
+		float       SunAltitude{};
+		float       CameraAltitude{};
+		bool        Valid{ false };
+	};
+
+	void Refresh(Band& band, float sunAltitude, float cameraAltitude) const;
+
+	std::vector<Band> m_Bands;
+	size_t            m_HorizonBand{};
+	size_t            m_NextBand{};
+	uint64_t          m_Frame{};
+	float const       m_MaxSunDrift;
+	float const       m_MaxAltitudeDrift;
+	Staleness         m_WorstStaleness{};
+	uint64_t          m_ForcedRefreshCount{};
+};
+
+#endif //VULKANRESEARCH_SKYVIEWSCHEDULE_H
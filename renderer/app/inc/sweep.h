@@ -0,0 +1,71 @@
+#ifndef VULKANRESEARCH_SWEEP_H
+#define VULKANRESEARCH_SWEEP_H
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "launch_options.h"
+
+// renders of the benchmark views at one QualitySettings and the median GPU time of every pass, see App::MeasureQuality
+struct QualityMeasurement
+{
+	QualitySettings                    Quality;
+	std::vector<std::vector<uint16_t>> SkyviewImages;  // per view, four planes of halves, see planar_readback.comp
+	std::vector<std::vector<uint16_t>> RaymarchImages; // same views without the sky-view LUT
+	size_t                             PixelCount{};
+	double                             TransmittanceMilliseconds{};
+	double                             MultScatteringMilliseconds{};
+	double                             OpticalDepthMilliseconds{}; // built on every path, counted as a static LUT of the LUT march only
+	double                             SkyviewLUTMilliseconds{}; // averaged over the views like every per-frame pass
+	double                             SkyviewRenderMilliseconds{};
+	double                             RaymarchRenderMilliseconds{};
+};
+
+struct ImageError
+{
+	double RootMeanSquare{};
+	double MaxRelative{};
+};
+
+// one configuration and render path of the sweep against the reference
+struct SweepRow
+{
+	QualitySettings Quality;
+	bool            Skyview;
+	double          StaticLUTMilliseconds; // transmittance and multiple scattering, plus optical depth for the LUT march
+	double          FrameMilliseconds;     // per-frame passes of the path
+	double          MeanSteps;             // ray march only, NaN on the sky-view path, see MeanScatteringSteps
+	ImageError      Error;
+	bool            Pareto; // no other row of the path is both faster and closer to the reference
+};
+
+// the reference quality tier, twice the samples of the richest sweep setting at its LUT extents
+// its ray marched renders are the ground truth, kept below a few billion steps per LUT draw so drivers with a GPU watchdog do not reset
+[[nodiscard]] QualitySettings GetSweepReference();
+// sample counts scaled by 1/4 to 2 and LUT extents by 1/2 to 2 around the defaults, each with the fixed and the adaptive march
+// plus every sample count at the default extents with the fixed march reading the optical depth LUT
+[[nodiscard]] std::vector<QualitySettings> GetSweepConfigurations();
+
+// the sweep renders carry the steps of the ray march in alpha, averaged over the pixels whose rays reached the atmosphere
+[[nodiscard]] double MeanScatteringSteps(std::span<std::vector<uint16_t> const> renders, size_t pixelCount);
+
+// RGB of all views in linear HDR, alpha is ignored
+// relative errors are taken against at least 1% of the mean reference value so black pixels do not dominate
+[[nodiscard]] ImageError CompareRenders
+(
+	std::span<std::vector<uint16_t> const>   reference
+	, std::span<std::vector<uint16_t> const> renders
+	, size_t                                 pixelCount
+);
+
+// one row per render path, both compared against the ray marched reference
+[[nodiscard]] std::vector<SweepRow> EvaluateMeasurement(QualityMeasurement const& reference, QualityMeasurement const& measurement);
+
+// flags the rows no other row of the same path beats in both frame time and RMSE
+void MarkParetoFront(std::span<SweepRow> rows);
+
+// throws std::runtime_error when the file cannot be written
+void WriteSweepTable(std::filesystem::path const& path, std::span<SweepRow const> rows);
+
+#endif //VULKANRESEARCH_SWEEP_H
@@ -65,6 +65,11 @@ public:
 
 	void GetResults(vkc::Context const& context, Timings& outResult);
 
+	[[nodiscard]] float GetTimestampPeriod() const
+	{
+		return m_TimestampPeriod;
+	}
+
 	template<typename FunctionType, typename... Args>
 	void RecordWholePipe
 	(
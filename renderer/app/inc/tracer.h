@@ -0,0 +1,96 @@
+#ifndef VULKANRESEARCH_TRACER_H
+#define VULKANRESEARCH_TRACER_H
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+#include <vector>
+
+// CPU scopes timed with steady_clock and GPU scopes from timestamp queries on one timeline
+// written as Chrome trace event json, which chrome://tracing and ui.perfetto.dev open
+// events are kept in memory until Write, past maxEvents new events are counted and dropped so recording never allocates
+// names are not copied, they have to outlive the tracer
+class Tracer final
+{
+public:
+	using Clock = std::chrono::steady_clock;
+
+	// a GPU timestamp and the steady_clock time it was taken at
+	struct Calibration
+	{
+		uint64_t          GpuTicks{};
+		Clock::time_point CpuTime{};
+		double            NanosecondsPerTick{ 1. };
+		double            UncertaintyNanoseconds{}; // how far apart the two clocks were sampled
+	};
+
+	class CpuScope final
+	{
+	public:
+		CpuScope(Tracer* tracer, std::string_view name)
+			: m_Tracer{ tracer }
+			, m_Name{ name }
+			, m_Begin{ tracer ? Clock::now() : Clock::time_point{} }
+		{
+		}
+
+		~CpuScope()
+		{
+			if (m_Tracer)
+				m_Tracer->AddCpu(m_Name, m_Begin, Clock::now());
+		}
+
+		CpuScope(CpuScope&&)                 = delete;
+		CpuScope(CpuScope const&)            = delete;
+		CpuScope& operator=(CpuScope&&)      = delete;
+		CpuScope& operator=(CpuScope const&) = delete;
+
+	private:
+		Tracer*           m_Tracer;
+		std::string_view  m_Name;
+		Clock::time_point m_Begin;
+	};
+
+	explicit Tracer(size_t maxEvents);
+
+	// converts a value of the host time domain that matches steady_clock, CLOCK_MONOTONIC nanoseconds or QueryPerformanceCounter ticks on Windows
+	[[nodiscard]] static Clock::time_point FromHostTimeDomain(uint64_t value);
+
+	void SetCalibration(Calibration const& calibration)
+	{
+		m_Calibration = calibration;
+	}
+
+	void AddCpu(std::string_view name, Clock::time_point begin, Clock::time_point end);
+	// queue selects the GPU track, ticks are raw timestamp query values
+	void AddGpu(std::string_view name, uint32_t queue, uint64_t beginTicks, uint64_t endTicks);
+
+	// queueNames label the GPU tracks by index
+	// throws std::runtime_error when the file cannot be written
+	void Write(std::filesystem::path const& path, std::vector<std::string_view> const& queueNames) const;
+
+	[[nodiscard]] uint64_t GetDropped() const
+	{
+		return m_Dropped;
+	}
+
+private:
+	struct Event
+	{
+		std::string_view Name;
+		uint32_t         Queue; // GPU only
+		bool             Gpu;
+		int64_t          Begin; // nanoseconds since the tracer started, or GPU ticks
+		int64_t          End;
+	};
+
+	[[nodiscard]] double ToMicroseconds(Event const& event, int64_t value) const;
+
+	std::vector<Event> m_Events;
+	size_t const       m_MaxEvents;
+	uint64_t           m_Dropped{};
+	Clock::time_point  m_Start;
+	Calibration        m_Calibration{};
+};
+
+#endif //VULKANRESEARCH_TRACER_H
@@ -0,0 +1,74 @@
+#ifndef VULKANRESEARCH_VOLUMEIMAGE_H
+#define VULKANRESEARCH_VOLUMEIMAGE_H
+#include "context.h"
+#include "vma_usage.h"
+
+// vkc::ImageBuilder only takes 2D extents, 3D and layered LUTs are allocated through VMA directly
+// 3D when the extent has depth, 2D array otherwise; single mip, color aspect
+class VolumeImage final
+{
+public:
+	// throws std::runtime_error when the image or its view cannot be created
+	VolumeImage(vkc::Context const& context, VkExtent3D extent, uint32_t layerCount, VkFormat format, VkImageUsageFlags usage);
+	~VolumeImage() = default;
+
+	VolumeImage(VolumeImage&&)                 = delete;
+	VolumeImage(VolumeImage const&)            = delete;
+	VolumeImage& operator=(VolumeImage&&)      = delete;
+	VolumeImage& operator=(VolumeImage const&) = delete;
+
+	void Destroy(vkc::Context const& context) const;
+
+	// same contract as vkc::Image::MakeTransition, the old layout is tracked by the image
+	void MakeTransition
+	(
+		vkc::Context const&     context
+		, VkCommandBuffer       commandBuffer
+		, VkPipelineStageFlags2 srcStageMask
+		, VkAccessFlags2        srcAccessMask
+		, VkPipelineStageFlags2 dstStageMask
+		, VkAccessFlags2        dstAccessMask
+		, VkImageLayout         newLayout
+	);
+
+	[[nodiscard]] VkImage GetImage() const
+	{
+		return m_Image;
+	}
+
+	[[nodiscard]] VkImageView GetView() const
+	{
+		return m_View;
+	}
+
+	[[nodiscard]] VkExtent3D GetExtent() const
+	{
+		return m_Extent;
+	}
+
+	[[nodiscard]] uint32_t GetLayerCount() const
+	{
+		return m_LayerCount;
+	}
+
+	[[nodiscard]] VkFormat GetFormat() const
+	{
+		return m_Format;
+	}
+
+	[[nodiscard]] VkImageLayout GetLayout() const
+	{
+		return m_Layout;
+	}
+
+private:
+	VkImage       m_Image{};
+	VkImageView   m_View{};
+	VmaAllocation m_Allocation{};
+	VkExtent3D    m_Extent{};
+	uint32_t      m_LayerCount{};
+	VkFormat      m_Format{};
+	VkImageLayout m_Layout{ VK_IMAGE_LAYOUT_UNDEFINED };
+};
+
+#endif //VULKANRESEARCH_VOLUMEIMAGE_H
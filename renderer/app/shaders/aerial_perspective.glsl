@@ -0,0 +1,18 @@
+// froxel volume covering the first gAerialPerspectiveDistance km of every camera ray, slices are linear in distance
+const float gAerialPerspectiveDistance = 32.f;
+
+float AerialPerspectiveSliceDistance(float slice, float sliceCount)
+{
+    return (slice + .5f) / sliceCount * gAerialPerspectiveDistance;
+}
+
+// rgb is in-scattered luminance, a is transmittance averaged over the channels
+vec4 SampleAerialPerspective(sampler3D volume, vec2 uv, float distance)
+{
+    const float sliceCount = float(textureSize(volume, 0).z);
+    const float w = distance / gAerialPerspectiveDistance;
+    // the first slice sits half a slice away from the camera, fade in front of it instead of clamping
+    const float weight = clamp(w * sliceCount * 2.f, .0f, 1.f);
+    const vec4 scattering = texture(volume, vec3(uv, w));
+    return vec4(scattering.rgb * weight, mix(1.f, scattering.a, weight));
+}
@@ -17,7 +17,18 @@ const vec3 gOzoneAbsorptionCoef = vec3(.650f, 1.881f, .085f) * 1e-3;
 // which is incorrect.
 const vec3 gSunRGBIrradiance = vec3(1.500, 1.864, 1.715) * 150.0;
 
-const int gOpticalDepthSamples = 40;
-const int gMultipleScatteringSamples = 20;
-const int gScatteringSamples = 40;
-const int gSqrtSamples = 20;
\ No newline at end of file
+// specialization constants so sample counts change without recompiling, constant_id 0 is the spectral switch, see QualitySettings
+layout (constant_id = 1) const int gOpticalDepthSamples = 40;
+layout (constant_id = 2) const int gMultipleScatteringSamples = 20;
+layout (constant_id = 3) const int gScatteringSamples = 40;
+layout (constant_id = 4) const int gSqrtSamples = 20;
+// the in-scattering march takes fewer steps through thin air and stops once nothing shines through, see PlanScatteringMarch
+layout (constant_id = 5) const bool gAdaptiveScattering = false;
+// sweep only, the hdr sky render writes the steps of the march to alpha
+layout (constant_id = 6) const bool gWriteScatteringSteps = false;
+// the in-scattering march reads transmittance from differences of the optical depth LUT instead of accumulating it step by step
+layout (constant_id = 7) const bool gOpticalDepthLUTMarch = false;
+
+const float gScatteringTransmittanceCutoff = 1e-3f; // the adaptive march stops once every channel transmits less
+
+const float gSunPeriod = 120.f; // seconds for a full turn of the sun, see GetSunAltitude
\ No newline at end of file
@@ -90,7 +90,7 @@ vec2 FishEyeRayAngles(vec2 uv, float aspectRatio)
 
 float GetSunAltitude(float time)
 {
-    const float halfPeriod = 60.f;
+    const float halfPeriod = gSunPeriod * .5f;
     const float beginOffset = -5.f * gPI / 180.f;
     return gPI * time / halfPeriod + beginOffset;
     return beginOffset;
@@ -113,7 +113,85 @@ vec3 SampleLUT(sampler2D lut, vec3 position, vec3 sunDirection)
     return texture(lut, vec2(u, v)).rgb;
 }
 
-vec3 FindSkyScatteringRGB(sampler2D transmittanceImage, sampler2D multipleScatteringImage
+// cosine of the zenith angle at which a ray from the radius grazes the ground
+float GroundHorizonCosAngle(float radius)
+{
+    const float ratio = gGroundRadius / max(radius, gGroundRadius);
+    return -sqrt(max(.0f, 1.f - ratio * ratio));
+}
+
+// the optical depth LUT only holds directions that miss the ground, u spans them from the horizon to the zenith
+// both axes are squared so the steep depths near the horizon and the dense air near the ground get more texels
+vec2 OpticalDepthLUTParameters(float radius, float cosZenith)
+{
+    const float horizon = GroundHorizonCosAngle(radius);
+    const float u = sqrt(clamp((cosZenith - horizon) / (1.f - horizon), .0f, 1.f));
+    const float v = sqrt(clamp((radius - gGroundRadius) / (gAtmosphereRadius - gGroundRadius), .0f, 1.f));
+    return vec2(u, v);
+}
+
+// optical depth from the position to the top of the atmosphere, the direction must not hit the ground
+vec4 SampleOpticalDepthLUT(sampler2D lut, vec3 position, vec3 direction)
+{
+    const float radius = length(position);
+    const vec2 size = vec2(textureSize(lut, 0));
+    // the first and last texel centers sit on the ends of the parameter range, see OpticalDepthLUTTexel
+    const vec2 parameters = OpticalDepthLUTParameters(radius, dot(position, direction) / radius);
+    return texture(lut, (parameters * (size - 1.f) + .5f) / size);
+}
+
+// steps the last in-scattering march took
+int gScatteringStepsTaken = 0;
+
+struct ScatteringMarch
+{
+    float Steps;
+    float Warp; // 1 crowds the samples at the start of the ray, -1 at its end, 0 spaces them evenly
+};
+
+ScatteringMarch PlanScatteringMarch(vec3 rayStart, vec3 rayDirection, float rayLength, bool hitsGround)
+{
+    ScatteringMarch march = ScatteringMarch(float(gScatteringSamples), .0f);
+    if (!gAdaptiveScattering)
+    return march;
+
+    // density falls off exponentially, the lowest point of the ray is where most of the light is scattered
+    const float startRadius = length(rayStart);
+    const float cosZenith = dot(rayStart, rayDirection) / startRadius;
+    float lowestAltitude;
+    if (hitsGround)
+    {
+        lowestAltitude = .0f;
+        march.Warp = -1.f;
+    }
+    else if (cosZenith >= .0f)
+    {
+        lowestAltitude = startRadius - gGroundRadius;
+        march.Warp = 1.f;
+    }
+    else
+    lowestAltitude = startRadius * sqrt(1.f - cosZenith * cosZenith) - gGroundRadius;
+
+    // air along the ray against a horizontal ray from the ground, which gets every sample
+    const float horizonLength = sqrt(gAtmosphereRadius * gAtmosphereRadius - gGroundRadius * gGroundRadius);
+    const float airMass = rayLength * RayleighDensity(max(.0f, lowestAltitude)) / horizonLength;
+    const float minSteps = max(4.f, floor(gScatteringSamples * .25f));
+    march.Steps = clamp(ceil(gScatteringSamples * sqrt(airMass)), min(minSteps, float(gScatteringSamples)), float(gScatteringSamples));
+    return march;
+}
+
+// distance of a sample from the start of the ray, the quadratic warps trade samples in thin air for samples near the lowest point
+float ScatteringSampleDistance(ScatteringMarch march, float step, float rayLength)
+{
+    const float u = (step + .3f) / march.Steps;
+    if (march.Warp > .0f)
+    return u * u * rayLength;
+    if (march.Warp < .0f)
+    return (1.f - (1.f - u) * (1.f - u)) * rayLength;
+    return u * rayLength;
+}
+
+vec3 FindSkyScatteringRGB(sampler2D transmittanceImage, sampler2D multipleScatteringImage, sampler2D opticalDepthImage
 , vec3 viewPosition, vec3 rayDirection, vec3 sunDirection)
 {
     const vec2 atmosphereExits = RayIntersectSphere2D(viewPosition, rayDirection, gAtmosphereRadius);
@@ -135,12 +213,21 @@ vec3 FindSkyScatteringRGB(sampler2D transmittanceImage, sampler2D multipleScatte
     const float miePhase = MiePhase(cosTheta);
     const float rayleighPhase = RayleighPhase(cosTheta);
 
+    const ScatteringMarch march = PlanScatteringMarch(rayStart, rayDirection, maxDistance - minDistance, distanceToGround > .0f);
+
+    // rays into the ground are looked up backwards from each sample, their reverse misses the ground
+    const float depthSign = distanceToGround > .0f ? -1.f : 1.f;
+    const vec3 depthDirection = depthSign * rayDirection;
+    const vec3 startDepth = gOpticalDepthLUTMarch ? SampleOpticalDepthLUT(opticalDepthImage, rayStart, depthDirection).rgb : vec3(.0f);
+
     vec3 luminance = vec3(.0f);
     vec3 transmittance = vec3(1.f);
+    vec3 previousDepth = vec3(.0f);
     float t = .0f;
-    for (float step = .0f; step < gScatteringSamples; ++step)
+    gScatteringStepsTaken = 0;
+    for (float step = .0f; step < march.Steps; ++step)
     {
-        const float newT = ((step + .3f) / gScatteringSamples) * (maxDistance - minDistance);
+        const float newT = ScatteringSampleDistance(march, step, maxDistance - minDistance);
         const float deltaT = newT - t;
         t = newT;
 
@@ -150,9 +237,7 @@ vec3 FindSkyScatteringRGB(sampler2D transmittanceImage, sampler2D multipleScatte
 
         const float mieScattering = MieScattering(altitude);
         const vec3 rayleighScattering = RayleighScattering(altitude);
-        const vec3 extinction = ExtinctionCoef(altitude);
 
-        const vec3 stepTransmittance = exp(-deltaT * extinction);
         const vec3 up = normalize(position);
         const float sunZenithCosAngle = dot(sunDirection, up);
 
@@ -163,11 +248,35 @@ vec3 FindSkyScatteringRGB(sampler2D transmittanceImage, sampler2D multipleScatte
         const vec3 mieInScattering = mieScattering * (miePhase * sunTransmittance + psims);
         const vec3 totalInScattering = gSunRGBIrradiance * (rayleighInScattering + mieInScattering);
 
-        const vec3 scatteringIntegral = (totalInScattering - totalInScattering * stepTransmittance) / extinction;
-
-        luminance += scatteringIntegral * transmittance;
-
-        transmittance *= stepTransmittance;
+        if (gOpticalDepthLUTMarch)
+        {
+            // the depth from the start of the ray is a difference of two cumulative depths, no extinction is evaluated
+            // clamped to the previous depth, texel error must not make the transmittance grow along the ray
+            const vec3 opticalDepth = max(depthSign * (startDepth - SampleOpticalDepthLUT(opticalDepthImage, position, depthDirection).rgb), previousDepth);
+            const vec3 segmentDepth = opticalDepth - previousDepth;
+            const vec3 newTransmittance = exp(-opticalDepth);
+
+            // the same segment integral as the analytic march, (1 - stepTransmittance) / extinction with the LUT at both ends
+            // a thin segment falls back to the trapezoid, the difference of transmittances loses every digit there
+            const vec3 segmentIntegral = mix((transmittance - newTransmittance) / max(segmentDepth, vec3(1e-4f)), .5f * (transmittance + newTransmittance), lessThan(segmentDepth, vec3(1e-4f)));
+            luminance += totalInScattering * segmentIntegral * deltaT;
+
+            transmittance = newTransmittance;
+            previousDepth = opticalDepth;
+        }
+        else
+        {
+            const vec3 extinction = ExtinctionCoef(altitude);
+            const vec3 stepTransmittance = exp(-deltaT * extinction);
+            const vec3 scatteringIntegral = (totalInScattering - totalInScattering * stepTransmittance) / extinction;
+
+            luminance += scatteringIntegral * transmittance;
+
+            transmittance *= stepTransmittance;
+        }
+        ++gScatteringStepsTaken;
+        if (gAdaptiveScattering && max(transmittance.r, max(transmittance.g, transmittance.b)) < gScatteringTransmittanceCutoff)
+        break;
     }
     return luminance;
 }
\ No newline at end of file
@@ -1,10 +1,22 @@
 #version 450
+#extension GL_GOOGLE_include_directive: require
+#include "aerial_perspective.glsl"
 
 layout (location = 0) in vec3 inColor;
+layout (location = 1) in vec3 inViewPosition;
+layout (location = 2) in vec4 inClipPosition;
+
+layout (binding = 5) uniform sampler3D aerialPerspectiveImage;
 
 layout (location = 0) out vec4 outColor;
 
 void main()
 {
-    outColor = vec4(inColor, 1.);
+    const vec2 uv = inClipPosition.xy / inClipPosition.w * .5f + .5f;
+    const float distance = length(inViewPosition) * .001f; // meters to kilometers
+    const vec4 aerialPerspective = SampleAerialPerspective(aerialPerspectiveImage, uv, distance);
+
+    // in-scattering goes through the same curve as SimpleToneMap in sky_color.frag
+    const vec3 inScattering = 1.f - exp(-.05f * aerialPerspective.rgb);
+    outColor = vec4(inColor * aerialPerspective.a + inScattering, 1.);
 }
\ No newline at end of file
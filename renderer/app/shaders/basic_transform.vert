@@ -3,6 +3,8 @@
 layout (location = 0) in vec3 inPosition;
 
 layout (location = 0) out vec3 outColor;
+layout (location = 1) out vec3 outViewPosition;
+layout (location = 2) out vec4 outClipPosition;
 
 layout (binding = 0) uniform ModelViewProjection
 {
@@ -15,6 +17,9 @@ vec3 colors[3] = vec3[](vec3(1., .0, .0), vec3(.0, 1., .0), vec3(.0, .0, 1.));
 
 void main()
 {
-    gl_Position = mvp.Projection * mvp.View * mvp.Model * vec4(inPosition, 1.);
+    const vec4 viewPosition = mvp.View * mvp.Model * vec4(inPosition, 1.);
+    gl_Position = mvp.Projection * viewPosition;
+    outViewPosition = viewPosition.xyz;
+    outClipPosition = gl_Position;
     outColor = colors[gl_VertexIndex % 3];
 }
\ No newline at end of file
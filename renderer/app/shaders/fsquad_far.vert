@@ -0,0 +1,10 @@
+#version 450
+
+layout (location = 0) out vec2 outUV;
+
+// fsquad.vert at the far plane, the sky depth tests against the depth buffer so covered pixels never reach the fragment shader
+void main()
+{
+    outUV = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    gl_Position = vec4(outUV * 2.f - 1.f, 1.0f, 1.0f);
+}
\ No newline at end of file
@@ -0,0 +1,25 @@
+// expects the spectral specialization constant to be declared by the including shader
+// one table serves every step of every ray, so it takes more samples than the transmittance LUT
+const int gOpticalDepthLUTSamples = 4 * gOpticalDepthSamples;
+
+// texel centers cover the ends of the parameter range, see SampleOpticalDepthLUT
+vec4 OpticalDepthLUTTexel(ivec2 texel, ivec2 size)
+{
+    const vec2 parameters = vec2(texel) / vec2(max(size - 1, ivec2(1)));
+    const float radius = mix(gGroundRadius, gAtmosphereRadius, parameters.y * parameters.y);
+    const float cosZenith = mix(GroundHorizonCosAngle(radius), 1.f, parameters.x * parameters.x);
+
+    const vec3 position = vec3(.0f, radius, .0f);
+    const vec3 direction = vec3(sqrt(max(.0f, 1.f - cosZenith * cosZenith)), cosZenith, .0f);
+    const float distancePerStep = max(.0f, RayIntersectSphere(position, direction, gAtmosphereRadius)) / gOpticalDepthLUTSamples;
+
+    // midpoint sampling to the top of the atmosphere, depth rather than transmittance so two lookups can be subtracted
+    vec4 opticalDepth = vec4(.0f);
+    for (int step = 0; step < gOpticalDepthLUTSamples; ++step)
+    {
+        const float altitude = FindAltitude(position + (float(step) + .5f) * distancePerStep * direction);
+        const vec4 extinction = spectral ? SpectralExtinctionCoef(altitude) : vec4(ExtinctionCoef(altitude), .0f);
+        opticalDepth += extinction * distancePerStep;
+    }
+    return opticalDepth;
+}
@@ -0,0 +1,40 @@
+#version 450
+#extension GL_GOOGLE_include_directive: require
+#include "spectral_functions.glsl"
+
+layout (constant_id = 0) const bool spectral = false;
+
+layout (binding = 1) uniform sampler2D depthBuffer;
+layout (binding = 2) uniform sampler2D transmittanceImage;
+layout (binding = 3) uniform sampler2D multipleScatteringImage;
+layout (binding = 4) uniform sampler2D skyviewImage;
+layout (binding = 6) uniform sampler2D opticalDepthImage;
+
+layout (push_constant) uniform Constants
+{
+    vec4 CameraPosition_Fov;
+    vec4 CameraForward_AspectRatio;
+    float Time;
+    bool UseSkyview;
+    uint SkyScale; // pattern size, 2 or 4
+    uint SkyPhase;
+};
+
+#include "sky_rays.glsl"
+#include "sky_temporal.glsl"
+
+// linear radiance of the pixel this texel stands for, alpha is 0 on geometry and outside the target
+layout (location = 0) out vec4 outColor;
+
+void main()
+{
+    const ivec2 depthSize = textureSize(depthBuffer, 0);
+    const ivec2 pixel = PackedToPixel(ivec2(gl_FragCoord.xy));
+    if (any(greaterThanEqual(pixel, depthSize)) || texelFetch(depthBuffer, pixel, 0).r < 1.f)
+    {
+        outColor = vec4(.0f);
+        return;
+    }
+
+    outColor = vec4(ShadeSky(FindCameraRay((vec2(pixel) + .5f) / vec2(depthSize))), 1.f);
+}
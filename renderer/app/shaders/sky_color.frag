@@ -4,12 +4,15 @@
 
 layout (constant_id = 0) const bool spectral = false;
 
+// drawn at the far plane with depth testing, covered pixels are rejected before shading
+layout (early_fragment_tests) in;
+
 layout (location = 0) in vec2 inUV;
 
-layout (binding = 1) uniform sampler2D depthBuffer;
 layout (binding = 2) uniform sampler2D transmittanceImage;
 layout (binding = 3) uniform sampler2D multipleScatteringImage;
 layout (binding = 4) uniform sampler2D skyviewImage;
+layout (binding = 6) uniform sampler2D opticalDepthImage;
 
 layout (push_constant) uniform Constants
 {
@@ -58,35 +61,29 @@ vec3 SampleSkyviewLUT(vec3 rayDirection, vec3 sunDirection)
 
 void main()
 {
-    const float depth = texelFetch(depthBuffer, ivec2(inUV * textureSize(depthBuffer, 0)), 0).r;
-    if (depth >= 1.f)
+    const vec3 planetRelativePosition = FindPlanetRelativePosition(CameraPosition_Fov.xyz);
+    const float cameraHeight = length(planetRelativePosition);
+    const vec3 planetUp = planetRelativePosition / cameraHeight;
+    const float altitude = GetSunAltitude(Time);
+    const vec3 sunDirection = normalize(vec3(cos(altitude), sin(altitude), .0f));
+    const vec3 cameraRight = normalize(cross(CameraForward_AspectRatio.xyz, planetUp));
+    const vec3 cameraUp = cross(cameraRight, CameraForward_AspectRatio.xyz);
+    const vec2 centeredUV = (inUV - .5f) * 2.f;
+    const vec3 rayDirection = normalize(
+        CameraForward_AspectRatio.xyz +
+        cameraRight * centeredUV.x * CameraPosition_Fov.w * CameraForward_AspectRatio.w -
+        cameraUp * centeredUV.y * CameraPosition_Fov.w
+    );
+
+    vec3 color;
+    if (cameraHeight > gAtmosphereRadius || !UseSkyview)
     {
-        const vec3 planetRelativePosition = FindPlanetRelativePosition(CameraPosition_Fov.xyz);
-        const float cameraHeight = length(planetRelativePosition);
-        const vec3 planetUp = planetRelativePosition / cameraHeight;
-        const float altitude = GetSunAltitude(Time);
-        const vec3 sunDirection = normalize(vec3(cos(altitude), sin(altitude), .0f));
-        const vec3 cameraRight = normalize(cross(CameraForward_AspectRatio.xyz, planetUp));
-        const vec3 cameraUp = cross(cameraRight, CameraForward_AspectRatio.xyz);
-        const vec2 centeredUV = (inUV - .5f) * 2.f;
-        const vec3 rayDirection = normalize(
-            CameraForward_AspectRatio.xyz +
-            cameraRight * centeredUV.x * CameraPosition_Fov.w * CameraForward_AspectRatio.w -
-            cameraUp * centeredUV.y * CameraPosition_Fov.w
-        );
-
-        vec3 color;
-        if (cameraHeight > gAtmosphereRadius || !UseSkyview)
-        {
-            // directly raymarch when skyview disabled/unavailable
-            color = SimpleToneMap(FindSkyScattering(transmittanceImage, multipleScatteringImage
-                                  , planetRelativePosition, rayDirection, sunDirection, spectral));
-        }
-        else
-        color = SimpleToneMap(SampleSkyviewLUT(rayDirection, sunDirection));
-
-        outColor = vec4(color, 1.f);
-
+        // directly raymarch when skyview disabled/unavailable
+        color = SimpleToneMap(FindSkyScattering(transmittanceImage, multipleScatteringImage, opticalDepthImage
+                              , planetRelativePosition, rayDirection, sunDirection, spectral));
     }
-    else discard;
+    else
+    color = SimpleToneMap(SampleSkyviewLUT(rayDirection, sunDirection));
+
+    outColor = vec4(color, 1.f);
 }
\ No newline at end of file
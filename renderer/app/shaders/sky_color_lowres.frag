@@ -0,0 +1,47 @@
+#version 450
+#extension GL_GOOGLE_include_directive: require
+#include "spectral_functions.glsl"
+
+layout (constant_id = 0) const bool spectral = false;
+
+layout (binding = 1) uniform sampler2D depthBuffer;
+layout (binding = 2) uniform sampler2D transmittanceImage;
+layout (binding = 3) uniform sampler2D multipleScatteringImage;
+layout (binding = 4) uniform sampler2D skyviewImage;
+layout (binding = 6) uniform sampler2D opticalDepthImage;
+
+layout (push_constant) uniform Constants
+{
+    vec4 CameraPosition_Fov;
+    vec4 CameraForward_AspectRatio;
+    float Time;
+    bool UseSkyview;
+    uint SkyScale; // full resolution pixels per texel along each axis
+};
+
+#include "sky_rays.glsl"
+
+// linear radiance and whether the texel saw any sky, sky_upsample.frag tone maps and fills the full resolution target
+layout (location = 0) out vec4 outColor;
+
+void main()
+{
+    // the texel is shaded when any pixel of its footprint shows sky, so every sky pixel has its own texel to upsample from
+    const ivec2 depthSize = textureSize(depthBuffer, 0);
+    const ivec2 footprint = ivec2(gl_FragCoord.xy) * int(SkyScale);
+    bool sky = false;
+    for (int y = 0; y < int(SkyScale); ++y)
+    {
+        for (int x = 0; x < int(SkyScale); ++x)
+        sky = sky || texelFetch(depthBuffer, min(footprint + ivec2(x, y), depthSize - 1), 0).r >= 1.f;
+    }
+    if (!sky)
+    {
+        outColor = vec4(.0f);
+        return;
+    }
+
+    // the ray through the center of the footprint
+    const vec2 uv = gl_FragCoord.xy * float(SkyScale) / vec2(depthSize);
+    outColor = vec4(ShadeSky(FindCameraRay(uv)), 1.f);
+}
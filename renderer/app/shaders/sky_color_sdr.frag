@@ -9,6 +9,7 @@ layout (location = 0) in vec2 inUV;
 layout (binding = 2) uniform sampler2D transmittanceImage;
 layout (binding = 3) uniform sampler2D multipleScatteringImage;
 layout (binding = 4) uniform sampler2D skyviewImage;
+layout (binding = 6) uniform sampler2D opticalDepthImage;
 
 layout (push_constant) uniform Constants
 {
@@ -69,7 +70,7 @@ void main()
         float sinPhi = sin(rayAngles.y);
 
         const vec3 rayDirection = normalize(vec3(sinTheta * cosPhi, cosTheta, sinTheta * sinPhi));
-        color = SimpleToneMap(FindSkyScattering(transmittanceImage, multipleScatteringImage
+        color = SimpleToneMap(FindSkyScattering(transmittanceImage, multipleScatteringImage, opticalDepthImage
                               , planetRelativePosition, rayDirection, sunDirection, spectral));
     }
     else
@@ -0,0 +1,46 @@
+// camera rays and radiance of the reduced sky passes, expects the spectral specialization constant, the sky push constants,
+// transmittanceImage, multipleScatteringImage, skyviewImage and opticalDepthImage to be declared by the including shader
+
+// uv spans the full resolution target, mirrored by App::GetSkyRayBasis
+vec3 FindCameraRay(vec2 uv)
+{
+    const vec3 planetUp = normalize(FindPlanetRelativePosition(CameraPosition_Fov.xyz));
+    const vec3 cameraRight = normalize(cross(CameraForward_AspectRatio.xyz, planetUp));
+    const vec3 cameraUp = cross(cameraRight, CameraForward_AspectRatio.xyz);
+    const vec2 centeredUV = (uv - .5f) * 2.f;
+    return normalize(
+        CameraForward_AspectRatio.xyz +
+        cameraRight * centeredUV.x * CameraPosition_Fov.w * CameraForward_AspectRatio.w -
+        cameraUp * centeredUV.y * CameraPosition_Fov.w
+    );
+}
+
+vec3 SampleSkyviewLUT(vec3 rayDirection)
+{
+    const vec3 planetRelativePosition = FindPlanetRelativePosition(CameraPosition_Fov.xyz);
+
+    const float height = length(planetRelativePosition);
+    const vec3 up = planetRelativePosition / height;
+
+    const float horizonAngle = safeacos(sqrt(pow(height, 2) - pow(gGroundRadius, 2)) / height);
+    const float altitudeAngle = horizonAngle - acos(dot(rayDirection, up));
+
+    const float azimuthAngle = atan(rayDirection.x, -rayDirection.z);
+    const float v = 0.5 + 0.5 * sign(altitudeAngle) * sqrt(abs(altitudeAngle) * 2.0 / gPI);
+    const vec2 uv = vec2(azimuthAngle / (2.0 * gPI) + .5f, v);
+
+    return texture(skyviewImage, uv).rgb;
+}
+
+// linear radiance along a camera ray, the same paths as sky_color.frag
+vec3 ShadeSky(vec3 rayDirection)
+{
+    const vec3 planetRelativePosition = FindPlanetRelativePosition(CameraPosition_Fov.xyz);
+    if (length(planetRelativePosition) <= gAtmosphereRadius && UseSkyview)
+    return SampleSkyviewLUT(rayDirection);
+
+    const float altitude = GetSunAltitude(Time);
+    const vec3 sunDirection = normalize(vec3(cos(altitude), sin(altitude), .0f));
+    return FindSkyScattering(transmittanceImage, multipleScatteringImage, opticalDepthImage
+    , planetRelativePosition, rayDirection, sunDirection, spectral);
+}
@@ -0,0 +1,29 @@
+// pixel pattern of the temporal sky, expects the sky push constants to be declared by the including shader
+// SkyScale 2 shades a checkerboard, 4 one pixel of every 2x2 block, SkyPhase picks which pixels this frame
+// the shaded pixels are packed into a target of half the width, and of half the height too for the 2x2 blocks
+
+ivec2 PatternOffset()
+{
+    return ivec2(SkyPhase & 1u, SkyPhase >> 1u);
+}
+
+ivec2 PackedToPixel(ivec2 texel)
+{
+    if (SkyScale == 2u)
+    return ivec2(2 * texel.x + ((texel.y + int(SkyPhase)) & 1), texel.y);
+    return 2 * texel + PatternOffset();
+}
+
+bool IsShadedPixel(ivec2 pixel)
+{
+    if (SkyScale == 2u)
+    return ((pixel.x + pixel.y + int(SkyPhase)) & 1) == 0;
+    return (pixel & 1) == PatternOffset();
+}
+
+ivec2 PixelToPacked(ivec2 pixel)
+{
+    if (SkyScale == 2u)
+    return ivec2(pixel.x >> 1, pixel.y);
+    return pixel >> 1;
+}
@@ -0,0 +1,107 @@
+#version 450
+#extension GL_GOOGLE_include_directive: require
+#include "spectral_functions.glsl"
+
+layout (constant_id = 0) const bool spectral = false;
+
+// drawn at the far plane with depth testing, geometry pixels keep the cleared, invalid history
+layout (early_fragment_tests) in;
+
+layout (binding = 2) uniform sampler2D transmittanceImage;
+layout (binding = 3) uniform sampler2D multipleScatteringImage;
+layout (binding = 4) uniform sampler2D skyviewImage;
+layout (binding = 6) uniform sampler2D opticalDepthImage;
+layout (binding = 8) uniform sampler2D shadedSkyImage;   // this frame's pattern, see sky_checkerboard.frag
+layout (binding = 9) uniform sampler2D previousSkyImage; // the previous frame's output of this pass
+
+layout (push_constant) uniform Constants
+{
+    vec4 CameraPosition_Fov;
+    vec4 CameraForward_AspectRatio;
+    float Time;
+    bool UseSkyview;
+    uint SkyScale; // pattern size, 2 or 4
+    uint SkyPhase;
+    mat3 PreviousSkyBasis; // right, up and forward of the previous frame's rays, see FindCameraRay
+    bool HistoryValid;     // false after a large sun or camera change, every pixel is ray marched
+};
+
+#include "sky_rays.glsl"
+#include "sky_temporal.glsl"
+
+// linear radiance of every pixel and whether it is sky, composited by sky_upsample.frag and reprojected next frame
+layout (location = 0) out vec4 outColor;
+
+vec4 FetchShaded(ivec2 pixel, ivec2 size)
+{
+    if (any(lessThan(pixel, ivec2(0))) || any(greaterThanEqual(pixel, size)))
+    return vec4(.0f);
+    return texelFetch(shadedSkyImage, PixelToPacked(pixel), 0);
+}
+
+void main()
+{
+    // the history has the full resolution extent
+    const ivec2 targetSize = textureSize(previousSkyImage, 0);
+    const ivec2 pixel = ivec2(gl_FragCoord.xy);
+    if (IsShadedPixel(pixel))
+    {
+        outColor = FetchShaded(pixel, targetSize);
+        return;
+    }
+
+    // the nearest shaded sky pixels, the four direct neighbours of the checkerboard or the corners of the 2x2 grid
+    ivec2 neighbours[4];
+    vec4 weights;
+    if (SkyScale == 2u)
+    {
+        neighbours = ivec2[4](pixel - ivec2(1, 0), pixel + ivec2(1, 0), pixel - ivec2(0, 1), pixel + ivec2(0, 1));
+        weights = vec4(1.f);
+    }
+    else
+    {
+        const ivec2 corner = ((pixel - PatternOffset()) >> 1) * 2 + PatternOffset();
+        const vec2 fraction = vec2(pixel - corner) * .5f;
+        neighbours = ivec2[4](corner, corner + ivec2(2, 0), corner + ivec2(0, 2), corner + ivec2(2, 2));
+        weights = vec4((1.f - fraction.x) * (1.f - fraction.y), fraction.x * (1.f - fraction.y)
+        , (1.f - fraction.x) * fraction.y, fraction.x * fraction.y);
+    }
+
+    vec4 spatial = vec4(.0f);
+    vec3 low = vec3(1e30f);
+    vec3 high = vec3(.0f);
+    for (int index = 0; index < 4; ++index)
+    {
+        const vec4 neighbour = FetchShaded(neighbours[index], targetSize);
+        if (neighbour.a <= .0f)
+        continue;
+        spatial += vec4(neighbour.rgb, 1.f) * weights[index];
+        low = min(low, neighbour.rgb);
+        high = max(high, neighbour.rgb);
+    }
+
+    const vec3 rayDirection = FindCameraRay((vec2(pixel) + .5f) / vec2(targetSize));
+    if (HistoryValid && spatial.a > .0f)
+    {
+        const vec3 previous = transpose(PreviousSkyBasis) * rayDirection;
+        const vec2 uv = vec2(previous.x / (CameraPosition_Fov.w * CameraForward_AspectRatio.w), -previous.y / CameraPosition_Fov.w)
+        / previous.z * .5f + .5f;
+        if (previous.z > .0f && all(greaterThanEqual(uv, vec2(.0f))) && all(lessThanEqual(uv, vec2(1.f))))
+        {
+            // kept half a texel inside, the shared sampler repeats horizontally
+            const vec2 halfTexel = .5f / vec2(targetSize);
+            const vec4 history = texture(previousSkyImage, clamp(uv, halfTexel, 1.f - halfTexel));
+            // any geometry texel in the footprint rejects the history, the shaded neighbours bound what is left of the sun drift
+            if (history.a > .999f)
+            {
+                outColor = vec4(clamp(history.rgb, low, high), 1.f);
+                return;
+            }
+        }
+        outColor = vec4(spatial.rgb / spatial.a, 1.f);
+        return;
+    }
+
+    // history rejected for the whole frame, or a sky pixel without shaded sky around it
+    outColor = vec4(ShadeSky(rayDirection), 1.f);
+}
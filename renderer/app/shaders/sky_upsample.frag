@@ -0,0 +1,50 @@
+#version 450
+
+// drawn at the far plane with depth testing, geometry keeps its full resolution edge and is never shaded
+layout (early_fragment_tests) in;
+
+layout (binding = 7) uniform sampler2D lowResSkyImage;
+
+layout (push_constant) uniform Constants
+{
+    vec4 CameraPosition_Fov;
+    vec4 CameraForward_AspectRatio;
+    float Time;
+    bool UseSkyview;
+    uint SkyScale; // full resolution pixels per low resolution texel along each axis
+};
+
+layout (location = 0) out vec4 outColor;
+
+vec3 SimpleToneMap(vec3 color)
+{
+    const float k = 0.05;
+    color = 1.0 - exp(-k * color);
+    return color;
+}
+
+void main()
+{
+    const ivec2 pixel = ivec2(gl_FragCoord.xy);
+
+    // bilinear weights over the four nearest texels, texels whose footprint held no sky carry no weight
+    // so geometry colors never bleed into the sky, see sky_color_lowres.frag
+    const ivec2 lowResSize = textureSize(lowResSkyImage, 0);
+    const vec2 position = (vec2(pixel) + .5f) / float(SkyScale) - .5f;
+    const ivec2 base = ivec2(floor(position));
+    const vec2 fraction = position - vec2(base);
+
+    vec4 sum = vec4(.0f);
+    for (int y = 0; y < 2; ++y)
+    {
+        for (int x = 0; x < 2; ++x)
+        {
+            const vec4 texel = texelFetch(lowResSkyImage, clamp(base + ivec2(x, y), ivec2(0), lowResSize - 1), 0);
+            const vec2 axisWeights = mix(1.f - fraction, fraction, vec2(x, y));
+            const float weight = axisWeights.x * axisWeights.y * texel.a;
+            sum += vec4(texel.rgb * weight, weight);
+        }
+    }
+    // the texel containing the pixel always saw sky, the guard only covers rounding
+    outColor = vec4(SimpleToneMap(sum.rgb / max(sum.a, 1e-6f)), 1.f);
+}
@@ -0,0 +1,24 @@
+// expects the spectral specialization constant, transmittanceImage, multipleScatteringImage and opticalDepthImage
+// to be declared by the including shader
+float ConvertToElevation(float v)
+{
+    const float latitude = 2.f * v - 1.f;
+    return latitude * abs(latitude) * gPI * .5f; // preserve sign after squaring
+}
+
+vec4 SkyviewLUTTexel(vec2 uv, vec3 cameraPosition, float time)
+{
+    const float azimuth = (uv.x - .5f) * 2.f * gPI;
+    const vec3 planetRelativePosition = FindPlanetRelativePosition(cameraPosition);
+    const float elevation = ConvertToElevation(uv.y);
+
+    const float cosElevation = cos(elevation);
+
+    const vec3 rayDirection = vec3(cosElevation * sin(azimuth), sin(elevation), -cosElevation * cos(azimuth));
+
+    const float sunAltitude = GetSunAltitude(time);
+    const vec3 sunDirection = normalize(vec3(cos(sunAltitude), sin(sunAltitude), .0f));
+    const vec3 luminance = FindSkyScattering(transmittanceImage, multipleScatteringImage, opticalDepthImage, planetRelativePosition, rayDirection, sunDirection, spectral);
+
+    return vec4(luminance, 1.f);
+}
@@ -23,7 +23,7 @@ vec4 SpectralExtinctionCoef(float altitude)
     return molecular_absorption + molecular_scattering + mieScattering + mieAbsorption;
 }
 
-vec3 FindSkyScatteringSpectral(sampler2D transmittanceImage, sampler2D multipleScatteringImage
+vec3 FindSkyScatteringSpectral(sampler2D transmittanceImage, sampler2D multipleScatteringImage, sampler2D opticalDepthImage
 , vec3 viewPosition, vec3 rayDirection, vec3 sunDirection)
 {
     const vec2 atmosphereExits = RayIntersectSphere2D(viewPosition, rayDirection, gAtmosphereRadius);
@@ -45,12 +45,21 @@ vec3 FindSkyScatteringSpectral(sampler2D transmittanceImage, sampler2D multipleS
     const float miePhase = MiePhase(cosTheta);
     const float rayleighPhase = RayleighPhase(-cosTheta);
 
+    const ScatteringMarch march = PlanScatteringMarch(rayStart, rayDirection, maxDistance - minDistance, distanceToGround > .0f);
+
+    // rays into the ground are looked up backwards from each sample, their reverse misses the ground
+    const float depthSign = distanceToGround > .0f ? -1.f : 1.f;
+    const vec3 depthDirection = depthSign * rayDirection;
+    const vec4 startDepth = gOpticalDepthLUTMarch ? SampleOpticalDepthLUT(opticalDepthImage, rayStart, depthDirection) : vec4(.0f);
+
     vec4 luminance = vec4(.0f);
     vec4 transmittance = vec4(1.f);
+    vec4 previousDepth = vec4(.0f);
     float t = .0f;
-    for (float step = .0f; step < gScatteringSamples; ++step)
+    gScatteringStepsTaken = 0;
+    for (float step = .0f; step < march.Steps; ++step)
     {
-        const float newT = ((step + .3f) / gScatteringSamples) * (maxDistance - minDistance);
+        const float newT = ScatteringSampleDistance(march, step, maxDistance - minDistance);
         const float deltaT = newT - t;
         t = newT;
 
@@ -60,9 +69,7 @@ vec3 FindSkyScatteringSpectral(sampler2D transmittanceImage, sampler2D multipleS
 
         const float mieScattering = MieScattering(altitude);
         const vec4 moleculeScattering = GetMolecularScatteringCoef(altitude);
-        const vec4 extinction = SpectralExtinctionCoef(altitude);
 
-        const vec4 stepTransmittance = exp(-deltaT * extinction);
         const vec3 up = normalize(position);
         const float sunZenithCosAngle = dot(sunDirection, up);
 
@@ -73,22 +80,46 @@ vec3 FindSkyScatteringSpectral(sampler2D transmittanceImage, sampler2D multipleS
         const vec4 mieInScattering = mieScattering * (miePhase * sunTransmittance + psims);
         const vec4 totalInScattering = gSunSpectralIrradiance * (rayleighInScattering + mieInScattering);
 
-        const vec4 scatteringIntegral = (totalInScattering - totalInScattering * stepTransmittance) / extinction;
-
-        luminance += scatteringIntegral * transmittance;
-
-        transmittance *= stepTransmittance;
+        if (gOpticalDepthLUTMarch)
+        {
+            // skips the ozone and molecular absorption terms of the extinction
+            // clamped to the previous depth, texel error must not make the transmittance grow along the ray
+            const vec4 opticalDepth = max(depthSign * (startDepth - SampleOpticalDepthLUT(opticalDepthImage, position, depthDirection)), previousDepth);
+            const vec4 segmentDepth = opticalDepth - previousDepth;
+            const vec4 newTransmittance = exp(-opticalDepth);
+
+            // the same segment integral as the analytic march, (1 - stepTransmittance) / extinction with the LUT at both ends
+            // a thin segment falls back to the trapezoid, the difference of transmittances loses every digit there
+            const vec4 segmentIntegral = mix((transmittance - newTransmittance) / max(segmentDepth, vec4(1e-4f)), .5f * (transmittance + newTransmittance), lessThan(segmentDepth, vec4(1e-4f)));
+            luminance += totalInScattering * segmentIntegral * deltaT;
+
+            transmittance = newTransmittance;
+            previousDepth = opticalDepth;
+        }
+        else
+        {
+            const vec4 extinction = SpectralExtinctionCoef(altitude);
+            const vec4 stepTransmittance = exp(-deltaT * extinction);
+            const vec4 scatteringIntegral = (totalInScattering - totalInScattering * stepTransmittance) / extinction;
+
+            luminance += scatteringIntegral * transmittance;
+
+            transmittance *= stepTransmittance;
+        }
+        ++gScatteringStepsTaken;
+        if (gAdaptiveScattering && max(max(transmittance.x, transmittance.y), max(transmittance.z, transmittance.w)) < gScatteringTransmittanceCutoff)
+        break;
     }
 
     return gRGBConversionMatrix * luminance;
 }
 
-vec3 FindSkyScattering(sampler2D transmittanceImage, sampler2D multipleScatteringImage
+vec3 FindSkyScattering(sampler2D transmittanceImage, sampler2D multipleScatteringImage, sampler2D opticalDepthImage
 , vec3 viewPosition, vec3 rayDirection, vec3 sunDirection, bool spectral)
 {
     if (spectral)
-    return FindSkyScatteringSpectral(transmittanceImage, multipleScatteringImage, viewPosition, rayDirection, sunDirection);
+    return FindSkyScatteringSpectral(transmittanceImage, multipleScatteringImage, opticalDepthImage, viewPosition, rayDirection, sunDirection);
     else
-    return FindSkyScatteringRGB(transmittanceImage, multipleScatteringImage, viewPosition, rayDirection, sunDirection);
+    return FindSkyScatteringRGB(transmittanceImage, multipleScatteringImage, opticalDepthImage, viewPosition, rayDirection, sunDirection);
 }
 
@@ -1,10 +1,24 @@
 #include "app.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <limits>
 #include <numeric>
+#include <optional>
+#include <ranges>
+#include <ratio>
+#include <thread>
+#include <tuple>
 
 #include "command_pool.h"
+#include "compute_pipeline.h"
 #include "datatypes.h"
+#include "embedded_shaders.h"
 #include "descriptor_pool.h"
 #include "descriptor_set_layout.h"
 #include "helper.h"
@@ -14,110 +28,316 @@
 
 #include <span>
 
-#include "file_saver.h"
+#include "benchmark.h"
+#include "frame_log.h"
+#include "frame_timer.h"
+#include "image_writer.h"
+#include "job_manifest.h"
+#include "lut_cache.h"
+#include "pipeline_cache.h"
+#include "process_memory.h"
 #include "vma_usage.h"
 #include "timing_query_pool.h"
+#include "volume_image.h"
 
+// GPU duration of every sample in milliseconds, sorted
+// batched samples are timed back to back in one submission instead of paying the submit and fence round trip each
 template<typename FunctionType>
-double ProfileAndReturn
+std::vector<double> ProfileSamples
 (
-	vkc::Context&         context
-	, vkc::CommandBuffer& commandBuffer
-	, TimingQueryPool&    queryPool
-	, int                 samples
-	, float               extremePercent
-	, FunctionType        function
+	vkc::Context&           context
+	, VkQueue               queue
+	, vkc::CommandBuffer&   commandBuffer
+	, TimingQueryPool&      queryPool
+	, int                   samples
+	, ProfileBatching const batching
+	, FunctionType          function
 )
 {
-	auto const margin{ static_cast<int>(samples * extremePercent) };
-	assert(extremePercent <= .4f && "percentage of extremes to trim is too large");
-	assert(extremePercent >.0f && "percentage of extremes to trim is too small");
-	assert(samples > 2 * margin);
-
 	Timings             timings;
 	std::vector<double> delays;
 	delays.reserve(samples);
 
-	for (int index{}; index < samples; ++index)
+	if (batching.Repetitions == 0)
+	{
+		for (int index{}; index < samples; ++index)
+		{
+			commandBuffer.Reset(context);
+			commandBuffer.Begin(context);
+			queryPool.Reset(commandBuffer);
+			queryPool.RecordWholePipe(commandBuffer, "profiling", 0, function, commandBuffer);
+			commandBuffer.End(context);
+			commandBuffer.Submit(context, queue, {}, {});
+			if (auto const result = context.DispatchTable.waitForFences(1, &commandBuffer.GetFence(), VK_TRUE, UINT64_MAX);
+				result != VK_SUCCESS)
+				throw std::runtime_error("Failed to wait for a fence");
+			queryPool.GetResults(context, timings);
+			delays.emplace_back(timings[0].GetDuration());
+		}
+
+		std::ranges::sort(delays);
+		return delays;
+	}
+
+	// one timestamp pair per repetition does not fit the labelled pool, the batch gets its own
+	uint32_t const        queryCount{ batching.Repetitions * 2 };
+	VkQueryPoolCreateInfo createInfo{};
+	createInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	createInfo.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+	createInfo.queryCount = queryCount;
+	VkQueryPool batchQueryPool{};
+	if (context.DispatchTable.createQueryPool(&createInfo, nullptr, &batchQueryPool) != VK_SUCCESS)
+		throw std::runtime_error("Failed to create a batched profiling query pool");
+
+	// repetitions write the same targets, draining between them keeps every pair around exactly one repetition
+	VkMemoryBarrier2 barrier{};
+	barrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+	barrier.srcStageMask  = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+	barrier.srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT;
+	barrier.dstStageMask  = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+	barrier.dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+	VkDependencyInfo dependencyInfo{};
+	dependencyInfo.sType              = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	dependencyInfo.memoryBarrierCount = 1;
+	dependencyInfo.pMemoryBarriers    = &barrier;
+
+	double const          nanosecondsPerTick{ queryPool.GetTimestampPeriod() };
+	std::vector<uint64_t> timestamps(queryCount);
+	while (delays.size() < static_cast<size_t>(samples))
 	{
 		commandBuffer.Reset(context);
 		commandBuffer.Begin(context);
-		queryPool.Reset(commandBuffer);
-		queryPool.RecordWholePipe(commandBuffer, "profiling", 0, function, commandBuffer);
+		vkCmdResetQueryPool(commandBuffer, batchQueryPool, 0, queryCount);
+		for (uint32_t repetition{}; repetition < batching.Warmup + batching.Repetitions; ++repetition)
+		{
+			context.DispatchTable.cmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+			if (repetition < batching.Warmup)
+			{
+				function(commandBuffer);
+				continue;
+			}
+			uint32_t const query{ (repetition - batching.Warmup) * 2 };
+			vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, batchQueryPool, query);
+			function(commandBuffer);
+			vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, batchQueryPool, query + 1);
+		}
 		commandBuffer.End(context);
-		commandBuffer.Submit(context, context.GraphicsQueue, {}, {});
+		commandBuffer.Submit(context, queue, {}, {});
 		if (auto const result = context.DispatchTable.waitForFences(1, &commandBuffer.GetFence(), VK_TRUE, UINT64_MAX);
 			result != VK_SUCCESS)
 			throw std::runtime_error("Failed to wait for a fence");
-		queryPool.GetResults(context, timings);
-		delays.emplace_back(timings[0].GetDuration());
+		context.DispatchTable.getQueryPoolResults(batchQueryPool
+												  , 0
+												  , queryCount
+												  , timestamps.size() * sizeof(uint64_t)
+												  , timestamps.data()
+												  , sizeof(uint64_t)
+												  , VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+
+		for (uint32_t repetition{}; repetition < batching.Repetitions && delays.size() < static_cast<size_t>(samples); ++repetition)
+		{
+			double const ticks{ static_cast<double>(timestamps[repetition * 2 + 1] - timestamps[repetition * 2]) };
+			delays.emplace_back(ticks * nanosecondsPerTick / static_cast<double>(std::micro::den));
+		}
 	}
+	context.DispatchTable.destroyQueryPool(batchQueryPool, nullptr);
 
 	std::ranges::sort(delays);
+	return delays;
+}
+
+struct ProfileResult
+{
+	double        TrimmedMean;
+	SampleSummary Summary;
+};
 
-	return std::accumulate(delays.begin() + margin, delays.end() - margin, 0.) / (samples - 2 * margin);
+namespace
+{
+	// the time domain steady_clock is built on, see Tracer::FromHostTimeDomain
+#ifdef _WIN32
+	VkTimeDomainEXT constexpr HOST_TIME_DOMAIN{ VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT };
+#else
+	VkTimeDomainEXT constexpr HOST_TIME_DOMAIN{ VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT };
+#endif
 }
 
-void App::ProfilePipelinesAndDump()
+// frame timers are optional, untimed passes are recorded as they are
+template<typename FunctionType>
+void RecordTimed(FrameTimer* timer, vkc::CommandBuffer const& commandBuffer, uint32_t scope, FunctionType function)
 {
-	using std::placeholders::_1;
+	if (timer)
+		timer->Record(commandBuffer, scope, function);
+	else
+		function();
+}
+
+template<typename FunctionType>
+ProfileResult ProfileAndReturn
+(
+	vkc::Context&           context
+	, VkQueue               queue
+	, vkc::CommandBuffer&   commandBuffer
+	, TimingQueryPool&      queryPool
+	, int                   samples
+	, float                 extremePercent
+	, ProfileBatching const batching
+	, FunctionType          function
+)
+{
+	auto const margin{ static_cast<int>(samples * extremePercent) };
+	assert(extremePercent <= .4f && "percentage of extremes to trim is too large");
+	assert(extremePercent >.0f && "percentage of extremes to trim is too small");
+	assert(samples > 2 * margin);
 
-	double const transmittanceComputeTime = ProfileAndReturn(m_Context
-															 , m_CommandPool->AllocateCommandBuffer(m_Context)
-															 , *m_QueryPool
-															 , 1000
-															 , .1f
-															 , [this](vkc::CommandBuffer& commandBuffer)
-															 {
-																 GenerateTransmittanceLUT(commandBuffer);
-															 });
-
-	double const multipleScatteringComputeTime = ProfileAndReturn(m_Context
-																  , m_CommandPool->AllocateCommandBuffer(m_Context)
-																  , *m_QueryPool
-																  , 1000
-																  , .1f
-																  , [this](vkc::CommandBuffer& commandBuffer)
-																  {
-																	  GenerateMultScatteringLUT(commandBuffer);
-																  });
-
-	double const skyviewComputeTime = ProfileAndReturn(m_Context
-													   , m_CommandPool->AllocateCommandBuffer(m_Context)
-													   , *m_QueryPool
-													   , 1000
-													   , .1f
-													   , [this](vkc::CommandBuffer& commandBuffer)
-													   {
-														   GenerateSkyviewLUT(commandBuffer);
-													   });
+	std::vector<double> const delays{ ProfileSamples(context, queue, commandBuffer, queryPool, samples, batching, function) };
 
-	auto [pipeline, stagingImage, stagingImageView] = GenerateTempImageAndPipeline(false);
+	return {
+		std::accumulate(delays.begin() + margin, delays.end() - margin, 0.) / (samples - 2 * margin)
+		, Summarize(delays)
+	};
+}
 
-	m_UseSkyview = true;
+void App::ProfilePipelinesAndDump()
+{
+	using std::placeholders::_1;
 
-	double const finalRenderTime = ProfileAndReturn(m_Context
+	ProfileResult const transmittanceComputeTime = ProfileAndReturn(m_Context
+																	, m_Context.GraphicsQueue
+																	, m_CommandPool->AllocateCommandBuffer(m_Context)
+																	, *m_QueryPool
+																	, 1000
+																	, .1f
+																	, m_Options.Profiling
+																	, [this](vkc::CommandBuffer& commandBuffer)
+																	{
+																		GenerateTransmittanceLUT(commandBuffer);
+																	});
+
+	ProfileResult const multipleScatteringComputeTime = ProfileAndReturn(m_Context
+																		 , m_Context.GraphicsQueue
+																		 , m_CommandPool->AllocateCommandBuffer(m_Context)
+																		 , *m_QueryPool
+																		 , 1000
+																		 , .1f
+																		 , m_Options.Profiling
+																		 , [this](vkc::CommandBuffer& commandBuffer)
+																		 {
+																			 GenerateMultScatteringLUT(commandBuffer);
+																		 });
+
+	ProfileResult const skyviewComputeTime = ProfileAndReturn(m_Context
+															  , m_Context.GraphicsQueue
+															  , m_CommandPool->AllocateCommandBuffer(m_Context)
+															  , *m_QueryPool
+															  , 1000
+															  , .1f
+															  , m_Options.Profiling
+															  , [this](vkc::CommandBuffer& commandBuffer)
+															  {
+																  GenerateSkyviewLUT(commandBuffer);
+															  });
+
+	ProfileResult transmittanceComputeShaderTime{};
+	ProfileResult multipleScatteringComputeShaderTime{};
+	ProfileResult skyviewComputeShaderTime{};
+	if (m_ComputeLUTs)
+	{
+		transmittanceComputeShaderTime = ProfileAndReturn(m_Context
+														  , m_Context.GraphicsQueue
+														  , m_CommandPool->AllocateCommandBuffer(m_Context)
+														  , *m_QueryPool
+														  , 1000
+														  , .1f
+														  , m_Options.Profiling
+														  , [this](vkc::CommandBuffer& commandBuffer)
+														  {
+															  GenerateTransmittanceLUTCompute(commandBuffer);
+														  });
+
+		multipleScatteringComputeShaderTime = ProfileAndReturn(m_Context
+															   , m_Context.GraphicsQueue
+															   , m_CommandPool->AllocateCommandBuffer(m_Context)
+															   , *m_QueryPool
+															   , 1000
+															   , .1f
+															   , m_Options.Profiling
+															   , [this](vkc::CommandBuffer& commandBuffer)
+															   {
+																   GenerateMultScatteringLUTCompute(commandBuffer);
+															   });
+
+		skyviewComputeShaderTime = ProfileAndReturn(m_Context
+													, m_Context.GraphicsQueue
 													, m_CommandPool->AllocateCommandBuffer(m_Context)
 													, *m_QueryPool
 													, 1000
 													, .1f
-													, [this, &pipeline, &stagingImage, &stagingImageView](vkc::CommandBuffer& commandBuffer)
+													, m_Options.Profiling
+													, [this](vkc::CommandBuffer& commandBuffer)
 													{
-														RenderSkyToImage(commandBuffer, stagingImage, stagingImageView, pipeline);
+														GenerateSkyviewLUTCompute(commandBuffer, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT);
 													});
+	}
+
+	ProfileResult skyviewResolveTime{};
+	if (m_SkyviewArrayImage)
+	{
+		skyviewResolveTime = ProfileAndReturn(m_Context
+											  , m_Context.GraphicsQueue
+											  , m_CommandPool->AllocateCommandBuffer(m_Context)
+											  , *m_QueryPool
+											  , 1000
+											  , .1f
+											  , m_Options.Profiling
+											  , [this](vkc::CommandBuffer& commandBuffer)
+											  {
+												  ResolveSkyviewArray(commandBuffer, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT);
+											  });
+	}
+
+	ProfileResult const aerialPerspectiveTime = ProfileAndReturn(m_Context
+																 , m_Context.GraphicsQueue
+																 , m_CommandPool->AllocateCommandBuffer(m_Context)
+																 , *m_QueryPool
+																 , 1000
+																 , .1f
+																 , m_Options.Profiling
+																 , [this](vkc::CommandBuffer& commandBuffer)
+																 {
+																	 GenerateAerialPerspective(commandBuffer);
+																 });
+
+	auto [pipeline, stagingImage, stagingImageView] = GenerateTempImageAndPipeline(false);
+
+	m_UseSkyview = true;
+
+	ProfileResult const finalRenderTime = ProfileAndReturn(m_Context
+														   , m_Context.GraphicsQueue
+														   , m_CommandPool->AllocateCommandBuffer(m_Context)
+														   , *m_QueryPool
+														   , 1000
+														   , .1f
+														   , m_Options.Profiling
+														   , [this, &pipeline, &stagingImage, &stagingImageView](vkc::CommandBuffer& commandBuffer)
+														   {
+															   RenderSkyToImage(commandBuffer, stagingImage, stagingImageView, pipeline);
+														   });
 
 	m_UseSkyview = false;
 
-	double const finalRenderNoSkyViewTime = ProfileAndReturn(m_Context
-															 , m_CommandPool->AllocateCommandBuffer(m_Context)
-															 , *m_QueryPool
-															 , 1000
-															 , .1f
-															 , [this, &pipeline, &stagingImage, &stagingImageView]
-														 (vkc::CommandBuffer& commandBuffer)
-															 {
-																 RenderSkyToImage(commandBuffer, stagingImage, stagingImageView, pipeline);
-															 });
+	ProfileResult const finalRenderNoSkyViewTime = ProfileAndReturn(m_Context
+																	, m_Context.GraphicsQueue
+																	, m_CommandPool->AllocateCommandBuffer(m_Context)
+																	, *m_QueryPool
+																	, 1000
+																	, .1f
+																	, m_Options.Profiling
+																	, [this, &pipeline, &stagingImage, &stagingImageView]
+																(vkc::CommandBuffer& commandBuffer)
+																	{
+																		RenderSkyToImage(commandBuffer, stagingImage, stagingImageView, pipeline);
+																	});
 	stagingImageView.Destroy(m_Context);
 	stagingImage.Destroy(m_Context);
 	pipeline.Destroy(m_Context);
@@ -125,13 +345,255 @@ void App::ProfilePipelinesAndDump()
 	{
 		std::string filename{ "profile_dump" };
 		filename += m_Spectral ? "_spectral" : "_rgb";
-		std::ofstream profileDump{ filename + ".csv", std::ios::out };
-		profileDump << "transmittance LUT," << transmittanceComputeTime << std::endl;
-		profileDump << "multiple scattering LUT," << multipleScatteringComputeTime << std::endl;
-		profileDump << "sky-view LUT," << skyviewComputeTime << std::endl;
-		profileDump << "final render," << finalRenderTime << std::endl;
-		profileDump << "final render no LUTs," << finalRenderNoSkyViewTime << std::endl;
+		std::filesystem::create_directories(m_Options.OutputDirectory);
+		std::ofstream profileDump{ m_Options.OutputDirectory / (filename + ".csv"), std::ios::out };
+		// the trimmed mean stays in the second column so older dumps compare directly
+		auto const writeRow = [&profileDump](std::string_view name, ProfileResult const& result)
+		{
+			SampleSummary const& summary{ result.Summary };
+			profileDump << name << ',' << result.TrimmedMean << ',' << summary.Median << ',' << summary.MedianAbsoluteDeviation << ','
+					<< summary.P5 << ',' << summary.P95 << ',' << summary.MedianLow << ',' << summary.MedianHigh << ',' << summary.Count
+					<< std::endl;
+		};
+		writeRow("transmittance LUT", transmittanceComputeTime);
+		writeRow("multiple scattering LUT", multipleScatteringComputeTime);
+		writeRow("sky-view LUT", skyviewComputeTime);
+		writeRow("final render", finalRenderTime);
+		writeRow("final render no LUTs", finalRenderNoSkyViewTime);
+		writeRow("aerial perspective LUT", aerialPerspectiveTime);
+		if (m_ComputeLUTs)
+		{
+			writeRow("transmittance LUT compute", transmittanceComputeShaderTime);
+			writeRow("multiple scattering LUT compute", multipleScatteringComputeShaderTime);
+			writeRow("sky-view LUT compute", skyviewComputeShaderTime);
+		}
+		if (m_SkyviewArrayImage)
+			writeRow("sky-view array resolve", skyviewResolveTime);
+	}
+}
+
+void App::RunBenchmark()
+{
+	int const  samples{ static_cast<int>(m_Options.BenchmarkSamples) };
+	auto const profile = [this, samples](std::string name, auto function)
+	{
+		return PassSamples{
+			std::move(name)
+			, ProfileSamples(m_Context
+							 , m_Context.GraphicsQueue
+							 , m_CommandPool->AllocateCommandBuffer(m_Context)
+							 , *m_QueryPool
+							 , samples
+							 , m_Options.Profiling
+							 , function)
+		};
+	};
+
+	std::vector<PassSamples> staticPasses{};
+	staticPasses.emplace_back(profile("transmittance LUT"
+									  , [this](vkc::CommandBuffer& commandBuffer)
+									  {
+										  if (m_ComputeLUTs)
+											  GenerateTransmittanceLUTCompute(commandBuffer);
+										  else
+											  GenerateTransmittanceLUT(commandBuffer);
+									  }));
+	staticPasses.emplace_back(profile("multiple scattering LUT"
+									  , [this](vkc::CommandBuffer& commandBuffer)
+									  {
+										  if (m_ComputeLUTs)
+											  GenerateMultScatteringLUTCompute(commandBuffer);
+										  else
+											  GenerateMultScatteringLUT(commandBuffer);
+									  }));
+	staticPasses.emplace_back(profile("optical depth LUT"
+									  , [this](vkc::CommandBuffer& commandBuffer)
+									  {
+										  GenerateOpticalDepthLUT(commandBuffer);
+									  }));
+
+	auto [pipeline, stagingImage, stagingImageView] = GenerateTempImageAndPipeline(false);
+	bool const                  useSkyview{ m_UseSkyview };
+	std::vector<ScenarioResult> results{};
+	for (BenchmarkScenario const& scenario: GetBenchmarkScenarios())
+	{
+		m_Camera->SetPosition(scenario.CameraPosition);
+		m_Camera->SetForward(scenario.CameraForward);
+		m_Options.Time = scenario.Time;
+
+		ScenarioResult& result{ results.emplace_back(ScenarioResult{ scenario, {} }) };
+		result.Passes.emplace_back(profile("sky-view LUT"
+										   , [this](vkc::CommandBuffer& commandBuffer)
+										   {
+											   RecordSkyviewLUT(commandBuffer);
+										   }));
+		result.Passes.emplace_back(profile("aerial perspective LUT"
+										   , [this](vkc::CommandBuffer& commandBuffer)
+										   {
+											   GenerateAerialPerspective(commandBuffer);
+										   }));
+		for (bool const skyview: { true, false })
+		{
+			m_UseSkyview = skyview;
+			result.Passes.emplace_back(profile(skyview ? "final render sky-view" : "final render ray march"
+											   , [this, &pipeline, &stagingImage, &stagingImageView](vkc::CommandBuffer& commandBuffer)
+											   {
+												   RenderSkyToImage(commandBuffer, stagingImage, stagingImageView, pipeline);
+											   }));
+		}
+		// the reduced resolution march includes its upsample, m_UseSkyview is still off from the last pass
+		if (m_LowResSkyImage)
+			for (uint32_t const skyScale: { 2u, 4u })
+				result.Passes.emplace_back(profile("final render ray march 1/" + std::to_string(skyScale) + " resolution"
+												   , [this, skyScale, &stagingImage, &stagingImageView](vkc::CommandBuffer& commandBuffer)
+												   {
+													   RenderLowResSkyToImage(commandBuffer, stagingImage, stagingImageView, skyScale);
+												   }));
+		std::cout << "benchmark scenario " << scenario.Name << " done" << std::endl;
+	}
+	m_UseSkyview = useSkyview;
+
+	stagingImageView.Destroy(m_Context);
+	stagingImage.Destroy(m_Context);
+	pipeline.Destroy(m_Context);
+
+	std::filesystem::path const path{ m_Options.OutputDirectory / m_Options.BenchmarkResults };
+	WriteBenchmarkResults(path
+						  , { m_DeviceProperties.deviceName
+							  , m_DeviceProperties.vendorID
+							  , m_DeviceProperties.deviceID
+							  , m_DeviceProperties.driverVersion
+							  , m_DeviceProperties.apiVersion }
+						  , { static_cast<uint32_t>(m_Options.Width)
+							  , static_cast<uint32_t>(m_Options.Height)
+							  , m_Options.BenchmarkSamples
+							  , m_Options.Profiling.Repetitions
+							  , m_Options.Profiling.Warmup
+							  , m_Spectral
+							  , m_ComputeLUTs
+							  , std::string{ GetQualityTierName(m_Options.Tier) }
+							  , m_Options.Quality.AdaptiveScattering
+							  , m_Options.Quality.OpticalDepthLUT }
+						  , staticPasses
+						  , results);
+	std::cout << "benchmark results written to " << path << std::endl;
+
+	// the full and reduced resolution ray march side by side, medians averaged over the scenarios
+	std::cout << "ray marched sky at " << m_RenderExtent.width << "x" << m_RenderExtent.height << ":" << std::endl;
+	for (PassSamples const& pass: results.front().Passes)
+	{
+		if (!pass.Name.starts_with("final render ray march"))
+			continue;
+		double milliseconds{};
+		for (ScenarioResult const& result: results)
+			for (PassSamples const& other: result.Passes)
+				if (other.Name == pass.Name)
+					milliseconds += Summarize(other.Milliseconds).Median / static_cast<double>(results.size());
+		std::cout << "  " << pass.Name << ": " << milliseconds << " ms" << std::endl;
+	}
+}
+
+QualityMeasurement App::MeasureQuality()
+{
+	int const  samples{ static_cast<int>(m_Options.BenchmarkSamples) };
+	auto const median = [this, samples](auto function)
+	{
+		return Summarize(ProfileSamples(m_Context
+										, m_Context.GraphicsQueue
+										, m_CommandPool->AllocateCommandBuffer(m_Context)
+										, *m_QueryPool
+										, samples
+										, m_Options.Profiling
+										, function)).Median;
+	};
+
+	QualityMeasurement measurement{};
+	measurement.Quality                   = m_Options.Quality;
+	measurement.TransmittanceMilliseconds = median([this](vkc::CommandBuffer& commandBuffer)
+	{
+		if (m_ComputeLUTs)
+			GenerateTransmittanceLUTCompute(commandBuffer);
+		else
+			GenerateTransmittanceLUT(commandBuffer);
+	});
+	measurement.MultScatteringMilliseconds = median([this](vkc::CommandBuffer& commandBuffer)
+	{
+		if (m_ComputeLUTs)
+			GenerateMultScatteringLUTCompute(commandBuffer);
+		else
+			GenerateMultScatteringLUT(commandBuffer);
+	});
+	measurement.OpticalDepthMilliseconds = median([this](vkc::CommandBuffer& commandBuffer)
+	{
+		GenerateOpticalDepthLUT(commandBuffer);
+	});
+
+	auto [pipeline, stagingImage, stagingImageView] = GenerateTempImageAndPipeline(true);
+
+	VmaAllocationInfo allocationInfo{};
+	vmaGetAllocationInfo(m_Context.Allocator, stagingImage.GetAllocation(), &allocationInfo);
+	vkc::BufferBuilder bufferBuilder{ m_Context };
+	vkc::Buffer        pixelBuffer = bufferBuilder
+							  .SetRequiredMemoryFlags(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+							  .MapMemory()
+							  .Build(VK_BUFFER_USAGE_2_TRANSFER_DST_BIT_KHR | VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT_KHR
+									 , allocationInfo.size
+									 , false);
+	BindPlanarReadback(0, stagingImageView, pixelBuffer);
+	measurement.PixelCount = size_t{ stagingImage.GetExtent().width } * stagingImage.GetExtent().height;
+
+	std::vector<BenchmarkScenario> const scenarios{ GetBenchmarkScenarios() };
+	auto const                           viewCount{ static_cast<double>(scenarios.size()) };
+	bool const                           useSkyview{ m_UseSkyview };
+	vkc::CommandBuffer&                  commandBuffer = m_CommandPool->AllocateCommandBuffer(m_Context);
+	for (BenchmarkScenario const& scenario: scenarios)
+	{
+		m_Camera->SetPosition(scenario.CameraPosition);
+		m_Camera->SetForward(scenario.CameraForward);
+		m_Options.Time = scenario.Time;
+
+		// leaves the LUT of this view in place for the sky-view renders below
+		measurement.SkyviewLUTMilliseconds += median([this](vkc::CommandBuffer& cmd)
+		{
+			RecordSkyviewLUT(cmd);
+		}) / viewCount;
+		for (bool const skyview: { true, false })
+		{
+			m_UseSkyview = skyview;
+			double const renderMilliseconds{
+				median([this, &pipeline, &stagingImage, &stagingImageView](vkc::CommandBuffer& cmd)
+				{
+					RenderSkyToImage(cmd, stagingImage, stagingImageView, pipeline);
+				}) / viewCount
+			};
+			(skyview ? measurement.SkyviewRenderMilliseconds : measurement.RaymarchRenderMilliseconds) += renderMilliseconds;
+
+			commandBuffer.Reset(m_Context);
+			m_Context.DispatchTable.resetFences(1, &commandBuffer.GetFence());
+			commandBuffer.Begin(m_Context);
+			RenderSkyToImage(commandBuffer, stagingImage, stagingImageView, pipeline);
+			RecordReadback(commandBuffer, stagingImage, pixelBuffer, 0);
+			commandBuffer.End(m_Context);
+			commandBuffer.Submit(m_Context, m_Context.GraphicsQueue, {}, {});
+			if (auto const result = m_Context.DispatchTable.waitForFences(1, &commandBuffer.GetFence(), VK_TRUE, UINT64_MAX);
+				result != VK_SUCCESS)
+				throw std::runtime_error("Failed to wait for a fence");
+
+			auto const* halves{ static_cast<uint16_t const*>(pixelBuffer.GetMappedData()) };
+			(skyview ? measurement.SkyviewImages : measurement.RaymarchImages).emplace_back(halves, halves + measurement.PixelCount * 4);
+		}
 	}
+	m_UseSkyview = useSkyview;
+
+	stagingImageView.Destroy(m_Context);
+	stagingImage.Destroy(m_Context);
+	pixelBuffer.Destroy(m_Context);
+	pipeline.Destroy(m_Context);
+
+	if (m_Context.DispatchTable.deviceWaitIdle() != VK_SUCCESS)
+		throw std::runtime_error("Failed to wait for the device");
+	End();
+	return measurement;
 }
 
 void App::RenderAllConfigsToFiles()
@@ -144,22 +606,231 @@ void App::RenderAllConfigsToFiles()
 	m_UseSkyview = !m_UseSkyview;
 }
 
-App::App(int width, int height)
+void App::RenderBatch()
+{
+	std::vector<RenderJob> const jobs{ LoadJobManifest(m_Options.JobManifest, m_Options) };
+
+	// one pipeline and render target per output format, shared by every job
+	std::array<std::optional<std::tuple<vkc::Pipeline, vkc::Image, vkc::ImageView>>, 2> targets{};
+	VkDeviceSize                                                                        readbackSize{};
+	for (RenderJob const& job: jobs)
+	{
+		if (targets[job.Hdr])
+			continue;
+		targets[job.Hdr].emplace(GenerateTempImageAndPipeline(job.Hdr));
+
+		VmaAllocationInfo allocationInfo{};
+		vmaGetAllocationInfo(m_Context.Allocator, std::get<vkc::Image>(*targets[job.Hdr]).GetAllocation(), &allocationInfo);
+		readbackSize = std::max(readbackSize, allocationInfo.size);
+	}
+
+	// the command pool hands out its m_FramesInFlight buffers round-robin, so a slot gets the same buffer and fence every time
+	std::vector<vkc::CommandBuffer*>   commandBuffers(m_FramesInFlight);
+	std::vector<std::optional<size_t>> pendingJobs(m_FramesInFlight);
+	// the writer encodes straight from the mapped readback, a buffer is lent to it until the file is written
+	// the extra buffers let the queued and encoding images overlap the renders in flight
+	// the flags are shared with the release callbacks, which may outlive this call when it throws
+	uint32_t const           readbackCount{ m_FramesInFlight + static_cast<uint32_t>(IMAGE_WRITER_QUEUE_DEPTH) };
+	std::vector<vkc::Buffer> readbackBuffers{};
+	auto const               lentReadbacks{ std::make_shared<std::vector<std::atomic<bool>>>(readbackCount) };
+	for (uint32_t index{}; index < readbackCount; ++index)
+	{
+		vkc::BufferBuilder bufferBuilder{ m_Context };
+		readbackBuffers.emplace_back(bufferBuilder
+									 .SetRequiredMemoryFlags(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+									 .MapMemory()
+									 .Build(VK_BUFFER_USAGE_2_TRANSFER_DST_BIT_KHR | VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT_KHR
+											, readbackSize
+											, false));
+	}
+
+	UpdateStaticLUTs();
+
+	double     handOffSeconds{};
+	double     lentSeconds{};
+	auto const start{ std::chrono::steady_clock::now() };
+	// waits for the job last recorded into the slot and hands it to the writer while the jobs queued behind it keep the GPU busy
+	auto const retire = [&](uint32_t slot)
+	{
+		if (!pendingJobs[slot])
+			return;
+
+		if (VkResult const result = m_Context.DispatchTable.waitForFences(1, &commandBuffers[slot]->GetFence(), VK_TRUE, UINT64_MAX);
+			result != VK_SUCCESS)
+			throw std::runtime_error("Failed to wait for a batch job");
+		ReportFirstPixel();
+
+		size_t const     index{ *pendingJobs[slot] };
+		RenderJob const& job{ jobs[index] };
+		uint32_t const   readback{ static_cast<uint32_t>(index % readbackCount) };
+		auto const       handOffStart{ std::chrono::steady_clock::now() };
+		(*lentReadbacks)[readback] = true;
+		SaveImage(readbackBuffers[readback].GetMappedData()
+				  , std::get<vkc::Image>(*targets[job.Hdr]).GetExtent()
+				  , job.Hdr
+				  , m_Options.OutputDirectory / job.Name
+				  , [lentReadbacks, readback]
+				  {
+					  (*lentReadbacks)[readback] = false;
+					  (*lentReadbacks)[readback].notify_one();
+				  });
+		handOffSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - handOffStart).count();
+		pendingJobs[slot].reset();
+	};
+
+	for (size_t index{}; index < jobs.size(); ++index)
+	{
+		RenderJob const&    job{ jobs[index] };
+		uint32_t const      slot{ static_cast<uint32_t>(index % m_FramesInFlight) };
+		uint32_t const      readback{ static_cast<uint32_t>(index % readbackCount) };
+		retire(slot);
+		// the job that last used the buffer was retired earlier, since there are more buffers than slots
+		auto const lentStart{ std::chrono::steady_clock::now() };
+		(*lentReadbacks)[readback].wait(true);
+		lentSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - lentStart).count();
+		// the slot's descriptor set is no longer in use, its job was retired
+		if (job.Hdr)
+			BindPlanarReadback(slot, std::get<vkc::ImageView>(*targets[true]), readbackBuffers[readback]);
+		vkc::CommandBuffer& commandBuffer = m_CommandPool->AllocateCommandBuffer(m_Context);
+		commandBuffers[slot]              = &commandBuffer;
+
+		m_Camera->SetPosition(job.CameraPosition);
+		m_Camera->SetForward(job.CameraForward);
+		m_Camera->SetFov(job.Fov);
+		m_Options.Time = job.Time;
+		m_UseSkyview   = job.UseSkyview;
+
+		auto& [pipeline, image, imageView] = *targets[job.Hdr];
+		m_Context.DispatchTable.resetFences(1, &commandBuffer.GetFence());
+		commandBuffer.Begin(m_Context);
+		if (m_UseSkyview)
+			RecordSkyviewLUT(commandBuffer);
+		RenderSkyToImage(commandBuffer, image, imageView, pipeline);
+		RecordReadback(commandBuffer, image, readbackBuffers[readback], slot);
+		commandBuffer.End(m_Context);
+		commandBuffer.Submit(m_Context, m_Context.GraphicsQueue, {}, {});
+		pendingJobs[slot] = index;
+	}
+	// drain the ring in submission order
+	for (size_t index{ jobs.size() }; index < jobs.size() + m_FramesInFlight; ++index)
+		retire(static_cast<uint32_t>(index % m_FramesInFlight));
+	m_ImageWriter->Flush();
+
+	double const seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+	std::cout << "batch of " << jobs.size() << " images in " << seconds << " s, "
+			<< static_cast<double>(jobs.size()) / seconds << " images/s, "
+			<< handOffSeconds << " s handing images to " << m_ImageWriter->GetWorkerCount() << " writer threads, "
+			<< m_ImageWriter->GetStatistics().BlockedSeconds << " s of it waiting on a full queue, "
+			<< lentSeconds << " s waiting for a writer to return a readback buffer" << std::endl;
+
+	for (vkc::Buffer& buffer: readbackBuffers)
+		buffer.Destroy(m_Context);
+	for (auto& target: targets)
+	{
+		if (!target)
+			continue;
+		auto& [pipeline, image, imageView] = *target;
+		imageView.Destroy(m_Context);
+		image.Destroy(m_Context);
+		pipeline.Destroy(m_Context);
+	}
+}
+
+void App::BenchmarkLUTBake()
+{
+	size_t const transmittanceSize{ GetLUTByteSize(*m_TransmittanceImage) };
+	size_t const multScatteringSize{ GetLUTByteSize(*m_MultScatteringImage) };
+
+	// the constructor already generated the GPU LUTs, or loaded the ones a GPU generated from the cache
+	vkc::BufferBuilder readbackBuilder{ m_Context };
+	vkc::Buffer        readbackBuffer = readbackBuilder
+								 .SetRequiredMemoryFlags(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+								 .MapMemory()
+								 .Build(VK_BUFFER_USAGE_TRANSFER_DST_BIT, transmittanceSize + multScatteringSize, false);
+
+	vkc::CommandBuffer& commandBuffer = m_CommandPool->AllocateCommandBuffer(m_Context);
+	m_Context.DispatchTable.resetFences(1, &commandBuffer.GetFence());
+	commandBuffer.Begin(m_Context);
+	CopyLUTToBuffer(commandBuffer, *m_TransmittanceImage, readbackBuffer, 0);
+	CopyLUTToBuffer(commandBuffer, *m_MultScatteringImage, readbackBuffer, transmittanceSize);
+	commandBuffer.End(m_Context);
+	commandBuffer.Submit(m_Context, m_Context.GraphicsQueue, {}, {});
+	if (auto const result = m_Context.DispatchTable.waitForFences(1, &commandBuffer.GetFence(), VK_TRUE, UINT64_MAX);
+		result != VK_SUCCESS)
+		throw std::runtime_error("Failed to wait for a fence");
+
+	std::vector<uint16_t> gpuTransmittance(transmittanceSize / sizeof(uint16_t));
+	std::vector<uint16_t> gpuMultScattering(multScatteringSize / sizeof(uint16_t));
+	auto const*           texels = static_cast<std::byte const*>(readbackBuffer.GetMappedData());
+	std::memcpy(gpuTransmittance.data(), texels, transmittanceSize);
+	std::memcpy(gpuMultScattering.data(), texels + transmittanceSize, multScatteringSize);
+	readbackBuffer.Destroy(m_Context);
+
+	uint32_t const hardwareThreads{ std::max(std::thread::hardware_concurrency(), 1u) };
+	std::vector<uint32_t> threadCounts{};
+	for (uint32_t threadCount{ 1 }; threadCount < hardwareThreads; threadCount *= 2)
+		threadCounts.emplace_back(threadCount);
+	threadCounts.emplace_back(hardwareThreads);
+
+	std::string filename{ "lut_bake" };
+	filename += m_Spectral ? "_spectral" : "_rgb";
+	std::filesystem::create_directories(m_Options.OutputDirectory);
+	std::ofstream bakeDump{ m_Options.OutputDirectory / (filename + ".csv"), std::ios::out };
+	bakeDump << "threads,transmittance ms,multiple scattering ms" << std::endl;
+
+	BakedLUTs luts{};
+	for (uint32_t const threadCount: threadCounts)
+	{
+		luts = BakeStaticLUTsOnCpu(threadCount);
+		std::cout << "static LUTs baked on " << threadCount << " CPU threads: transmittance " << luts.TransmittanceMilliseconds
+				<< " ms, multiple scattering " << luts.MultScatteringMilliseconds << " ms" << std::endl;
+		bakeDump << threadCount << "," << luts.TransmittanceMilliseconds << "," << luts.MultScatteringMilliseconds << std::endl;
+	}
+
+	// rgb multiple scattering divides by a zero w extinction, only the spectral LUT has a meaningful fourth channel
+	LUTDifference const transmittanceDifference{ CompareLUTs(gpuTransmittance, luts.Transmittance, false, 4) };
+	LUTDifference const multScatteringDifference{ CompareLUTs(gpuMultScattering, luts.MultScattering, true, m_Spectral ? 4 : 3) };
+	for (auto const& [label, difference]: { std::pair{ "transmittance LUT", transmittanceDifference }
+											, std::pair{ "multiple scattering LUT", multScatteringDifference } })
+		std::cout << label << " CPU against GPU: max " << difference.MaxAbsolute << ", rms " << difference.RootMeanSquare
+				<< " of values up to " << difference.MaxExpected << std::endl;
+}
+
+App::App(LaunchOptions options)
+	: m_StartTime{ std::chrono::steady_clock::now() }
+	, m_Options{ std::move(options) }
+	, m_Headless{ m_Options.IsHeadless() }
+	, m_UseSkyview{ m_Options.UseSkyview }
 {
-	m_Camera = std::make_unique<Camera>(glm::vec3(.0f, 1000.f, .0f)
-										, 45.f
-										, static_cast<float>(width) / height // NOLINT(*-narrowing-conversions)
+	m_Camera = std::make_unique<Camera>(m_Options.CameraPosition
+										, m_Options.Fov
+										, static_cast<float>(m_Options.Width) / m_Options.Height // NOLINT(*-narrowing-conversions)
 										, .0001f
 										, 100.f);
-	CreateWindow(width, height);
+	m_Camera->SetForward(m_Options.CameraForward);
+	if (!m_Headless)
+		CreateWindow(m_Options.Width, m_Options.Height);
 	CreateInstance();
-	CreateSurface();
+	if (!m_Headless)
+		CreateSurface();
 	CreateDevice();
-	CreateSwapchain();
+	if (!m_Headless)
+		CreateSwapchain();
+	else
+	{
+		m_RenderExtent   = VkExtent2D{ static_cast<uint32_t>(m_Options.Width), static_cast<uint32_t>(m_Options.Height) };
+		m_ColorFormat    = VK_FORMAT_R8G8B8A8_UNORM;
+		m_FramesInFlight = HEADLESS_FRAMES_IN_FLIGHT;
+		m_ImageWriter    = std::make_unique<ImageWriter>(0, IMAGE_WRITER_QUEUE_DEPTH);
+	}
 	m_Context.DeletionQueue.Push([this]
 	{
 		m_DepthImage->Destroy(m_Context);
 		m_DepthImageView->Destroy(m_Context);
+		DestroyLowResSky();
+
+		if (m_Headless)
+			return;
 
 		std::vector<VkImageView> views;
 		views.reserve(m_SwapchainImageViews.size());
@@ -173,32 +844,119 @@ App::App(int width, int height)
 	CreateResources();
 	CreateDescriptorSetLayouts();
 	CreateGraphicsPipeline();
+	CreateComputePipelines();
 	CreateSyncObjects();
+	CreateFrameTimers();
 	CreateDescriptorPool();
 	CreateDescriptorSets();
-
-	// ProfilePipelinesAndDump();
-
-	// RenderAllConfigsToFiles();
+	UpdateStaticLUTs();
+	UpdateSkyviewArray();
 }
 
 App::~App() = default;
 
 void App::Run()
 {
+	switch (m_Options.Mode)
+	{
+	case Command::Render:
+		RenderAtmosphereToAFile(m_Options.Hdr);
+		break;
+	case Command::Profile:
+		ProfilePipelinesAndDump();
+		break;
+	case Command::AllConfigs:
+		RenderAllConfigsToFiles();
+		break;
+	case Command::Batch:
+		RenderBatch();
+		break;
+	case Command::LUTBake:
+		BenchmarkLUTBake();
+		break;
+	case Command::Benchmark:
+		RunBenchmark();
+		break;
+	case Command::Sweep:
+		throw std::runtime_error("sweep configurations are measured through App::MeasureQuality");
+	case Command::Interactive:
+		RunWindowed();
+		break;
+	}
+
+	// every image is on disk once Run returns
+	if (m_ImageWriter)
+	{
+		m_ImageWriter->Flush();
+		if (ImageWriter::Statistics const statistics{ m_ImageWriter->GetStatistics() }; statistics.Images > 0)
+			std::cout << "image export: " << statistics.Images << " images, " << statistics.Failed << " failed, "
+					<< statistics.EncodeSeconds * 1000. / statistics.Images << " ms encoding per image, peak RSS "
+					<< static_cast<double>(GetPeakResidentBytes()) / (1024. * 1024.) << " MB" << std::endl;
+	}
+
+	if (m_Context.DispatchTable.deviceWaitIdle() != VK_SUCCESS)
+		throw std::runtime_error("Failed to wait for the device");
+
+	End();
+}
+
+void App::RunWindowed()
+{
+	// passes of both frame timers in column order, resolved once so the loop only copies floats
+	std::vector<std::string>                                     passNames{};
+	std::vector<std::pair<FrameTimer const*, FrameTimer::Scope>> passes{};
+	for (FrameTimer const* timer: { m_FrameTimer.get(), m_ComputeFrameTimer.get() })
+		for (FrameTimer::Scope scope{}; timer && scope < timer->GetStatistics().size(); ++scope)
+		{
+			passNames.emplace_back(timer->GetLabel(scope));
+			passes.emplace_back(timer, scope);
+		}
+	uptr<FrameLog> frameLog{};
+	if (!m_Options.FrameLogPath.empty())
+		frameLog = std::make_unique<FrameLog>(m_Options.FrameLogPath, passNames, FRAME_LOG_CAPACITY);
+
+	using Clock               = std::chrono::steady_clock;
+	auto const toMilliseconds = [](Clock::duration duration) { return std::chrono::duration<float, std::milli>(duration).count(); };
+
+	Tracer* const       tracer{ m_Tracer.get() };
+	Tracer::Calibration calibration{};
+	if (tracer)
+	{
+		calibration = CalibrateGpuClock();
+		tracer->SetCalibration(calibration);
+	}
+
 	// main loop
 	while (!glfwWindowShouldClose(m_Context.Window))
 	{
+		Tracer::CpuScope const frameScope{ tracer, "frame" };
 		glfwPollEvents();
+		auto const fenceWaitStart{ Clock::now() };
 		m_Context.DispatchTable.waitForFences(1, &m_InFlightFences[m_CurrentFrame], VK_TRUE, UINT64_MAX);
+		auto const fenceWaitEnd{ Clock::now() };
+		if (m_RequestedTier)
+		{
+			Tracer::CpuScope const scope{ tracer, "quality tier switch" };
+			SelectQualityTier(*m_RequestedTier);
+			m_RequestedTier.reset();
+		}
+		{
+			Tracer::CpuScope const scope{ tracer, "LUT update" };
+			UpdateStaticLUTs();
+			UpdateSkyviewArray();
+		}
 
 		world_time::Tick();
-		m_Camera->Update(m_Context.Window);
+		{
+			Tracer::CpuScope const scope{ tracer, "camera update" };
+			m_Camera->Update(m_Context.Window);
+		}
 
 		ModelViewProj const mvp{ glm::mat4{ 1 }, m_Camera->CalculateViewMatrix(), m_Camera->GetProjection() };
 
 		m_MVPUBOs[m_CurrentFrame].UpdateData(mvp);
-		uint32_t imageIndex{};
+		uint32_t   imageIndex{};
+		auto const acquireStart{ Clock::now() };
 		if (auto const result = m_Context.DispatchTable.acquireNextImageKHR(m_Context.Swapchain
 																			, UINT64_MAX
 																			, m_ImageAvailableSemaphores[m_CurrentFrame]
@@ -206,26 +964,93 @@ void App::Run()
 																			, &imageIndex);
 			result == VK_ERROR_OUT_OF_DATE_KHR)
 		{
+			// nothing was acquired, so the fence stays signaled and the frame is simply retried
+			Tracer::CpuScope const scope{ tracer, "swapchain recreation" };
 			RecreateSwapchain();
-			return;
+			continue;
 		}
+		auto const acquireEnd{ Clock::now() };
 
 		vkc::CommandBuffer& commandBuffer = m_CommandPool->AllocateCommandBuffer(m_Context);
 		m_Context.DispatchTable.resetFences(1, &m_InFlightFences[m_CurrentFrame]);
 
-		RecordCommandBuffer(commandBuffer, imageIndex);
-		Submit(commandBuffer);
+		std::vector<SkyviewRows> const skyviewRows{ m_SkyviewSchedule->Advance(GetSunAltitude(), m_Camera->GetPosition().y) };
+		if (m_SkyHistory)
+			m_SkyFrame = m_SkyHistory->Advance(GetSunAltitude(), m_Camera->GetPosition(), GetSkyRayBasis());
+
+		++m_FrameNumber;
+		if (m_ComputeQueue)
+		{
+			Tracer::CpuScope const scope{ tracer, "record and submit" };
+			RecordAndSubmitAsyncFrame(commandBuffer, imageIndex, skyviewRows);
+		}
+		else
+		{
+			{
+				Tracer::CpuScope const scope{ tracer, "record" };
+				RecordCommandBuffer(commandBuffer, imageIndex, skyviewRows);
+			}
+			Tracer::CpuScope const scope{ tracer, "submit" };
+			Submit(commandBuffer);
+		}
 
+		auto const presentStart{ Clock::now() };
 		Present(imageIndex);
+		auto const presentEnd{ Clock::now() };
+		ReportFirstPixel();
+
+		if (tracer)
+		{
+			tracer->AddCpu("wait for fence", fenceWaitStart, fenceWaitEnd);
+			tracer->AddCpu("acquire", acquireStart, acquireEnd);
+			tracer->AddCpu("present", presentStart, presentEnd);
+		}
+
+		if (frameLog)
+		{
+			FrameRecord record{
+				m_FrameNumber
+				, world_time::GetElapsedSec() * 1000.f
+				, toMilliseconds(fenceWaitEnd - fenceWaitStart)
+				, toMilliseconds(acquireEnd - acquireStart)
+				, toMilliseconds(presentEnd - presentStart)
+				, GetSkyShadedFraction()
+				, {}
+			};
+			record.GpuMilliseconds.fill(std::numeric_limits<float>::quiet_NaN());
+			for (size_t pass{}; pass < passes.size(); ++pass)
+				if (FrameTimer::Statistics const& statistics{ passes[pass].first->GetStatistics()[passes[pass].second] }; statistics.Updated)
+					record.GpuMilliseconds[pass] = static_cast<float>(statistics.LastMilliseconds);
+			frameLog->Push(record);
+		}
 
 		++m_CurrentFrame;
 		m_CurrentFrame %= m_FramesInFlight;
 	}
 
-	if (m_Context.DispatchTable.deviceWaitIdle() != VK_SUCCESS)
-		throw std::runtime_error("Failed to wait for the device");
+	ReportSkyviewStaleness();
+	ReportSkyHistory();
+	ReportFrameTimings();
+	if (frameLog)
+		std::cout << "frame log written to " << m_Options.FrameLogPath << ", " << frameLog->GetDropped() << " frames dropped on a full ring" << std::endl;
+	if (tracer)
+	{
+		tracer->Write(m_Options.TracePath, { "graphics", "async compute" });
+		std::cout << "trace written to " << m_Options.TracePath << ", " << tracer->GetDropped() << " events dropped, GPU clock aligned within "
+				<< calibration.UncertaintyNanoseconds / 1000. << " us" << std::endl;
+	}
+}
 
-	End();
+float App::GetSceneTime() const
+{
+	return m_Options.Time.value_or(world_time::GetRunTime());
+}
+
+float App::GetSunAltitude() const
+{
+	float constexpr halfPeriod{ 60.f };
+	float const     beginOffset{ glm::radians(-5.f) };
+	return glm::pi<float>() * GetSceneTime() / halfPeriod + beginOffset;
 }
 
 void App::RenderSkyToImage
@@ -238,7 +1063,7 @@ void App::RenderSkyToImage
 		{
 			transition.SrcAccessMask = VK_ACCESS_2_NONE;
 			transition.DstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_NONE;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_TRANSFER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT; // previous readback
 			transition.DstStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
 			transition.NewLayout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 		}
@@ -253,38 +1078,11 @@ void App::RenderSkyToImage
 			transition.DstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
 			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_NONE;
 			transition.DstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
-			transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			transition.NewLayout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
 		}
 		m_DepthImage->MakeTransition(m_Context, commandBuffer, transition);
 	}
 	//
-	{
-		vkc::Image::Transition transition{};
-		//
-		{
-			transition.SrcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			transition.DstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
-			transition.DstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
-			transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		}
-		m_TransmittanceImage->MakeTransition(m_Context, commandBuffer, transition);
-		m_MultScatteringImage->MakeTransition(m_Context, commandBuffer, transition);
-	}
-	//
-	{
-		vkc::Image::Transition transition{};
-		//
-		{
-			transition.SrcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			transition.DstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
-			transition.DstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
-			transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		}
-		m_SkyviewImage->MakeTransition(m_Context, commandBuffer, transition);
-	}
-	//
 	{
 		VkRenderingAttachmentInfo renderingAttachmentInfo{};
 		renderingAttachmentInfo.sType       = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
@@ -339,7 +1137,7 @@ void App::RenderSkyToImage
 			PushConstant pushConstant
 			{
 				m_Camera->GetPosition(), tan(glm::radians(m_Camera->GetFov() * .5f)), m_Camera->GetForward(), m_Camera->GetAspectRatio()
-				, world_time::GetRunTime(), m_UseSkyview
+				, GetSceneTime(), m_UseSkyview
 			};
 
 			m_Context.DispatchTable.cmdPushConstants(commandBuffer
@@ -355,47 +1153,113 @@ void App::RenderSkyToImage
 	}
 }
 
-std::tuple<vkc::Pipeline, vkc::Image, vkc::ImageView> App::GenerateTempImageAndPipeline(bool hdr)
+void App::RenderLowResSkyToImage
+(vkc::CommandBuffer& commandBuffer, vkc::Image& stagingImage, vkc::ImageView& stagingImageView, uint32_t skyScale)
 {
-	vkc::ImageBuilder builder{ m_Context };
-	vkc::Image        stagingImage = builder
-							  .SetExtent(m_Context.Swapchain.extent)
-							  .SetFormat(hdr ? VK_FORMAT_R16G16B16A16_SFLOAT : VK_FORMAT_R8G8B8A8_UNORM)
-							  .SetType(VK_IMAGE_TYPE_2D)
-							  .SetAspectFlags(VK_IMAGE_ASPECT_COLOR_BIT)
-							  .Build(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, false);
-
-	vkc::ImageView stagingImageView = stagingImage.CreateView(m_Context, VK_IMAGE_VIEW_TYPE_2D, 0, 1, 0, 1, false);
-
-	vkc::ShaderStage const vert{ m_Context, help::ReadFile("shaders/fsquad.spv"), VK_SHADER_STAGE_VERTEX_BIT };
-	vkc::ShaderStage       sky{
-		m_Context, help::ReadFile(hdr ? "shaders/sky_color_hdr.spv" : "shaders/sky_color_sdr.spv"), VK_SHADER_STAGE_FRAGMENT_BIT
-	};
-	sky.AddSpecializationConstant(static_cast<uint32_t>(m_Spectral));
-
-	VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-	colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT |
-										  VK_COLOR_COMPONENT_A_BIT;
-
-	VkFormat colorAttachmentFormats[]{ stagingImage.GetFormat() };
-
-	vkc::PipelineBuilder pipelineBuilder{ m_Context };
-	vkc::Pipeline        pipeline = pipelineBuilder
-							 .SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
-							 .AddViewport(stagingImage.GetExtent())
-							 .SetPolygonMode(VK_POLYGON_MODE_FILL)
-							 .SetCullMode(VK_CULL_MODE_NONE)
-							 .SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
-							 .AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
-							 .AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
-							 .AddColorBlendAttachment(colorBlendAttachment)
-							 .SetRenderingAttachments(colorAttachmentFormats, VK_FORMAT_UNDEFINED, VK_FORMAT_UNDEFINED)
-							 .AddShaderStage(vert)
-							 .AddShaderStage(sky)
-							 .Build(*m_PipelineLayout, false);
-	return std::tuple{ std::move(pipeline), std::move(stagingImage), std::move(stagingImageView) };
-}
-
+	// staging image to attachment optimal
+	{
+		vkc::Image::Transition transition{};
+		//
+		{
+			transition.SrcAccessMask = VK_ACCESS_2_NONE;
+			transition.DstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_TRANSFER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT; // previous readback
+			transition.DstStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+			transition.NewLayout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		}
+		stagingImage.MakeTransition(m_Context, commandBuffer, transition);
+	}
+	// there is no geometry offscreen, the depth buffer is cleared to the far plane so every pixel is sky
+	{
+		vkc::Image::Transition transition{};
+		//
+		{
+			transition.SrcAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+			transition.DstAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+			transition.DstStageMask  = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT;
+			transition.NewLayout     = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
+		}
+		m_DepthImage->MakeTransition(m_Context, commandBuffer, transition);
+
+		VkRenderingAttachmentInfo depthAttachmentInfo{};
+		depthAttachmentInfo.sType       = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+		depthAttachmentInfo.clearValue  = { .depthStencil = { 1.0f, 0 } };
+		depthAttachmentInfo.imageLayout = m_DepthImage->GetLayout();
+		depthAttachmentInfo.imageView   = *m_DepthImageView;
+		depthAttachmentInfo.loadOp      = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		depthAttachmentInfo.storeOp     = VK_ATTACHMENT_STORE_OP_STORE;
+
+		VkRenderingInfo renderingInfo{};
+		renderingInfo.sType            = VK_STRUCTURE_TYPE_RENDERING_INFO;
+		renderingInfo.pDepthAttachment = &depthAttachmentInfo;
+		renderingInfo.layerCount       = 1;
+		renderingInfo.renderArea       = VkRect2D{ {}, m_RenderExtent };
+
+		m_Context.DispatchTable.cmdBeginRendering(commandBuffer, &renderingInfo);
+		m_Context.DispatchTable.cmdEndRendering(commandBuffer);
+
+		// sampled by the low resolution march and depth tested by the upsample
+		transition.SrcAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+		transition.DstAccessMask = VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+		transition.SrcStageMask  = VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+		transition.DstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+		transition.NewLayout     = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL;
+		m_DepthImage->MakeTransition(m_Context, commandBuffer, transition);
+	}
+	RecordLowResSky(commandBuffer, stagingImageView, skyScale);
+}
+
+std::tuple<vkc::Pipeline, vkc::Image, vkc::ImageView> App::GenerateTempImageAndPipeline(bool hdr)
+{
+	vkc::ImageBuilder builder{ m_Context };
+	vkc::Image        stagingImage = builder
+							  .SetExtent(m_RenderExtent)
+							  .SetFormat(hdr ? VK_FORMAT_R16G16B16A16_SFLOAT : VK_FORMAT_R8G8B8A8_UNORM)
+							  .SetType(VK_IMAGE_TYPE_2D)
+							  .SetAspectFlags(VK_IMAGE_ASPECT_COLOR_BIT)
+							  .Build(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+									 (hdr ? VK_IMAGE_USAGE_SAMPLED_BIT : VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+									 , false);
+
+	vkc::ImageView stagingImageView = stagingImage.CreateView(m_Context, VK_IMAGE_VIEW_TYPE_2D, 0, 1, 0, 1, false);
+
+	// modules are created once and shared by every offline render
+	uptr<vkc::ShaderStage>& sky{ m_OfflineSkyStages[hdr] };
+	if (!sky)
+	{
+		sky = std::make_unique<vkc::ShaderStage>(m_Context
+												 , CopyEmbeddedShader(hdr ? "sky_color_hdr" : "sky_color_sdr")
+												 , VK_SHADER_STAGE_FRAGMENT_BIT);
+		AddSpecializationConstants(*sky);
+	}
+
+	VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+	colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT |
+										  VK_COLOR_COMPONENT_A_BIT;
+
+	VkFormat colorAttachmentFormats[]{ stagingImage.GetFormat() };
+
+	vkc::Pipeline pipeline = m_PipelineCache->Build(m_Context, [&]
+	{
+		vkc::PipelineBuilder pipelineBuilder{ m_Context };
+		return pipelineBuilder
+			.SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+			.AddViewport(stagingImage.GetExtent())
+			.SetPolygonMode(VK_POLYGON_MODE_FILL)
+			.SetCullMode(VK_CULL_MODE_NONE)
+			.SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
+			.AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
+			.AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
+			.AddColorBlendAttachment(colorBlendAttachment)
+			.SetRenderingAttachments(colorAttachmentFormats, VK_FORMAT_UNDEFINED, VK_FORMAT_UNDEFINED)
+			.AddShaderStage(*m_FullscreenStage)
+			.AddShaderStage(*sky)
+			.Build(*m_PipelineLayout, false);
+	});
+	return std::tuple{ std::move(pipeline), std::move(stagingImage), std::move(stagingImageView) };
+}
+
 void App::RenderAtmosphereToAFile(bool hdr)
 {
 	auto [pipeline, stagingImage, stagingImageView] = GenerateTempImageAndPipeline(hdr);
@@ -406,18 +1270,77 @@ void App::RenderAtmosphereToAFile(bool hdr)
 	vkc::Buffer        pixelBuffer = bufferBuilder
 							  .SetRequiredMemoryFlags(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
 							  .MapMemory()
-							  .Build(VK_BUFFER_USAGE_2_TRANSFER_DST_BIT_KHR, allocationInfo.size, false);
+							  .Build(VK_BUFFER_USAGE_2_TRANSFER_DST_BIT_KHR | VK_BUFFER_USAGE_2_STORAGE_BUFFER_BIT_KHR
+									 , allocationInfo.size
+									 , false);
+	if (hdr)
+		BindPlanarReadback(0, stagingImageView, pixelBuffer);
 	world_time::Tick();
-	m_Camera->Update(m_Context.Window);
+	if (!m_Headless)
+		m_Camera->Update(m_Context.Window);
+
+	UpdateStaticLUTs();
 
 	vkc::CommandBuffer& commandBuffer = m_CommandPool->AllocateCommandBuffer(m_Context);
 	m_Context.DispatchTable.resetFences(1, &commandBuffer.GetFence());
 	commandBuffer.Begin(m_Context);
 
-	GenerateTransmittanceLUT(commandBuffer);
-	GenerateMultScatteringLUT(commandBuffer);
-	GenerateSkyviewLUT(commandBuffer);
+	RecordSkyviewLUT(commandBuffer);
 	RenderSkyToImage(commandBuffer, stagingImage, stagingImageView, pipeline);
+	RecordReadback(commandBuffer, stagingImage, pixelBuffer, 0);
+
+	commandBuffer.End(m_Context);
+	commandBuffer.Submit(m_Context, m_Context.GraphicsQueue, {}, {});
+	if (VkResult result = m_Context.DispatchTable.waitForFences(1, &commandBuffer.GetFence(), VK_TRUE, UINT64_MAX);
+		result != VK_SUCCESS)
+	{
+		std::cerr << result << std::endl;
+		return;
+	}
+	ReportFirstPixel();
+
+	std::string filename{};
+	filename += m_Spectral ? "Spectral" : "RGB";
+	if (m_UseSkyview)
+		filename += "_" + std::to_string(m_SkyviewImage->GetExtent().width) + "x" + std::to_string(m_SkyviewImage->GetExtent().height) + "_Skyview";
+	else
+		filename += "_Raymarched";
+
+	SaveImage(pixelBuffer.GetMappedData(), stagingImage.GetExtent(), hdr, m_Options.OutputDirectory / filename, {});
+	// the writer reads the mapped buffer directly
+	m_ImageWriter->Flush();
+	stagingImageView.Destroy(m_Context);
+	stagingImage.Destroy(m_Context);
+	pixelBuffer.Destroy(m_Context);
+	pipeline.Destroy(m_Context);
+}
+
+void App::BindPlanarReadback(uint32_t slot, vkc::ImageView& imageView, vkc::Buffer& buffer)
+{
+	VkDescriptorBufferInfo bufferInfo{};
+	bufferInfo.buffer = buffer;
+	bufferInfo.range  = VK_WHOLE_SIZE;
+	bufferInfo.offset = 0;
+
+	VkDescriptorImageInfo imageInfo{};
+	imageInfo.imageView   = imageView;
+	imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	imageInfo.sampler     = m_Sampler;
+
+	m_ReadbackDescriptorSets[slot]
+		.AddWriteDescriptor({ &bufferInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 0, 0)
+		.AddWriteDescriptor({ &imageInfo, 1 }, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, 0)
+		.Update(m_Context);
+}
+
+void App::RecordReadback(vkc::CommandBuffer& commandBuffer, vkc::Image& image, vkc::Buffer& buffer, uint32_t slot)
+{
+	if (image.GetFormat() == VK_FORMAT_R16G16B16A16_SFLOAT)
+	{
+		RecordPlanarReadback(commandBuffer, image, slot);
+		return;
+	}
+
 	//
 	{
 		vkc::Image::Transition transition{};
@@ -429,13 +1352,13 @@ void App::RenderAtmosphereToAFile(bool hdr)
 			transition.DstStageMask  = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
 			transition.NewLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
 		}
-		stagingImage.MakeTransition(m_Context, commandBuffer, transition);
+		image.MakeTransition(m_Context, commandBuffer, transition);
 	}
 	//
 	{
 		VkBufferMemoryBarrier bufferBarrier{};
 		bufferBarrier.sType         = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-		bufferBarrier.buffer        = pixelBuffer;
+		bufferBarrier.buffer        = buffer;
 		bufferBarrier.size          = VK_WHOLE_SIZE;
 		bufferBarrier.srcAccessMask = VK_ACCESS_NONE;
 		bufferBarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
@@ -452,12 +1375,12 @@ void App::RenderAtmosphereToAFile(bool hdr)
 	}
 
 	VkBufferImageCopy bufferCopy{};
-	bufferCopy.bufferRowLength             = stagingImage.GetExtent().width;
-	bufferCopy.bufferImageHeight           = stagingImage.GetExtent().height;
+	bufferCopy.bufferRowLength             = image.GetExtent().width;
+	bufferCopy.bufferImageHeight           = image.GetExtent().height;
 	bufferCopy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 	bufferCopy.imageSubresource.layerCount = 1;
-	bufferCopy.imageExtent                 = VkExtent3D{ stagingImage.GetExtent().width, stagingImage.GetExtent().height, 1 };
-	m_Context.DispatchTable.cmdCopyImageToBuffer(commandBuffer, stagingImage, stagingImage.GetLayout(), pixelBuffer, 1, &bufferCopy);
+	bufferCopy.imageExtent                 = VkExtent3D{ image.GetExtent().width, image.GetExtent().height, 1 };
+	m_Context.DispatchTable.cmdCopyImageToBuffer(commandBuffer, image, image.GetLayout(), buffer, 1, &bufferCopy);
 
 	//
 	{
@@ -467,7 +1390,7 @@ void App::RenderAtmosphereToAFile(bool hdr)
 		barrier.dstAccessMask       = VK_ACCESS_HOST_READ_BIT;
 		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
 		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-		barrier.buffer              = pixelBuffer;
+		barrier.buffer              = buffer;
 		barrier.offset              = 0;
 		barrier.size                = VK_WHOLE_SIZE;
 
@@ -484,34 +1407,77 @@ void App::RenderAtmosphereToAFile(bool hdr)
 							 , nullptr
 							);
 	}
+}
 
-	commandBuffer.End(m_Context);
-	commandBuffer.Submit(m_Context, m_Context.GraphicsQueue, {}, {});
-	if (VkResult result = m_Context.DispatchTable.waitForFences(1, &commandBuffer.GetFence(), VK_TRUE, UINT64_MAX);
-		result != VK_SUCCESS)
+void App::RecordPlanarReadback(vkc::CommandBuffer& commandBuffer, vkc::Image& image, uint32_t slot)
+{
+	//
 	{
-		std::cerr << result << std::endl;
-		return;
+		vkc::Image::Transition transition{};
+		//
+		{
+			transition.SrcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+			transition.DstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+			transition.DstStageMask  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+			transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		}
+		image.MakeTransition(m_Context, commandBuffer, transition);
 	}
+	// the host read the previous contents before this command buffer was submitted, so the writes need no barrier
+
+	VkExtent2D const extent{ image.GetExtent() };
+	m_Context.DispatchTable.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_PlanarReadbackPipeline);
+	m_Context.DispatchTable.cmdBindDescriptorSets(commandBuffer
+												  , VK_PIPELINE_BIND_POINT_COMPUTE
+												  , *m_ReadbackPipelineLayout
+												  , 0
+												  , 1
+												  , m_ReadbackDescriptorSets[slot]
+												  , 0
+												  , nullptr);
+	m_Context.DispatchTable.cmdPushConstants(commandBuffer
+											 , *m_ReadbackPipelineLayout
+											 , VK_SHADER_STAGE_COMPUTE_BIT
+											 , 0
+											 , sizeof(extent)
+											 , &extent);
+
+	// matches local_size of planar_readback.comp, one invocation writes two halves
+	uint32_t constexpr groupSize{ 64 };
+	uint32_t constexpr maxGroupsX{ 65535 }; // minimum maxComputeWorkGroupCount guaranteed by the spec
+	uint64_t const     wordCount{ uint64_t{ extent.width } * extent.height * 2 };
+	uint32_t const     groupCount{ static_cast<uint32_t>((wordCount + groupSize - 1) / groupSize) };
+	uint32_t const     groupsX{ std::min(groupCount, maxGroupsX) };
+	m_Context.DispatchTable.cmdDispatch(commandBuffer, groupsX, (groupCount + groupsX - 1) / groupsX, 1);
 
-	std::string filename{};
-	filename += m_Spectral ? "Spectral" : "RGB";
-	filename += m_UseSkyview ? "_200x100_Skyview" : "_Raymarched";
+	//
+	{
+		VkMemoryBarrier2 barrier{};
+		barrier.sType         = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2;
+		barrier.srcStageMask  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+		barrier.srcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+		barrier.dstStageMask  = VK_PIPELINE_STAGE_2_HOST_BIT;
+		barrier.dstAccessMask = VK_ACCESS_2_HOST_READ_BIT;
+
+		VkDependencyInfo dependencyInfo{};
+		dependencyInfo.sType              = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+		dependencyInfo.memoryBarrierCount = 1;
+		dependencyInfo.pMemoryBarriers    = &barrier;
+		m_Context.DispatchTable.cmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+	}
+}
 
-	if (hdr)
-		SaveEXRFile(pixelBuffer.GetMappedData()
-					, static_cast<int>(stagingImage.GetExtent().width)
-					, static_cast<int>(stagingImage.GetExtent().height)
-					, filename + ".exr");
-	else
-		SavePNGFile(pixelBuffer.GetMappedData()
-					, static_cast<int>(stagingImage.GetExtent().width)
-					, static_cast<int>(stagingImage.GetExtent().height)
-					, filename + ".png");
-	stagingImageView.Destroy(m_Context);
-	stagingImage.Destroy(m_Context);
-	pixelBuffer.Destroy(m_Context);
-	pipeline.Destroy(m_Context);
+void App::SaveImage(void const* pixels, VkExtent2D extent, bool hdr, std::filesystem::path path, std::function<void()> release) const
+{
+	// RGBA16F planes or RGBA8
+	size_t const size{ size_t{ extent.width } * extent.height * (hdr ? 8 : 4) };
+	m_ImageWriter->Submit({ static_cast<std::byte const*>(pixels), size }
+						  , static_cast<int>(extent.width)
+						  , static_cast<int>(extent.height)
+						  , hdr
+						  , std::move(path)
+						  , std::move(release));
 }
 
 void App::CreateWindow(int width, int height)
@@ -536,6 +1502,7 @@ void App::CreateInstance()
 								.use_default_debug_messenger()
 								.require_api_version(1, 3)
 								.request_validation_layers()
+								.set_headless(m_Headless)
 								.build();
 	if (!instanceResult)
 		throw std::runtime_error("failed to create instance");
@@ -570,7 +1537,8 @@ void App::CreateDevice()
 	VkPhysicalDeviceVulkan11Features features11{};
 	features11.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_FEATURES;
 	VkPhysicalDeviceVulkan12Features features12{};
-	features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	features12.sType             = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	features12.timelineSemaphore = VK_TRUE;
 	VkPhysicalDeviceVulkan13Features features13{};
 	features13.sType            = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES;
 	features13.dynamicRendering = VK_TRUE;
@@ -597,7 +1565,26 @@ void App::CreateDevice()
 											  , VK_IMAGE_TILING_OPTIMAL
 											  , VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
 
-	auto const deviceResult = vkb::DeviceBuilder{ physicalDeviceResult.value() }.build();
+	// the trace samples the GPU and steady_clock together when the device can, see CalibrateGpuClock
+	vkb::PhysicalDevice physicalDevice{ physicalDeviceResult.value() };
+	if (!m_Options.TracePath.empty() && !m_Headless &&
+		physicalDevice.enable_extension_if_present(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME))
+	{
+		auto const getTimeDomains{
+			reinterpret_cast<PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT>(vkGetInstanceProcAddr(m_Context.Instance
+																									  , "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT"))
+		};
+		uint32_t domainCount{};
+		if (getTimeDomains && getTimeDomains(physicalDevice, &domainCount, nullptr) == VK_SUCCESS)
+		{
+			std::vector<VkTimeDomainEXT> domains(domainCount);
+			getTimeDomains(physicalDevice, &domainCount, domains.data());
+			auto const supports = [&domains](VkTimeDomainEXT domain) { return std::ranges::find(domains, domain) != domains.end(); };
+			m_CalibratedTimestamps = supports(HOST_TIME_DOMAIN) && supports(VK_TIME_DOMAIN_DEVICE_EXT);
+		}
+	}
+
+	auto const deviceResult = vkb::DeviceBuilder{ physicalDevice }.build();
 	if (!deviceResult)
 		throw std::runtime_error("failed to create device");
 
@@ -609,8 +1596,27 @@ void App::CreateDevice()
 		if (!result)
 			throw std::runtime_error("Failed to get a graphics queue");
 		m_Context.GraphicsQueue = result.value();
+		m_GraphicsQueueFamily   = m_Context.Device.get_queue_index(vkb::QueueType::graphics).value();
 	}
-	//
+	// compute LUTs write the 16 bit LUT formats as storage images
+	{
+		m_ComputeLUTs = m_Options.LUTs == LUTPath::Compute;
+		for (VkFormat const format: { VK_FORMAT_R16G16B16A16_UNORM, VK_FORMAT_R16G16B16A16_SFLOAT })
+			m_ComputeLUTs = m_ComputeLUTs &&
+							help::SupportsOptimalTilingFeatures(physicalDeviceResult.value()
+																, format
+																, VK_FORMAT_FEATURE_STORAGE_IMAGE_BIT);
+		if (m_Options.LUTs == LUTPath::Compute && !m_ComputeLUTs)
+			std::cout << "LUT formats do not support storage, falling back to fragment LUTs" << std::endl;
+	}
+	// only the windowed loop overlaps sky-view generation with the geometry pass, offline paths submit a single command buffer
+	if (auto const result = m_Context.Device.get_dedicated_queue(vkb::QueueType::compute);
+		result && m_ComputeLUTs && !m_Headless)
+	{
+		m_ComputeQueue       = result.value();
+		m_ComputeQueueFamily = m_Context.Device.get_dedicated_queue_index(vkb::QueueType::compute).value();
+	}
+	if (!m_Headless)
 	{
 		auto const result = m_Context.Device.get_queue(vkb::QueueType::present);
 		if (!result)
@@ -622,6 +1628,18 @@ void App::CreateDevice()
 		vkb::destroy_device(m_Context.Device);
 	});
 
+	// created before any pipeline, every graphics and compute pipeline is built through it
+	m_DeviceProperties = physicalDeviceResult.value().properties;
+	m_PipelineCache    = std::make_unique<PipelineCache>(m_Context, m_DeviceProperties, m_Options.PipelineCachePath);
+	m_Context.DeletionQueue.Push([this]
+	{
+		PipelineCache::Statistics const& statistics{ m_PipelineCache->GetStatistics() };
+		std::cout << "pipeline cache " << (m_PipelineCache->WasLoaded() ? "loaded" : "cold") << ": " << statistics.Hits << "/"
+				<< statistics.Pipelines << " pipelines hit, " << statistics.Milliseconds << " ms creating pipelines" << std::endl;
+		m_PipelineCache->Save(m_Context);
+		m_PipelineCache->Destroy(m_Context);
+	});
+
 	VmaAllocatorCreateInfo allocatorInfo{};
 	allocatorInfo.device           = m_Context.Device;
 	allocatorInfo.instance         = m_Context.Instance;
@@ -653,6 +1671,8 @@ void App::CreateSwapchain()
 	vkc::ImageView::ConvertFromSwapchainVkImageViews(m_Context, m_SwapchainImageViews);
 
 	m_FramesInFlight = m_Context.Swapchain.image_count;
+	m_RenderExtent   = m_Context.Swapchain.extent;
+	m_ColorFormat    = m_Context.Swapchain.image_format;
 }
 
 void App::CreateSyncObjects()
@@ -682,16 +1702,167 @@ void App::CreateSyncObjects()
 			m_Context.DispatchTable.destroyFence(m_InFlightFences[index], nullptr);
 		});
 	}
+
+	if (!m_ComputeQueue)
+		return;
+
+	VkSemaphoreTypeCreateInfo timelineCreateInfo{};
+	timelineCreateInfo.sType         = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	timelineCreateInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	timelineCreateInfo.initialValue  = 0;
+	semaphoreCreateInfo.pNext        = &timelineCreateInfo;
+
+	if (m_Context.DispatchTable.createSemaphore(&semaphoreCreateInfo, nullptr, &m_LUTTimeline) != VK_SUCCESS
+		||
+		m_Context.DispatchTable.createSemaphore(&semaphoreCreateInfo, nullptr, &m_FrameTimeline) != VK_SUCCESS)
+		throw std::runtime_error("Failed to create timeline semaphores");
+	m_Context.DeletionQueue.Push([this]
+	{
+		m_Context.DispatchTable.destroySemaphore(m_LUTTimeline, nullptr);
+		m_Context.DispatchTable.destroySemaphore(m_FrameTimeline, nullptr);
+	});
+}
+
+void App::CreateFrameTimers()
+{
+	if (m_Headless)
+		return;
+
+	auto const supportsTimestamps = [this](uint32_t family, std::string_view queue)
+	{
+		if (m_Context.Device.queue_families[family].timestampValidBits > 0)
+			return true;
+		std::cout << queue << " queue does not support timestamps, its passes are not timed" << std::endl;
+		return false;
+	};
+	float const timestampPeriod{ m_DeviceProperties.limits.timestampPeriod };
+
+	if (supportsTimestamps(m_GraphicsQueueFamily, "graphics"))
+	{
+		m_FrameTimer                    = std::make_unique<FrameTimer>(m_Context, timestampPeriod, m_FramesInFlight);
+		m_FrameScopes.AerialPerspective = m_FrameTimer->Intern("aerial perspective LUT");
+		m_FrameScopes.Geometry          = m_FrameTimer->Intern("geometry");
+		m_FrameScopes.Sky               = m_FrameTimer->Intern("sky");
+		if (!m_ComputeQueue)
+			m_FrameScopes.SkyviewLUT = m_FrameTimer->Intern("sky-view LUT");
+		m_Context.DeletionQueue.Push([this]
+		{
+			m_FrameTimer->Destroy(m_Context);
+		});
+	}
+
+	if (m_ComputeQueue && supportsTimestamps(m_ComputeQueueFamily, "compute"))
+	{
+		m_ComputeFrameTimer      = std::make_unique<FrameTimer>(m_Context, timestampPeriod, m_FramesInFlight);
+		m_FrameScopes.SkyviewLUT = m_ComputeFrameTimer->Intern("sky-view LUT (async compute)");
+		m_Context.DeletionQueue.Push([this]
+		{
+			m_ComputeFrameTimer->Destroy(m_Context);
+		});
+	}
+
+	if (m_Options.TracePath.empty())
+		return;
+	m_Tracer = std::make_unique<Tracer>(TRACE_CAPACITY);
+	if (m_FrameTimer)
+		m_FrameTimer->SetTracer(m_Tracer.get(), 0);
+	if (m_ComputeFrameTimer)
+		m_ComputeFrameTimer->SetTracer(m_Tracer.get(), 1);
+}
+
+Tracer::Calibration App::CalibrateGpuClock()
+{
+	Tracer::Calibration calibration{};
+	calibration.NanosecondsPerTick = m_DeviceProperties.limits.timestampPeriod;
+
+	if (m_CalibratedTimestamps)
+	{
+		VkCalibratedTimestampInfoEXT infos[2]{};
+		infos[0].sType      = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+		infos[0].timeDomain = VK_TIME_DOMAIN_DEVICE_EXT;
+		infos[1].sType      = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT;
+		infos[1].timeDomain = HOST_TIME_DOMAIN;
+
+		uint64_t timestamps[2]{};
+		uint64_t maxDeviation{};
+		if (m_Context.DispatchTable.getCalibratedTimestampsEXT(2, infos, timestamps, &maxDeviation) == VK_SUCCESS)
+		{
+			calibration.GpuTicks               = timestamps[0];
+			calibration.CpuTime                = Tracer::FromHostTimeDomain(timestamps[1]);
+			calibration.UncertaintyNanoseconds = static_cast<double>(maxDeviation);
+			return calibration;
+		}
+	}
+
+	// the timestamp of an otherwise empty submission is placed halfway between submit and the fence wait returning
+	VkQueryPoolCreateInfo queryPoolInfo{};
+	queryPoolInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	queryPoolInfo.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+	queryPoolInfo.queryCount = 1;
+	VkQueryPool queryPool{};
+	if (m_Context.DispatchTable.createQueryPool(&queryPoolInfo, nullptr, &queryPool) != VK_SUCCESS)
+		throw std::runtime_error("Failed to create a calibration query pool");
+
+	vkc::CommandBuffer& commandBuffer = m_CommandPool->AllocateCommandBuffer(m_Context);
+	m_Context.DispatchTable.resetFences(1, &commandBuffer.GetFence());
+	commandBuffer.Begin(m_Context);
+	vkCmdResetQueryPool(commandBuffer, queryPool, 0, 1);
+	vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, queryPool, 0);
+	commandBuffer.End(m_Context);
+
+	auto const submitted{ Tracer::Clock::now() };
+	commandBuffer.Submit(m_Context, m_Context.GraphicsQueue, {}, {});
+	if (auto const result = m_Context.DispatchTable.waitForFences(1, &commandBuffer.GetFence(), VK_TRUE, UINT64_MAX);
+		result != VK_SUCCESS)
+		throw std::runtime_error("Failed to wait for a fence");
+	auto const finished{ Tracer::Clock::now() };
+
+	m_Context.DispatchTable.getQueryPoolResults(queryPool
+												, 0
+												, 1
+												, sizeof(calibration.GpuTicks)
+												, &calibration.GpuTicks
+												, sizeof(calibration.GpuTicks)
+												, VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+	m_Context.DispatchTable.destroyQueryPool(queryPool, nullptr);
+
+	calibration.CpuTime                = submitted + (finished - submitted) / 2;
+	calibration.UncertaintyNanoseconds = std::chrono::duration<double, std::nano>(finished - submitted).count() / 2.;
+	return calibration;
 }
 
 void App::CreateDescriptorPool()
 {
+	// every quality tier writes its own sets, see SelectQualityTier
+	uint32_t const tierCount{ m_Headless ? 1 : QUALITY_TIER_COUNT };
+
 	vkc::DescriptorPoolBuilder builder{ m_Context };
 	vkc::DescriptorPool        pool = builder
-							   .AddPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, m_FramesInFlight)
-							   .Build(m_FramesInFlight);
+							   .AddPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, m_FramesInFlight * tierCount)
+							   .AddPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 9 * m_FramesInFlight * tierCount)
+							   .Build(m_FramesInFlight * tierCount);
 
 	m_DescPool = std::make_unique<vkc::DescriptorPool>(std::move(pool));
+
+	// seven sets per tier, each with the storage image and the four samplers of the compute layout
+	vkc::DescriptorPoolBuilder computeBuilder{ m_Context };
+	vkc::DescriptorPool        computePool = computeBuilder
+									  .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 7 * tierCount)
+									  .AddPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4 * 7 * tierCount)
+									  .Build(7 * tierCount);
+
+	m_ComputeDescPool = std::make_unique<vkc::DescriptorPool>(std::move(computePool));
+
+	if (!m_Headless)
+		return;
+
+	vkc::DescriptorPoolBuilder readbackBuilder{ m_Context };
+	vkc::DescriptorPool        readbackPool = readbackBuilder
+									   .AddPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_FramesInFlight)
+									   .AddPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_FramesInFlight)
+									   .Build(m_FramesInFlight);
+
+	m_ReadbackDescPool = std::make_unique<vkc::DescriptorPool>(std::move(readbackPool));
 }
 
 void App::CreateDescriptorSets()
@@ -708,11 +1879,6 @@ void App::CreateDescriptorSets()
 		bufferInfo.range  = VK_WHOLE_SIZE;
 		bufferInfo.offset = 0;
 
-		VkDescriptorImageInfo imageInfo{};
-		imageInfo.imageView   = *m_DepthImageView;
-		imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		imageInfo.sampler     = m_Sampler;
-
 		VkDescriptorImageInfo transmittanceInfo{};
 		transmittanceInfo.imageView   = *m_TransmittanceImageView;
 		transmittanceInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
@@ -728,14 +1894,106 @@ void App::CreateDescriptorSets()
 		skyviewInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 		skyviewInfo.sampler     = m_Sampler;
 
+		VkDescriptorImageInfo aerialPerspectiveInfo{};
+		aerialPerspectiveInfo.imageView   = m_AerialPerspectiveImage->GetView();
+		aerialPerspectiveInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		aerialPerspectiveInfo.sampler     = m_Sampler;
+
+		VkDescriptorImageInfo opticalDepthInfo{};
+		opticalDepthInfo.imageView   = *m_OpticalDepthImageView;
+		opticalDepthInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		opticalDepthInfo.sampler     = m_Sampler;
+
 		m_FrameDescriptorSets[index]
 			.AddWriteDescriptor({ &bufferInfo, 1 }, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 0, 0)
-			.AddWriteDescriptor({ &imageInfo, 1 }, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, 0)
 			.AddWriteDescriptor({ &transmittanceInfo, 1 }, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2, 0)
 			.AddWriteDescriptor({ &multScatteringInfo, 1 }, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 3, 0)
 			.AddWriteDescriptor({ &skyviewInfo, 1 }, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4, 0)
+			.AddWriteDescriptor({ &aerialPerspectiveInfo, 1 }, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 5, 0)
+			.AddWriteDescriptor({ &opticalDepthInfo, 1 }, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 6, 0)
+			.Update(m_Context);
+	}
+	WriteRenderTargetDescriptors(m_FrameDescriptorSets);
+
+	std::vector<VkDescriptorSetLayout> computeLayouts(7, *m_ComputeDescSetLayout);
+	m_ComputeDescriptorSets = builder.Build(*m_ComputeDescPool, computeLayouts);
+
+	// written by BindPlanarReadback once the render target and readback buffer of a slot are known
+	if (m_Headless)
+	{
+		std::vector<VkDescriptorSetLayout> readbackLayouts(m_FramesInFlight, *m_ReadbackDescSetLayout);
+		m_ReadbackDescriptorSets = builder.Build(*m_ReadbackDescPool, readbackLayouts);
+	}
+
+	VkDescriptorImageInfo transmittanceInfo{};
+	transmittanceInfo.imageView   = *m_TransmittanceImageView;
+	transmittanceInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	transmittanceInfo.sampler     = m_Sampler;
+
+	VkDescriptorImageInfo multScatteringInfo{};
+	multScatteringInfo.imageView   = *m_MultScatteringImageView;
+	multScatteringInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	multScatteringInfo.sampler     = m_Sampler;
+
+	VkDescriptorImageInfo opticalDepthInfo{};
+	opticalDepthInfo.imageView   = *m_OpticalDepthImageView;
+	opticalDepthInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	opticalDepthInfo.sampler     = m_Sampler;
+
+	VkDescriptorImageInfo opticalDepthOutputInfo{};
+	opticalDepthOutputInfo.imageView   = *m_OpticalDepthImageView;
+	opticalDepthOutputInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+	m_ComputeDescriptorSets[6]
+		.AddWriteDescriptor({ &opticalDepthOutputInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 0, 0)
+		.Update(m_Context);
+
+	// the LUT images only have storage usage when the compute LUT path is active
+	std::vector<VkImageView> outputViews{ m_AerialPerspectiveImage->GetView() };
+	if (m_ComputeLUTs)
+		outputViews.insert(outputViews.begin(), { *m_TransmittanceImageView, *m_MultScatteringImageView, *m_SkyviewImageView });
+	for (uint32_t index{}; index < outputViews.size(); ++index)
+	{
+		// storage writes happen in general layout, see DispatchLUT
+		VkDescriptorImageInfo outputInfo{};
+		outputInfo.imageView   = outputViews[index];
+		outputInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+		m_ComputeDescriptorSets[index + (m_ComputeLUTs ? 0 : 3)]
+			.AddWriteDescriptor({ &outputInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 0, 0)
+			.AddWriteDescriptor({ &transmittanceInfo, 1 }, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2, 0)
+			.AddWriteDescriptor({ &multScatteringInfo, 1 }, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 3, 0)
+			.AddWriteDescriptor({ &opticalDepthInfo, 1 }, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 6, 0)
 			.Update(m_Context);
 	}
+
+	if (!m_SkyviewArrayImage)
+		return;
+
+	VkDescriptorImageInfo arrayOutputInfo{};
+	arrayOutputInfo.imageView   = m_SkyviewArrayImage->GetView();
+	arrayOutputInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+	m_ComputeDescriptorSets[4]
+		.AddWriteDescriptor({ &arrayOutputInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 0, 0)
+		.AddWriteDescriptor({ &transmittanceInfo, 1 }, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2, 0)
+		.AddWriteDescriptor({ &multScatteringInfo, 1 }, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 3, 0)
+		.AddWriteDescriptor({ &opticalDepthInfo, 1 }, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 6, 0)
+		.Update(m_Context);
+
+	VkDescriptorImageInfo skyviewOutputInfo{};
+	skyviewOutputInfo.imageView   = *m_SkyviewImageView;
+	skyviewOutputInfo.imageLayout = VK_IMAGE_LAYOUT_GENERAL;
+
+	VkDescriptorImageInfo arrayInfo{};
+	arrayInfo.imageView   = m_SkyviewArrayImage->GetView();
+	arrayInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	arrayInfo.sampler     = m_Sampler;
+
+	m_ComputeDescriptorSets[5]
+		.AddWriteDescriptor({ &skyviewOutputInfo, 1 }, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 0, 0)
+		.AddWriteDescriptor({ &arrayInfo, 1 }, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, 0)
+		.Update(m_Context);
 }
 
 void App::CreateVertexBuffer()
@@ -777,9 +2035,7 @@ void App::CreateGraphicsPipeline()
 		vkc::PipelineLayoutBuilder builder{ m_Context };
 		vkc::PipelineLayout        layout = builder
 									 .AddDescriptorSetLayout(*m_FrameDescSetLayout)
-									 .AddPushConstant(VK_SHADER_STAGE_FRAGMENT_BIT
-													  , 0
-													  , sizeof(glm::vec3) * 2 + sizeof(float) * 3 + sizeof(uint32_t))
+									 .AddPushConstant(VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(SkyPushConstants))
 									 .Build();
 		m_PipelineLayout = std::make_unique<vkc::PipelineLayout>(std::move(layout));
 	}
@@ -791,21 +2047,18 @@ void App::CreateGraphicsPipeline()
 		m_EmptyPipelineLayout = std::make_unique<vkc::PipelineLayout>(std::move(layout));
 	}
 
-	bool const useSpectral{ m_Spectral };
+	// the fullscreen vertex stage is kept for the offline pipelines, see GenerateTempImageAndPipeline
+	m_FullscreenStage = std::make_unique<vkc::ShaderStage>(m_Context, CopyEmbeddedShader("fsquad"), VK_SHADER_STAGE_VERTEX_BIT);
+	m_Context.DeletionQueue.Push([this]
+	{
+		m_FullscreenStage.reset();
+		m_OfflineSkyStages = {};
+	});
 
-	vkc::ShaderStage const vert{ m_Context, help::ReadFile("shaders/basic_transform.spv"), VK_SHADER_STAGE_VERTEX_BIT };
-	vkc::ShaderStage const frag{ m_Context, help::ReadFile("shaders/basic_color.spv"), VK_SHADER_STAGE_FRAGMENT_BIT };
-	vkc::ShaderStage const fsQuad{ m_Context, help::ReadFile("shaders/fsquad.spv"), VK_SHADER_STAGE_VERTEX_BIT };
-	vkc::ShaderStage       transmittanceLUT{ m_Context, help::ReadFile("shaders/transmittanceLUT.spv"), VK_SHADER_STAGE_FRAGMENT_BIT };
-	transmittanceLUT.AddSpecializationConstant(static_cast<uint32_t>(useSpectral));
-	vkc::ShaderStage multScatteringLUT{ m_Context, help::ReadFile("shaders/multiple_scattering.spv"), VK_SHADER_STAGE_FRAGMENT_BIT };
-	multScatteringLUT.AddSpecializationConstant(static_cast<uint32_t>(useSpectral));
-	vkc::ShaderStage skyviewLUT{ m_Context, help::ReadFile("shaders/skyview.spv"), VK_SHADER_STAGE_FRAGMENT_BIT };
-	skyviewLUT.AddSpecializationConstant(static_cast<uint32_t>(useSpectral));
-	vkc::ShaderStage sky{ m_Context, help::ReadFile("shaders/sky_color.spv"), VK_SHADER_STAGE_FRAGMENT_BIT };
-	sky.AddSpecializationConstant(static_cast<uint32_t>(useSpectral));
+	vkc::ShaderStage const vert{ m_Context, CopyEmbeddedShader("basic_transform"), VK_SHADER_STAGE_VERTEX_BIT };
+	vkc::ShaderStage const frag{ m_Context, CopyEmbeddedShader("basic_color"), VK_SHADER_STAGE_FRAGMENT_BIT };
 
-	VkFormat colorAttachmentFormats[]{ m_Context.Swapchain.image_format };
+	VkFormat colorAttachmentFormats[]{ m_ColorFormat };
 
 	VkPipelineColorBlendAttachmentState colorBlendAttachment{};
 	colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT |
@@ -813,63 +2066,177 @@ void App::CreateGraphicsPipeline()
 
 	//
 	{
-		vkc::PipelineBuilder builder{ m_Context };
-		vkc::Pipeline        pipeline = builder
-								 .SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
-								 .AddViewport(m_Context.Swapchain.extent)
-								 .SetPolygonMode(VK_POLYGON_MODE_FILL)
-								 .SetCullMode(VK_CULL_MODE_BACK_BIT)
-								 .SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
-								 .SetVertexDescription(Vertex::GetBindingDescription(), Vertex::GetAttributeDescription())
-								 .AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
-								 .AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
-								 .AddColorBlendAttachment(colorBlendAttachment)
-								 .SetRenderingAttachments(colorAttachmentFormats, m_DepthFormat, VK_FORMAT_UNDEFINED)
-								 .EnableDepthTest(VK_COMPARE_OP_LESS)
-								 .EnableDepthWrite()
-								 .AddShaderStage(vert)
-								 .AddShaderStage(frag)
-								 .Build(*m_PipelineLayout, true);
+		vkc::Pipeline pipeline = m_PipelineCache->Build(m_Context, [&]
+		{
+			vkc::PipelineBuilder builder{ m_Context };
+			return builder
+				.SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+				.AddViewport(m_RenderExtent)
+				.SetPolygonMode(VK_POLYGON_MODE_FILL)
+				.SetCullMode(VK_CULL_MODE_BACK_BIT)
+				.SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
+				.SetVertexDescription(Vertex::GetBindingDescription(), Vertex::GetAttributeDescription())
+				.AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
+				.AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
+				.AddColorBlendAttachment(colorBlendAttachment)
+				.SetRenderingAttachments(colorAttachmentFormats, m_DepthFormat, VK_FORMAT_UNDEFINED)
+				.EnableDepthTest(VK_COMPARE_OP_LESS)
+				.EnableDepthWrite()
+				.AddShaderStage(vert)
+				.AddShaderStage(frag)
+				.Build(*m_PipelineLayout, true);
+		});
 		m_Pipeline = std::make_unique<vkc::Pipeline>(std::move(pipeline));
 	}
+	// does not depend on the quality settings, only the low resolution march is built per tier
+	if (m_LowResSkyImage)
+	{
+		vkc::ShaderStage const farQuad{ m_Context, CopyEmbeddedShader("fsquad_far"), VK_SHADER_STAGE_VERTEX_BIT };
+		vkc::ShaderStage const upsample{ m_Context, CopyEmbeddedShader("sky_upsample"), VK_SHADER_STAGE_FRAGMENT_BIT };
+
+		vkc::Pipeline pipeline = m_PipelineCache->Build(m_Context, [&]
+		{
+			vkc::PipelineBuilder builder{ m_Context };
+			return builder
+				.SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+				.AddViewport(m_RenderExtent)
+				.SetPolygonMode(VK_POLYGON_MODE_FILL)
+				.SetCullMode(VK_CULL_MODE_NONE)
+				.SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
+				.AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
+				.AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
+				.AddColorBlendAttachment(colorBlendAttachment)
+				.SetRenderingAttachments(colorAttachmentFormats, m_DepthFormat, VK_FORMAT_UNDEFINED)
+				.EnableDepthTest(VK_COMPARE_OP_LESS_OR_EQUAL)
+				.AddShaderStage(farQuad)
+				.AddShaderStage(upsample)
+				.Build(*m_PipelineLayout, true);
+		});
+		m_SkyUpsamplePipeline = std::make_unique<vkc::Pipeline>(std::move(pipeline));
+	}
 
-	//
+	CreateLUTPipelines();
+}
+
+void App::CreateLUTPipelines()
+{
+	vkc::ShaderStage const& fsQuad{ *m_FullscreenStage };
+	vkc::ShaderStage        transmittanceLUT{ m_Context, CopyEmbeddedShader("transmittanceLUT"), VK_SHADER_STAGE_FRAGMENT_BIT };
+	AddSpecializationConstants(transmittanceLUT);
+	vkc::ShaderStage multScatteringLUT{ m_Context, CopyEmbeddedShader("multiple_scattering"), VK_SHADER_STAGE_FRAGMENT_BIT };
+	AddSpecializationConstants(multScatteringLUT);
+	vkc::ShaderStage skyviewLUT{ m_Context, CopyEmbeddedShader("skyview"), VK_SHADER_STAGE_FRAGMENT_BIT };
+	AddSpecializationConstants(skyviewLUT);
+	vkc::ShaderStage const farQuad{ m_Context, CopyEmbeddedShader("fsquad_far"), VK_SHADER_STAGE_VERTEX_BIT };
+	vkc::ShaderStage       sky{ m_Context, CopyEmbeddedShader("sky_color"), VK_SHADER_STAGE_FRAGMENT_BIT };
+	AddSpecializationConstants(sky);
+
+	VkFormat colorAttachmentFormats[]{ m_ColorFormat };
+
+	VkPipelineColorBlendAttachmentState colorBlendAttachment{};
+	colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT |
+										  VK_COLOR_COMPONENT_A_BIT;
+
+	// the depth buffer is cleared to 1 and geometry passes with less, so only sky pixels are equal to the far plane triangle
 	{
-		vkc::PipelineBuilder builder{ m_Context };
-		vkc::Pipeline        pipeline = builder
-								 .SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
-								 .AddViewport(m_Context.Swapchain.extent)
-								 .SetPolygonMode(VK_POLYGON_MODE_FILL)
-								 .SetCullMode(VK_CULL_MODE_NONE)
-								 .SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
-								 .AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
-								 .AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
-								 .AddColorBlendAttachment(colorBlendAttachment)
-								 .SetRenderingAttachments(colorAttachmentFormats, VK_FORMAT_UNDEFINED, VK_FORMAT_UNDEFINED)
-								 .AddShaderStage(fsQuad)
-								 .AddShaderStage(sky)
-								 .Build(*m_PipelineLayout, true);
+		vkc::Pipeline pipeline = m_PipelineCache->Build(m_Context, [&]
+		{
+			vkc::PipelineBuilder builder{ m_Context };
+			return builder
+				.SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+				.AddViewport(m_RenderExtent)
+				.SetPolygonMode(VK_POLYGON_MODE_FILL)
+				.SetCullMode(VK_CULL_MODE_NONE)
+				.SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
+				.AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
+				.AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
+				.AddColorBlendAttachment(colorBlendAttachment)
+				.SetRenderingAttachments(colorAttachmentFormats, m_DepthFormat, VK_FORMAT_UNDEFINED)
+				.EnableDepthTest(VK_COMPARE_OP_LESS_OR_EQUAL)
+				.AddShaderStage(farQuad)
+				.AddShaderStage(sky)
+				.Build(*m_PipelineLayout, true);
+		});
 		m_SkyRenderPipeline = std::make_unique<vkc::Pipeline>(std::move(pipeline));
 	}
+	if (m_LowResSkyImage)
+	{
+		vkc::ShaderStage lowResSky{ m_Context
+									, CopyEmbeddedShader(m_SkyHistory ? "sky_checkerboard" : "sky_color_lowres")
+									, VK_SHADER_STAGE_FRAGMENT_BIT };
+		AddSpecializationConstants(lowResSky);
+
+		VkFormat lowResFormats[]{ m_LowResSkyImage->GetFormat() };
+
+		vkc::Pipeline pipeline = m_PipelineCache->Build(m_Context, [&]
+		{
+			vkc::PipelineBuilder builder{ m_Context };
+			return builder
+				.SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+				.AddViewport(m_LowResSkyImage->GetExtent())
+				.SetPolygonMode(VK_POLYGON_MODE_FILL)
+				.SetCullMode(VK_CULL_MODE_NONE)
+				.SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
+				.AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
+				.AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
+				.AddColorBlendAttachment(colorBlendAttachment)
+				.SetRenderingAttachments(lowResFormats, VK_FORMAT_UNDEFINED, VK_FORMAT_UNDEFINED)
+				.AddShaderStage(fsQuad)
+				.AddShaderStage(lowResSky)
+				.Build(*m_PipelineLayout, true);
+		});
+		m_LowResSkyPipeline = std::make_unique<vkc::Pipeline>(std::move(pipeline));
+	}
+	// ray marches the whole frame when the history is rejected, so it is built per tier
+	if (m_SkyHistory)
+	{
+		vkc::ShaderStage resolve{ m_Context, CopyEmbeddedShader("sky_temporal_resolve"), VK_SHADER_STAGE_FRAGMENT_BIT };
+		AddSpecializationConstants(resolve);
+
+		VkFormat historyFormats[]{ m_SkyHistoryImages.front().GetFormat() };
+
+		vkc::Pipeline pipeline = m_PipelineCache->Build(m_Context, [&]
+		{
+			vkc::PipelineBuilder builder{ m_Context };
+			return builder
+				.SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+				.AddViewport(m_RenderExtent)
+				.SetPolygonMode(VK_POLYGON_MODE_FILL)
+				.SetCullMode(VK_CULL_MODE_NONE)
+				.SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
+				.AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
+				.AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
+				.AddColorBlendAttachment(colorBlendAttachment)
+				.SetRenderingAttachments(historyFormats, m_DepthFormat, VK_FORMAT_UNDEFINED)
+				.EnableDepthTest(VK_COMPARE_OP_LESS_OR_EQUAL)
+				.AddShaderStage(farQuad)
+				.AddShaderStage(resolve)
+				.Build(*m_PipelineLayout, true);
+		});
+		m_SkyResolvePipeline = std::make_unique<vkc::Pipeline>(std::move(pipeline));
+	}
 
 	//
 	{
 		VkFormat transmittanceFormat = m_TransmittanceImage->GetFormat();
 
-		vkc::PipelineBuilder builder{ m_Context };
-		vkc::Pipeline        pipeline = builder
-								 .SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
-								 .AddViewport(m_TransmittanceImage->GetExtent())
-								 .SetPolygonMode(VK_POLYGON_MODE_FILL)
-								 .SetCullMode(VK_CULL_MODE_NONE)
-								 .SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
-								 .AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
-								 .AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
-								 .AddColorBlendAttachment(colorBlendAttachment)
-								 .SetRenderingAttachments({ &transmittanceFormat, 1 }, VK_FORMAT_UNDEFINED, VK_FORMAT_UNDEFINED)
-								 .AddShaderStage(fsQuad)
-								 .AddShaderStage(transmittanceLUT)
-								 .Build(*m_EmptyPipelineLayout, true);
+		vkc::Pipeline pipeline = m_PipelineCache->Build(m_Context, [&]
+		{
+			vkc::PipelineBuilder builder{ m_Context };
+			return builder
+				.SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+				.AddViewport(m_TransmittanceImage->GetExtent())
+				.SetPolygonMode(VK_POLYGON_MODE_FILL)
+				.SetCullMode(VK_CULL_MODE_NONE)
+				.SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
+				.AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
+				.AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
+				.AddColorBlendAttachment(colorBlendAttachment)
+				.SetRenderingAttachments({ &transmittanceFormat, 1 }, VK_FORMAT_UNDEFINED, VK_FORMAT_UNDEFINED)
+				.AddShaderStage(fsQuad)
+				.AddShaderStage(transmittanceLUT)
+				.Build(*m_EmptyPipelineLayout, true);
+		});
 		m_TransmittancePipeline = std::make_unique<vkc::Pipeline>(std::move(pipeline));
 	}
 
@@ -877,20 +2244,23 @@ void App::CreateGraphicsPipeline()
 	{
 		VkFormat lutFormat = m_MultScatteringImage->GetFormat();
 
-		vkc::PipelineBuilder builder{ m_Context };
-		vkc::Pipeline        pipeline = builder
-								 .SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
-								 .AddViewport(m_MultScatteringImage->GetExtent())
-								 .SetPolygonMode(VK_POLYGON_MODE_FILL)
-								 .SetCullMode(VK_CULL_MODE_NONE)
-								 .SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
-								 .AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
-								 .AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
-								 .AddColorBlendAttachment(colorBlendAttachment)
-								 .SetRenderingAttachments({ &lutFormat, 1 }, VK_FORMAT_UNDEFINED, VK_FORMAT_UNDEFINED)
-								 .AddShaderStage(fsQuad)
-								 .AddShaderStage(multScatteringLUT)
-								 .Build(*m_PipelineLayout, true);
+		vkc::Pipeline pipeline = m_PipelineCache->Build(m_Context, [&]
+		{
+			vkc::PipelineBuilder builder{ m_Context };
+			return builder
+				.SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+				.AddViewport(m_MultScatteringImage->GetExtent())
+				.SetPolygonMode(VK_POLYGON_MODE_FILL)
+				.SetCullMode(VK_CULL_MODE_NONE)
+				.SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
+				.AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
+				.AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
+				.AddColorBlendAttachment(colorBlendAttachment)
+				.SetRenderingAttachments({ &lutFormat, 1 }, VK_FORMAT_UNDEFINED, VK_FORMAT_UNDEFINED)
+				.AddShaderStage(fsQuad)
+				.AddShaderStage(multScatteringLUT)
+				.Build(*m_PipelineLayout, true);
+		});
 		m_MultipleScatteringPipeline = std::make_unique<vkc::Pipeline>(std::move(pipeline));
 	}
 
@@ -898,20 +2268,23 @@ void App::CreateGraphicsPipeline()
 	{
 		VkFormat lutFormat = m_SkyviewImage->GetFormat();
 
-		vkc::PipelineBuilder builder{ m_Context };
-		vkc::Pipeline        pipeline = builder
-								 .SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
-								 .AddViewport(m_SkyviewImage->GetExtent())
-								 .SetPolygonMode(VK_POLYGON_MODE_FILL)
-								 .SetCullMode(VK_CULL_MODE_NONE)
-								 .SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
-								 .AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
-								 .AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
-								 .AddColorBlendAttachment(colorBlendAttachment)
-								 .SetRenderingAttachments({ &lutFormat, 1 }, VK_FORMAT_UNDEFINED, VK_FORMAT_UNDEFINED)
-								 .AddShaderStage(fsQuad)
-								 .AddShaderStage(skyviewLUT)
-								 .Build(*m_PipelineLayout, true);
+		vkc::Pipeline pipeline = m_PipelineCache->Build(m_Context, [&]
+		{
+			vkc::PipelineBuilder builder{ m_Context };
+			return builder
+				.SetTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST)
+				.AddViewport(m_SkyviewImage->GetExtent())
+				.SetPolygonMode(VK_POLYGON_MODE_FILL)
+				.SetCullMode(VK_CULL_MODE_NONE)
+				.SetFrontFace(VK_FRONT_FACE_COUNTER_CLOCKWISE)
+				.AddDynamicState(VK_DYNAMIC_STATE_VIEWPORT)
+				.AddDynamicState(VK_DYNAMIC_STATE_SCISSOR)
+				.AddColorBlendAttachment(colorBlendAttachment)
+				.SetRenderingAttachments({ &lutFormat, 1 }, VK_FORMAT_UNDEFINED, VK_FORMAT_UNDEFINED)
+				.AddShaderStage(fsQuad)
+				.AddShaderStage(skyviewLUT)
+				.Build(*m_PipelineLayout, true);
+		});
 		m_SkyviewPipeline = std::make_unique<vkc::Pipeline>(std::move(pipeline));
 	}
 }
@@ -922,6 +2295,17 @@ void App::CreateCmdPool()
 													   , m_Context.Device.get_queue_index(vkb::QueueType::graphics).value()
 													   , m_FramesInFlight
 													   , VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+	if (!m_ComputeQueue)
+		return;
+
+	m_GeometryCommandPool = std::make_unique<vkc::CommandPool>(m_Context
+															   , m_GraphicsQueueFamily
+															   , m_FramesInFlight
+															   , VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
+	m_ComputeCommandPool = std::make_unique<vkc::CommandPool>(m_Context
+															  , m_ComputeQueueFamily
+															  , m_FramesInFlight
+															  , VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT);
 }
 
 void App::CreateDescriptorSetLayouts()
@@ -933,15 +2317,43 @@ void App::CreateDescriptorSetLayouts()
 									  .AddBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
 									  .AddBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
 									  .AddBinding(4, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+									  .AddBinding(5, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+									  .AddBinding(6, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+									  .AddBinding(7, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+									  .AddBinding(8, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+									  .AddBinding(9, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
 									  .Build();
 
 	m_FrameDescSetLayout = std::make_unique<vkc::DescriptorSetLayout>(std::move(layout));
-}
 
-void App::CreateResources()
-{
-	// mvp ubo
-	{
+	// binding numbers of the samplers match the frame layout so the shared LUT includes stay unchanged
+	vkc::DescriptorSetLayoutBuilder computeBuilder{ m_Context };
+	vkc::DescriptorSetLayout        computeLayout = computeBuilder
+											 .AddBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_SHADER_STAGE_COMPUTE_BIT)
+											 .AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+											 .AddBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+											 .AddBinding(3, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+											 .AddBinding(6, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+											 .Build();
+
+	m_ComputeDescSetLayout = std::make_unique<vkc::DescriptorSetLayout>(std::move(computeLayout));
+
+	if (!m_Headless)
+		return;
+
+	vkc::DescriptorSetLayoutBuilder readbackBuilder{ m_Context };
+	vkc::DescriptorSetLayout        readbackLayout = readbackBuilder
+											  .AddBinding(0, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_COMPUTE_BIT)
+											  .AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_COMPUTE_BIT)
+											  .Build();
+
+	m_ReadbackDescSetLayout = std::make_unique<vkc::DescriptorSetLayout>(std::move(readbackLayout));
+}
+
+void App::CreateResources()
+{
+	// mvp ubo
+	{
 		vkc::BufferBuilder builder{ m_Context };
 		builder.MapMemory().SetMemoryUsage(VMA_MEMORY_USAGE_CPU_TO_GPU);
 
@@ -967,15 +2379,37 @@ void App::CreateResources()
 			m_Context.DispatchTable.destroySampler(m_Sampler, nullptr);
 		});
 	}
+	CreateLUTImages();
+	// create aerial perspective froxel volume, rgba16f storage support is mandatory
+	{
+		glm::uvec3 const resolution{ m_Options.AerialPerspectiveResolution };
+		m_AerialPerspectiveImage = std::make_unique<VolumeImage>(m_Context
+																 , VkExtent3D{ resolution.x, resolution.y, resolution.z }
+																 , 1
+																 , VK_FORMAT_R16G16B16A16_SFLOAT
+																 , VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+		m_Context.DeletionQueue.Push([this]
+		{
+			m_AerialPerspectiveImage->Destroy(m_Context);
+		});
+	}
+	CreateDepth();
+	CreateLowResSky();
+}
+
+void App::CreateLUTImages()
+{
+	VkImageUsageFlags const lutStorageUsage{ m_ComputeLUTs ? VK_IMAGE_USAGE_STORAGE_BIT : 0u };
 	// create transmittance LUT image
 	{
 		vkc::ImageBuilder builder{ m_Context };
 		vkc::Image        image = builder
-						   .SetExtent(VkExtent2D{ 256, 64 })
+						   .SetExtent(VkExtent2D{ m_Options.Quality.TransmittanceExtent.x, m_Options.Quality.TransmittanceExtent.y })
 						   .SetFormat(VK_FORMAT_R16G16B16A16_UNORM)
 						   .SetType(VK_IMAGE_TYPE_2D)
 						   .SetAspectFlags(VK_IMAGE_ASPECT_COLOR_BIT)
-						   .Build(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+						   .Build(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | lutStorageUsage |
+							  VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
 		m_TransmittanceImage = std::make_unique<vkc::Image>(std::move(image));
 
 		vkc::ImageView imageView = m_TransmittanceImage->CreateView(m_Context, VK_IMAGE_VIEW_TYPE_2D);
@@ -985,38 +2419,74 @@ void App::CreateResources()
 	{
 		vkc::ImageBuilder builder{ m_Context };
 		vkc::Image        image = builder
-						   .SetExtent(VkExtent2D{ 32, 32 })
+						   .SetExtent(VkExtent2D{ m_Options.Quality.MultScatteringExtent.x, m_Options.Quality.MultScatteringExtent.y })
 						   .SetFormat(VK_FORMAT_R16G16B16A16_SFLOAT)
 						   .SetType(VK_IMAGE_TYPE_2D)
 						   .SetAspectFlags(VK_IMAGE_ASPECT_COLOR_BIT)
-						   .Build(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+						   .Build(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | lutStorageUsage |
+							  VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
 		m_MultScatteringImage = std::make_unique<vkc::Image>(std::move(image));
 
 		vkc::ImageView imageView  = m_MultScatteringImage->CreateView(m_Context, VK_IMAGE_VIEW_TYPE_2D);
 		m_MultScatteringImageView = std::make_unique<vkc::ImageView>(std::move(imageView));
 	}
+	// create optical depth LUT image, same extent as the transmittance LUT, rgba16f storage support is mandatory
+	{
+		vkc::ImageBuilder builder{ m_Context };
+		vkc::Image        image = builder
+						   .SetExtent(VkExtent2D{ m_Options.Quality.TransmittanceExtent.x, m_Options.Quality.TransmittanceExtent.y })
+						   .SetFormat(VK_FORMAT_R16G16B16A16_SFLOAT)
+						   .SetType(VK_IMAGE_TYPE_2D)
+						   .SetAspectFlags(VK_IMAGE_ASPECT_COLOR_BIT)
+						   .Build(VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT);
+		m_OpticalDepthImage = std::make_unique<vkc::Image>(std::move(image));
+
+		vkc::ImageView imageView = m_OpticalDepthImage->CreateView(m_Context, VK_IMAGE_VIEW_TYPE_2D);
+		m_OpticalDepthImageView  = std::make_unique<vkc::ImageView>(std::move(imageView));
+	}
 	// create skyview LUT image
 	{
 		vkc::ImageBuilder builder{ m_Context };
 		vkc::Image        image = builder
-						   .SetExtent(VkExtent2D{ 200, 100 })
+						   .SetExtent(VkExtent2D{ m_Options.Quality.SkyviewExtent.x, m_Options.Quality.SkyviewExtent.y })
 						   .SetFormat(VK_FORMAT_R16G16B16A16_SFLOAT)
 						   .SetType(VK_IMAGE_TYPE_2D)
 						   .SetAspectFlags(VK_IMAGE_ASPECT_COLOR_BIT)
-						   .Build(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+						   .Build(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | lutStorageUsage);
 		m_SkyviewImage = std::make_unique<vkc::Image>(std::move(image));
 
 		vkc::ImageView imageView = m_SkyviewImage->CreateView(m_Context, VK_IMAGE_VIEW_TYPE_2D);
 		m_SkyviewImageView       = std::make_unique<vkc::ImageView>(std::move(imageView));
+
+		if (m_Options.SkyviewArraySlices > 0 && !m_ComputeLUTs)
+			std::cout << "sky-view bake needs compute LUTs, ray marching the sky-view LUT every frame" << std::endl;
+		else if (m_Options.SkyviewArraySlices > 0)
+		{
+			m_SkyviewArrayImage = std::make_unique<VolumeImage>(m_Context
+																, VkExtent3D{ m_SkyviewImage->GetExtent().width, m_SkyviewImage->GetExtent().height, 1 }
+																, m_Options.SkyviewArraySlices
+																, VK_FORMAT_R16G16B16A16_SFLOAT
+																, VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_SAMPLED_BIT);
+			// captured by value, the member is swapped when the quality tier changes
+			m_Context.DeletionQueue.Push([image = m_SkyviewArrayImage.get(), this]
+			{
+				image->Destroy(m_Context);
+			});
+		}
+
+		// blending baked slices redraws the whole LUT for less than one amortized band costs
+		m_SkyviewSchedule = std::make_unique<SkyviewSchedule>(m_SkyviewImage->GetExtent().height
+															  , m_SkyviewArrayImage ? 0 : m_Options.SkyviewRowsPerFrame
+															  , SKYVIEW_MAX_SUN_DRIFT
+															  , SKYVIEW_MAX_ALTITUDE_DRIFT);
 	}
-	CreateDepth();
 }
 
 void App::CreateDepth()
 {
 	vkc::ImageBuilder builder{ m_Context };
 	vkc::Image        image = builder
-					   .SetExtent(m_Context.Swapchain.extent)
+					   .SetExtent(m_RenderExtent)
 					   .SetFormat(m_DepthFormat)
 					   .SetType(VK_IMAGE_TYPE_2D)
 					   .SetAspectFlags(VK_IMAGE_ASPECT_DEPTH_BIT | help::HasStencilComponent(m_DepthFormat) *
@@ -1028,6 +2498,111 @@ void App::CreateDepth()
 	m_DepthImageView         = std::make_unique<vkc::ImageView>(std::move(imageView));
 }
 
+void App::CreateLowResSky()
+{
+	// the benchmark times the half and the quarter resolution march, the quarter one renders into the top left of the image
+	uint32_t const skyScale{ m_Options.Mode == Command::Benchmark ? 2 : m_Headless ? 1 : m_Options.SkyScale };
+	uint32_t const pattern{ m_Headless ? 1 : m_Options.SkyPattern };
+	if (skyScale == 1 && pattern == 1)
+		return;
+
+	// the temporal sky packs its pattern into half the width, and half the height too for 2x2 blocks, see sky_temporal.glsl
+	VkExtent2D const extent{
+		pattern == 1
+			? VkExtent2D{ (m_RenderExtent.width + skyScale - 1) / skyScale, (m_RenderExtent.height + skyScale - 1) / skyScale }
+			: VkExtent2D{ (m_RenderExtent.width + 1) / 2, pattern == 4 ? (m_RenderExtent.height + 1) / 2 : m_RenderExtent.height }
+	};
+
+	vkc::ImageBuilder builder{ m_Context };
+	vkc::Image        image = builder
+					   .SetExtent(extent)
+					   .SetFormat(VK_FORMAT_R16G16B16A16_SFLOAT)
+					   .SetType(VK_IMAGE_TYPE_2D)
+					   .SetAspectFlags(VK_IMAGE_ASPECT_COLOR_BIT)
+					   .Build(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, false);
+	m_LowResSkyImage = std::make_unique<vkc::Image>(std::move(image));
+
+	vkc::ImageView imageView = m_LowResSkyImage->CreateView(m_Context, VK_IMAGE_VIEW_TYPE_2D, 0, 1, 0, 1, false);
+	m_LowResSkyImageView     = std::make_unique<vkc::ImageView>(std::move(imageView));
+
+	if (pattern == 1)
+		return;
+
+	vkc::ImageBuilder historyBuilder{ m_Context };
+	historyBuilder
+		.SetExtent(m_RenderExtent)
+		.SetFormat(VK_FORMAT_R16G16B16A16_SFLOAT)
+		.SetType(VK_IMAGE_TYPE_2D)
+		.SetAspectFlags(VK_IMAGE_ASPECT_COLOR_BIT);
+	for (uint32_t index{}; index < m_FramesInFlight; ++index)
+	{
+		m_SkyHistoryImages.emplace_back(historyBuilder.Build(VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT, false));
+		m_SkyHistoryImageViews.emplace_back(m_SkyHistoryImages.back().CreateView(m_Context, VK_IMAGE_VIEW_TYPE_2D, 0, 1, 0, 1, false));
+	}
+	// the new history images hold nothing to reproject
+	if (m_SkyHistory)
+		m_SkyHistory->Invalidate();
+	else
+		m_SkyHistory = std::make_unique<SkyHistory>(pattern
+													, SKY_HISTORY_MAX_SUN_DRIFT
+													, SKY_HISTORY_MAX_CAMERA_DRIFT
+													, SKY_HISTORY_MAX_ROTATION);
+}
+
+void App::DestroyLowResSky()
+{
+	if (!m_LowResSkyImage)
+		return;
+
+	m_LowResSkyImage->Destroy(m_Context);
+	m_LowResSkyImageView->Destroy(m_Context);
+	for (uint32_t index{}; index < m_SkyHistoryImages.size(); ++index)
+	{
+		m_SkyHistoryImageViews[index].Destroy(m_Context);
+		m_SkyHistoryImages[index].Destroy(m_Context);
+	}
+	m_SkyHistoryImageViews.clear();
+	m_SkyHistoryImages.clear();
+}
+
+void App::WriteRenderTargetDescriptors(std::span<vkc::DescriptorSet> descriptorSets)
+{
+	VkDescriptorImageInfo depthInfo{};
+	depthInfo.imageView   = *m_DepthImageView;
+	depthInfo.imageLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL; // sampled while the sky passes depth test against it
+	depthInfo.sampler     = m_Sampler;
+
+	for (uint32_t index{}; index < descriptorSets.size(); ++index)
+	{
+		vkc::DescriptorSet& descriptorSet{ descriptorSets[index] };
+		descriptorSet.AddWriteDescriptor({ &depthInfo, 1 }, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, 0);
+		// left unwritten at full resolution, binding 7 is what sky_upsample.frag composites
+		// the temporal sky composites the history of the frame and reads the shaded pattern and the previous history
+		VkDescriptorImageInfo skyInfos[3]{};
+		if (m_LowResSkyImage)
+		{
+			for (VkDescriptorImageInfo& info: skyInfos)
+			{
+				info.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+				info.sampler     = m_Sampler;
+			}
+			skyInfos[0].imageView = *m_LowResSkyImageView;
+			if (!m_SkyHistoryImageViews.empty())
+			{
+				uint32_t const frameCount{ static_cast<uint32_t>(m_SkyHistoryImageViews.size()) };
+				skyInfos[0].imageView = m_SkyHistoryImageViews[index % frameCount];
+				skyInfos[1].imageView = *m_LowResSkyImageView;
+				skyInfos[2].imageView = m_SkyHistoryImageViews[(index + frameCount - 1) % frameCount];
+				descriptorSet
+					.AddWriteDescriptor({ &skyInfos[1], 1 }, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 8, 0)
+					.AddWriteDescriptor({ &skyInfos[2], 1 }, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 9, 0);
+			}
+			descriptorSet.AddWriteDescriptor({ &skyInfos[0], 1 }, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 7, 0);
+		}
+		descriptorSet.Update(m_Context);
+	}
+}
+
 void App::GenerateTransmittanceLUT(vkc::CommandBuffer& commandBuffer)
 {
 	//
@@ -1037,7 +2612,7 @@ void App::GenerateTransmittanceLUT(vkc::CommandBuffer& commandBuffer)
 		{
 			transition.SrcAccessMask = VK_ACCESS_2_NONE;
 			transition.DstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_NONE;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT; // previous reads must finish before overwriting
 			transition.DstStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
 			transition.NewLayout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 		}
@@ -1079,6 +2654,19 @@ void App::GenerateTransmittanceLUT(vkc::CommandBuffer& commandBuffer)
 		m_Context.DispatchTable.cmdDraw(commandBuffer, 3, 1, 0, 0);
 	}
 	m_Context.DispatchTable.cmdEndRendering(commandBuffer);
+	// leave the LUT readable so later passes need no extra barrier
+	{
+		vkc::Image::Transition transition{};
+		//
+		{
+			transition.SrcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+			transition.DstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+			transition.DstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+			transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		}
+		m_TransmittanceImage->MakeTransition(m_Context, commandBuffer, transition);
+	}
 }
 
 void App::GenerateMultScatteringLUT(vkc::CommandBuffer& commandBuffer)
@@ -1090,25 +2678,12 @@ void App::GenerateMultScatteringLUT(vkc::CommandBuffer& commandBuffer)
 		{
 			transition.SrcAccessMask = VK_ACCESS_2_NONE;
 			transition.DstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_NONE;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT; // previous reads must finish before overwriting
 			transition.DstStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
 			transition.NewLayout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 		}
 		m_MultScatteringImage->MakeTransition(m_Context, commandBuffer, transition);
 	}
-	//
-	{
-		vkc::Image::Transition transition{};
-		//
-		{
-			transition.SrcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			transition.DstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
-			transition.DstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
-			transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-		}
-		m_TransmittanceImage->MakeTransition(m_Context, commandBuffer, transition);
-	}
 
 	VkRenderingAttachmentInfo renderingAttachmentInfo{};
 	renderingAttachmentInfo.sType       = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
@@ -1153,48 +2728,35 @@ void App::GenerateMultScatteringLUT(vkc::CommandBuffer& commandBuffer)
 		m_Context.DispatchTable.cmdDraw(commandBuffer, 3, 1, 0, 0);
 	}
 	m_Context.DispatchTable.cmdEndRendering(commandBuffer);
-}
-
-void App::GenerateSkyviewLUT(vkc::CommandBuffer& commandBuffer)
-{
-	//
-	{
-		vkc::Image::Transition transition{};
-		//
-		{
-			transition.SrcAccessMask = VK_ACCESS_2_NONE;
-			transition.DstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_NONE;
-			transition.DstStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
-			transition.NewLayout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
-		}
-		m_SkyviewImage->MakeTransition(m_Context, commandBuffer, transition);
-	}
-	//
+	// leave the LUT readable so later passes need no extra barrier
 	{
 		vkc::Image::Transition transition{};
 		//
 		{
-			transition.SrcAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			transition.SrcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 			transition.DstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
-			transition.DstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+			transition.DstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
 			transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 		}
-		m_TransmittanceImage->MakeTransition(m_Context, commandBuffer, transition);
+		m_MultScatteringImage->MakeTransition(m_Context, commandBuffer, transition);
 	}
+}
+
+void App::GenerateSkyviewLUT(vkc::CommandBuffer& commandBuffer, std::span<SkyviewRows const> rows)
+{
 	//
 	{
 		vkc::Image::Transition transition{};
 		//
 		{
-			transition.SrcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			transition.DstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
-			transition.DstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
-			transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			transition.SrcAccessMask = VK_ACCESS_2_NONE;
+			transition.DstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT; // previous reads must finish before overwriting
+			transition.DstStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+			transition.NewLayout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 		}
-		m_MultScatteringImage->MakeTransition(m_Context, commandBuffer, transition);
+		m_SkyviewImage->MakeTransition(m_Context, commandBuffer, transition);
 	}
 
 	VkRenderingAttachmentInfo renderingAttachmentInfo{};
@@ -1202,7 +2764,7 @@ void App::GenerateSkyviewLUT(vkc::CommandBuffer& commandBuffer)
 	renderingAttachmentInfo.clearValue  = { { .03f, .03f, .03f, 1.f } };
 	renderingAttachmentInfo.imageLayout = m_SkyviewImage->GetLayout();
 	renderingAttachmentInfo.imageView   = *m_SkyviewImageView;
-	renderingAttachmentInfo.loadOp      = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	renderingAttachmentInfo.loadOp      = rows.empty() ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
 	renderingAttachmentInfo.storeOp     = VK_ATTACHMENT_STORE_OP_STORE;
 
 	VkRenderingInfo renderingInfo{};
@@ -1232,10 +2794,6 @@ void App::GenerateSkyviewLUT(vkc::CommandBuffer& commandBuffer)
 
 		m_Context.DispatchTable.cmdSetViewport(commandBuffer, 0, 1, &viewport);
 
-		VkRect2D scissor{};
-		scissor.offset = { 0, 0 };
-		scissor.extent = m_SkyviewImage->GetExtent();
-		m_Context.DispatchTable.cmdSetScissor(commandBuffer, 0, 1, &scissor);
 
 		struct PushConstant
 		{
@@ -1248,7 +2806,7 @@ void App::GenerateSkyviewLUT(vkc::CommandBuffer& commandBuffer)
 		PushConstant pushConstant
 		{
 			m_Camera->GetPosition(), tan(glm::radians(m_Camera->GetFov() * .5f)), m_Camera->GetForward(), m_Camera->GetAspectRatio()
-			, world_time::GetRunTime()
+			, GetSceneTime()
 		};
 
 		m_Context.DispatchTable.cmdPushConstants(commandBuffer
@@ -1258,165 +2816,801 @@ void App::GenerateSkyviewLUT(vkc::CommandBuffer& commandBuffer)
 												 , sizeof(pushConstant)
 												 , &pushConstant);
 
-		m_Context.DispatchTable.cmdDraw(commandBuffer, 3, 1, 0, 0);
+		// the viewport always covers the whole LUT so bands land on the same texels as a full redraw
+		std::vector<VkRect2D> scissors{};
+		if (rows.empty())
+			scissors.emplace_back(VkRect2D{ {}, m_SkyviewImage->GetExtent() });
+		for (SkyviewRows const& band: rows)
+			scissors.emplace_back(VkRect2D{ { 0, static_cast<int32_t>(band.First) }, { m_SkyviewImage->GetExtent().width, band.Count } });
+
+		for (VkRect2D const& scissor: scissors)
+		{
+			m_Context.DispatchTable.cmdSetScissor(commandBuffer, 0, 1, &scissor);
+			m_Context.DispatchTable.cmdDraw(commandBuffer, 3, 1, 0, 0);
+		}
 	}
 	m_Context.DispatchTable.cmdEndRendering(commandBuffer);
+	// leave the LUT readable so later passes need no extra barrier
+	{
+		vkc::Image::Transition transition{};
+		//
+		{
+			transition.SrcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+			transition.DstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+			transition.DstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+			transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		}
+		m_SkyviewImage->MakeTransition(m_Context, commandBuffer, transition);
+	}
 }
 
-void App::RecreateSwapchain()
+void App::CreateComputePipelines()
 {
-	if (auto const result = m_Context.DispatchTable.deviceWaitIdle();
-		result != VK_SUCCESS)
-		throw std::runtime_error("Failed to wait for device to be idle");
-
-	std::vector<VkImageView> views;
-	views.reserve(m_SwapchainImageViews.size());
-	for (uint32_t index{}; index < m_SwapchainImageViews.size(); ++index)
-		views.emplace_back(m_SwapchainImageViews[index]);
-	m_Context.Swapchain.destroy_image_views(views);
+	vkc::PipelineLayoutBuilder builder{ m_Context };
+	vkc::PipelineLayout        layout = builder
+								 .AddDescriptorSetLayout(*m_ComputeDescSetLayout)
+								 .AddPushConstant(VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(glm::vec3) * 2 + sizeof(float) * 3 + sizeof(uint32_t))
+								 .Build();
+	m_ComputePipelineLayout = std::make_unique<vkc::PipelineLayout>(std::move(layout));
+
+	CreateComputeLUTPipelines();
+	// reads no sample counts, shared by every quality tier
+	if (m_SkyviewArrayImage)
+		m_SkyviewResolvePipeline = CreateComputePipeline(m_Context
+														 , *m_PipelineCache
+														 , GetEmbeddedShader("skyview_resolve")
+														 , *m_ComputePipelineLayout
+														 , {});
+
+	if (m_Headless)
+	{
+		vkc::PipelineLayoutBuilder readbackBuilder{ m_Context };
+		vkc::PipelineLayout        readbackLayout = readbackBuilder
+											 .AddDescriptorSetLayout(*m_ReadbackDescSetLayout)
+											 .AddPushConstant(VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(VkExtent2D))
+											 .Build();
+		m_ReadbackPipelineLayout = std::make_unique<vkc::PipelineLayout>(std::move(readbackLayout));
+		m_PlanarReadbackPipeline = CreateComputePipeline(m_Context, *m_PipelineCache, GetEmbeddedShader("planar_readback"), *m_ReadbackPipelineLayout, {});
+	}
 
-	m_DepthImage->Destroy(m_Context);
-	m_DepthImageView->Destroy(m_Context);
+	// destroying null handles is a no-op when the LUT pipelines were skipped
+	m_Context.DeletionQueue.Push([this]
+	{
+		m_Context.DispatchTable.destroyPipeline(m_PlanarReadbackPipeline, nullptr);
+		m_Context.DispatchTable.destroyPipeline(m_SkyviewResolvePipeline, nullptr);
+	});
+}
 
-	CreateSwapchain();
-	CreateDepth();
-	m_Camera->SetNewAspectRatio(static_cast<float>(m_Context.Swapchain.extent.width)
-								/ m_Context.Swapchain.extent.height); // NOLINT(*-narrowing-conversions)
+void App::CreateComputeLUTPipelines()
+{
+	std::array<uint32_t, 8> const specializationConstants{ GetSpecializationConstants() };
+
+	m_AerialPerspectivePipeline = CreateComputePipeline(m_Context
+														, *m_PipelineCache
+														, GetEmbeddedShader("aerial_perspective")
+														, *m_ComputePipelineLayout
+														, specializationConstants);
+	m_OpticalDepthPipeline = CreateComputePipeline(m_Context
+												   , *m_PipelineCache
+												   , GetEmbeddedShader("optical_depth_compute")
+												   , *m_ComputePipelineLayout
+												   , specializationConstants);
+	if (m_ComputeLUTs)
+	{
+		m_TransmittanceComputePipeline = CreateComputePipeline(m_Context
+															   , *m_PipelineCache
+															   , GetEmbeddedShader("transmittanceLUT_compute")
+															   , *m_ComputePipelineLayout
+															   , specializationConstants);
+		m_MultScatteringComputePipeline = CreateComputePipeline(m_Context
+																, *m_PipelineCache
+																, GetEmbeddedShader("multiple_scattering_compute")
+																, *m_ComputePipelineLayout
+																, specializationConstants);
+		m_SkyviewComputePipeline = CreateComputePipeline(m_Context
+														 , *m_PipelineCache
+														 , GetEmbeddedShader("skyview_compute")
+														 , *m_ComputePipelineLayout
+														 , specializationConstants);
+	}
+	if (m_SkyviewArrayImage)
+		m_SkyviewBakePipeline = CreateComputePipeline(m_Context
+													  , *m_PipelineCache
+													  , GetEmbeddedShader("skyview_bake")
+													  , *m_ComputePipelineLayout
+													  , specializationConstants);
+
+	// captured by value, the members are swapped when the quality tier changes
+	// destroying null handles is a no-op when the LUT pipelines were skipped
+	std::array const pipelines{
+		m_AerialPerspectivePipeline
+		, m_TransmittanceComputePipeline
+		, m_MultScatteringComputePipeline
+		, m_SkyviewComputePipeline
+		, m_SkyviewBakePipeline
+		, m_OpticalDepthPipeline
+	};
+	m_Context.DeletionQueue.Push([pipelines, this]
+	{
+		for (VkPipeline const pipeline: pipelines)
+			m_Context.DispatchTable.destroyPipeline(pipeline, nullptr);
+	});
 }
 
-void App::RecordCommandBuffer(vkc::CommandBuffer& commandBuffer, size_t imageIndex)
+void App::DispatchLUT
+(
+	vkc::CommandBuffer&     commandBuffer
+	, vkc::Image&           image
+	, VkPipeline            pipeline
+	, vkc::DescriptorSet&   descriptorSet
+	, VkPipelineStageFlags2        readerStages
+	, std::span<SkyviewRows const> rows
+)
 {
-	commandBuffer.Begin(m_Context);
-	vkc::Image& swapchainImage = m_SwapchainImages[imageIndex];
-	// swapchain image to attachment optimal
+	//
 	{
 		vkc::Image::Transition transition{};
 		//
 		{
 			transition.SrcAccessMask = VK_ACCESS_2_NONE;
-			transition.DstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_NONE;
-			transition.DstStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
-			transition.NewLayout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+			transition.DstAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+			transition.SrcStageMask  = readerStages | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT; // previous reads must finish before overwriting
+			transition.DstStageMask  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+			transition.NewLayout     = VK_IMAGE_LAYOUT_GENERAL;
 		}
-		swapchainImage.MakeTransition(m_Context, commandBuffer, transition);
+		image.MakeTransition(m_Context, commandBuffer, transition);
 	}
-	// depth image to attachment optimal
+
+	m_Context.DispatchTable.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
+	m_Context.DispatchTable.cmdBindDescriptorSets(commandBuffer
+												  , VK_PIPELINE_BIND_POINT_COMPUTE
+												  , *m_ComputePipelineLayout
+												  , 0
+												  , 1
+												  , descriptorSet
+												  , 0
+												  , nullptr);
+
+	// matches local_size of the LUT compute shaders
+	uint32_t constexpr groupSize{ 8 };
+	if (rows.empty())
+		m_Context.DispatchTable.cmdDispatch(commandBuffer
+											, (image.GetExtent().width + groupSize - 1) / groupSize
+											, (image.GetExtent().height + groupSize - 1) / groupSize
+											, 1);
+	// only the sky-view shader reads RowOffset, the group rounding may redraw a few rows of the next band
+	for (SkyviewRows const& band: rows)
+	{
+		m_Context.DispatchTable.cmdPushConstants(commandBuffer
+												 , *m_ComputePipelineLayout
+												 , VK_SHADER_STAGE_COMPUTE_BIT
+												 , sizeof(glm::vec3) * 2 + sizeof(float) * 3
+												 , sizeof(band.First)
+												 , &band.First);
+		m_Context.DispatchTable.cmdDispatch(commandBuffer
+											, (image.GetExtent().width + groupSize - 1) / groupSize
+											, (band.Count + groupSize - 1) / groupSize
+											, 1);
+	}
+	// leave the LUT readable so later passes need no extra barrier
 	{
 		vkc::Image::Transition transition{};
 		//
 		{
-			transition.SrcAccessMask = VK_ACCESS_2_NONE;
-			transition.DstAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_NONE;
-			transition.DstStageMask  = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT;
-			transition.NewLayout     = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
+			transition.SrcAccessMask = VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT;
+			transition.DstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+			transition.DstStageMask  = readerStages | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+			transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 		}
-		m_DepthImage->MakeTransition(m_Context, commandBuffer, transition);
+		image.MakeTransition(m_Context, commandBuffer, transition);
 	}
-	//
-	{
-		VkRenderingAttachmentInfo renderingAttachmentInfo{};
-		renderingAttachmentInfo.sType       = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
-		renderingAttachmentInfo.clearValue  = { { .03f, .03f, .03f, 1.f } };
-		renderingAttachmentInfo.imageLayout = m_SwapchainImages[imageIndex].GetLayout();
-		renderingAttachmentInfo.imageView   = m_SwapchainImageViews[imageIndex];
-		renderingAttachmentInfo.loadOp      = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		renderingAttachmentInfo.storeOp     = VK_ATTACHMENT_STORE_OP_STORE;
-
-		VkRenderingAttachmentInfo depthAttachmentInfo{};
-		depthAttachmentInfo.sType       = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
-		depthAttachmentInfo.clearValue  = { .depthStencil = { 1.0f, 0 } };
-		depthAttachmentInfo.imageLayout = m_DepthImage->GetLayout();
-		depthAttachmentInfo.imageView   = *m_DepthImageView;
-		depthAttachmentInfo.loadOp      = VK_ATTACHMENT_LOAD_OP_CLEAR;
-		depthAttachmentInfo.storeOp     = VK_ATTACHMENT_STORE_OP_STORE;
+}
 
-		VkRenderingInfo renderingInfo{};
-		renderingInfo.sType                = VK_STRUCTURE_TYPE_RENDERING_INFO;
-		renderingInfo.colorAttachmentCount = 1;
-		renderingInfo.pColorAttachments    = &renderingAttachmentInfo;
-		renderingInfo.pDepthAttachment     = &depthAttachmentInfo;
-		renderingInfo.layerCount           = 1;
-		renderingInfo.renderArea           = VkRect2D{ {}, m_Context.Swapchain.extent };
+void App::GenerateTransmittanceLUTCompute(vkc::CommandBuffer& commandBuffer)
+{
+	DispatchLUT(commandBuffer
+				, *m_TransmittanceImage
+				, m_TransmittanceComputePipeline
+				, m_ComputeDescriptorSets[0]
+				, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT);
+}
 
-		m_Context.DispatchTable.cmdBeginRendering(commandBuffer, &renderingInfo);
-		// main pass
-		{
-			m_Context.DispatchTable.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, *m_Pipeline);
-			m_Context.DispatchTable.cmdBindDescriptorSets(commandBuffer
-														  , VK_PIPELINE_BIND_POINT_GRAPHICS
-														  , *m_PipelineLayout
-														  , 0
-														  , 1
-														  , m_FrameDescriptorSets[m_CurrentFrame]
-														  , 0
-														  , nullptr);
+void App::GenerateMultScatteringLUTCompute(vkc::CommandBuffer& commandBuffer)
+{
+	DispatchLUT(commandBuffer
+				, *m_MultScatteringImage
+				, m_MultScatteringComputePipeline
+				, m_ComputeDescriptorSets[1]
+				, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT);
+}
 
-			VkDeviceSize offsets[] = { {} };
-			m_Context.DispatchTable.cmdBindVertexBuffers(commandBuffer
-														 , 0
-														 , 1
-														 , *m_VertexBuffer
-														 , offsets);
+void App::GenerateOpticalDepthLUT(vkc::CommandBuffer& commandBuffer)
+{
+	DispatchLUT(commandBuffer
+				, *m_OpticalDepthImage
+				, m_OpticalDepthPipeline
+				, m_ComputeDescriptorSets[6]
+				, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT);
+}
 
-			VkViewport viewport{};
-			viewport.width    = static_cast<float>(m_Context.Swapchain.extent.width);
-			viewport.height   = static_cast<float>(m_Context.Swapchain.extent.height);
-			viewport.minDepth = 0.0f;
-			viewport.maxDepth = 1.0f;
+void App::GenerateSkyviewLUTCompute
+(vkc::CommandBuffer& commandBuffer, VkPipelineStageFlags2 readerStages, std::span<SkyviewRows const> rows)
+{
+	PushComputeConstants(commandBuffer);
+	DispatchLUT(commandBuffer, *m_SkyviewImage, m_SkyviewComputePipeline, m_ComputeDescriptorSets[2], readerStages, rows);
+}
 
-			m_Context.DispatchTable.cmdSetViewport(commandBuffer, 0, 1, &viewport);
+void App::PushComputeConstants(vkc::CommandBuffer& commandBuffer) const
+{
+	struct PushConstant
+	{
+		glm::vec3 CameraPosition;
+		float     Fov;
+		glm::vec3 CameraForward;
+		float     AspectRatio;
+		float     Time;
+		uint32_t  RowOffset; // first sky-view row, DispatchLUT overrides it per band
+	};
+	PushConstant pushConstant
+	{
+		m_Camera->GetPosition(), tan(glm::radians(m_Camera->GetFov() * .5f)), m_Camera->GetForward(), m_Camera->GetAspectRatio()
+		, GetSceneTime(), 0
+	};
 
-			VkRect2D scissor{};
-			scissor.offset = { 0, 0 };
-			scissor.extent = m_Context.Swapchain.extent;
+	m_Context.DispatchTable.cmdPushConstants(commandBuffer
+											 , *m_ComputePipelineLayout
+											 , VK_SHADER_STAGE_COMPUTE_BIT
+											 , 0
+											 , sizeof(pushConstant)
+											 , &pushConstant);
+}
 
-			m_Context.DispatchTable.cmdSetScissor(commandBuffer, 0, 1, &scissor);
+void App::GenerateAerialPerspective(vkc::CommandBuffer& commandBuffer)
+{
+	// previous frame's geometry pass must finish sampling before overwriting
+	m_AerialPerspectiveImage->MakeTransition(m_Context
+											 , commandBuffer
+											 , VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT
+											 , VK_ACCESS_2_NONE
+											 , VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT
+											 , VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT
+											 , VK_IMAGE_LAYOUT_GENERAL);
+
+	PushComputeConstants(commandBuffer);
+	m_Context.DispatchTable.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_AerialPerspectivePipeline);
+	m_Context.DispatchTable.cmdBindDescriptorSets(commandBuffer
+												  , VK_PIPELINE_BIND_POINT_COMPUTE
+												  , *m_ComputePipelineLayout
+												  , 0
+												  , 1
+												  , m_ComputeDescriptorSets[3]
+												  , 0
+												  , nullptr);
+
+	// slices are walked inside the shader, one invocation per column
+	uint32_t constexpr groupSize{ 8 };
+	VkExtent3D const   extent{ m_AerialPerspectiveImage->GetExtent() };
+	m_Context.DispatchTable.cmdDispatch(commandBuffer
+										, (extent.width + groupSize - 1) / groupSize
+										, (extent.height + groupSize - 1) / groupSize
+										, 1);
+
+	m_AerialPerspectiveImage->MakeTransition(m_Context
+											 , commandBuffer
+											 , VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT
+											 , VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT
+											 , VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT
+											 , VK_ACCESS_2_SHADER_READ_BIT
+											 , VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
 
-			m_Context.DispatchTable.cmdDraw(commandBuffer, static_cast<uint32_t>(m_VertexBuffer->GetSize() / sizeof(Vertex)), 1, 0, 0);
+void App::RecordSkyviewLUT(vkc::CommandBuffer& commandBuffer, std::span<SkyviewRows const> rows)
+{
+	if (IsSkyviewArrayCurrent())
+		ResolveSkyviewArray(commandBuffer, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT);
+	else if (m_ComputeLUTs)
+		GenerateSkyviewLUTCompute(commandBuffer, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, rows);
+	else
+		GenerateSkyviewLUT(commandBuffer, rows);
+}
+
+void App::UpdateSkyviewArray()
+{
+	if (!m_SkyviewArrayImage)
+		return;
+	if (std::abs(m_Camera->GetPosition().y - m_SkyviewArrayAltitude) > SKYVIEW_MAX_ALTITUDE_DRIFT)
+		m_SkyviewArrayDirty = true;
+	if (!m_SkyviewArrayDirty)
+		return;
+
+	// frames in flight may still resolve from the old array
+	if (auto const result = m_Context.DispatchTable.deviceWaitIdle();
+		result != VK_SUCCESS)
+		throw std::runtime_error("Failed to wait for device to be idle");
+
+	// baked on the queue that resolves it, so the array never changes queue ownership
+	VkQueue const       queue{ m_ComputeQueue ? m_ComputeQueue : m_Context.GraphicsQueue };
+	vkc::CommandBuffer& commandBuffer = (m_ComputeQueue ? *m_ComputeCommandPool : *m_CommandPool).AllocateCommandBuffer(m_Context);
+	m_Context.DispatchTable.resetFences(1, &commandBuffer.GetFence());
+	commandBuffer.Begin(m_Context);
+	m_QueryPool->Reset(commandBuffer);
+	m_QueryPool->RecordWholePipe(commandBuffer
+								 , "sky-view array"
+								 , 0
+								 , [this](vkc::CommandBuffer& cmd)
+								 {
+									 BakeSkyviewArray(cmd);
+								 }
+								 , commandBuffer);
+	commandBuffer.End(m_Context);
+	commandBuffer.Submit(m_Context, queue, {}, {});
+	if (auto const result = m_Context.DispatchTable.waitForFences(1, &commandBuffer.GetFence(), VK_TRUE, UINT64_MAX);
+		result != VK_SUCCESS)
+		throw std::runtime_error("Failed to wait for a fence");
+
+	Timings timings;
+	m_QueryPool->GetResults(m_Context, timings);
+	for (auto const& timing: timings | std::views::values)
+		std::cout << timing.GetLabel() << " of " << m_SkyviewArrayImage->GetLayerCount() << " sun elevations baked in "
+				<< timing.GetDuration() << " ms" << std::endl;
+
+	m_SkyviewArrayAltitude = m_Camera->GetPosition().y;
+	m_SkyviewArrayDirty    = false;
+}
+
+bool App::IsSkyviewArrayCurrent() const
+{
+	return m_SkyviewArrayImage && !m_SkyviewArrayDirty &&
+		   std::abs(m_Camera->GetPosition().y - m_SkyviewArrayAltitude) <= SKYVIEW_MAX_ALTITUDE_DRIFT;
+}
+
+void App::BakeSkyviewArray(vkc::CommandBuffer& commandBuffer)
+{
+	m_SkyviewArrayImage->MakeTransition(m_Context
+										, commandBuffer
+										, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT
+										, VK_ACCESS_2_NONE
+										, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT
+										, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT
+										, VK_IMAGE_LAYOUT_GENERAL);
+
+	// only the camera position is used, the slice index replaces the time
+	PushComputeConstants(commandBuffer);
+	m_Context.DispatchTable.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_SkyviewBakePipeline);
+	m_Context.DispatchTable.cmdBindDescriptorSets(commandBuffer
+												  , VK_PIPELINE_BIND_POINT_COMPUTE
+												  , *m_ComputePipelineLayout
+												  , 0
+												  , 1
+												  , m_ComputeDescriptorSets[4]
+												  , 0
+												  , nullptr);
+
+	uint32_t constexpr groupSize{ 8 };
+	VkExtent3D const   extent{ m_SkyviewArrayImage->GetExtent() };
+	m_Context.DispatchTable.cmdDispatch(commandBuffer
+										, (extent.width + groupSize - 1) / groupSize
+										, (extent.height + groupSize - 1) / groupSize
+										, m_SkyviewArrayImage->GetLayerCount());
+
+	m_SkyviewArrayImage->MakeTransition(m_Context
+										, commandBuffer
+										, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT
+										, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT
+										, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT
+										, VK_ACCESS_2_SHADER_READ_BIT
+										, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+}
+
+void App::ResolveSkyviewArray(vkc::CommandBuffer& commandBuffer, VkPipelineStageFlags2 readerStages)
+{
+	PushComputeConstants(commandBuffer);
+	DispatchLUT(commandBuffer, *m_SkyviewImage, m_SkyviewResolvePipeline, m_ComputeDescriptorSets[5], readerStages);
+}
+
+void App::TransferSkyviewOwnership(vkc::CommandBuffer& commandBuffer, bool toGraphics, bool release)
+{
+	// the LUT stays in read only layout while it changes queues, DispatchLUT moves it to general on the compute queue
+	// going back to compute nothing was written, the writes of the next update are ordered by DispatchLUT
+	VkPipelineStageFlags2 const producerStage{ toGraphics ? VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT : VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT };
+	VkAccessFlags2 const        producerAccess{ toGraphics ? VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT : VK_ACCESS_2_NONE };
+	VkPipelineStageFlags2 const consumerStage{ toGraphics ? VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT : VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT };
+	VkAccessFlags2 const        consumerAccess{ toGraphics ? VK_ACCESS_2_SHADER_READ_BIT : VK_ACCESS_2_NONE };
+
+	VkImageMemoryBarrier2 barrier{};
+	barrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+	barrier.srcStageMask        = release ? producerStage : VK_PIPELINE_STAGE_2_NONE;
+	barrier.srcAccessMask       = release ? producerAccess : VK_ACCESS_2_NONE;
+	barrier.dstStageMask        = release ? VK_PIPELINE_STAGE_2_NONE : consumerStage;
+	barrier.dstAccessMask       = release ? VK_ACCESS_2_NONE : consumerAccess;
+	barrier.oldLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.newLayout           = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.srcQueueFamilyIndex = toGraphics ? m_ComputeQueueFamily : m_GraphicsQueueFamily;
+	barrier.dstQueueFamilyIndex = toGraphics ? m_GraphicsQueueFamily : m_ComputeQueueFamily;
+	barrier.image               = *m_SkyviewImage;
+	barrier.subresourceRange    = VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+
+	VkDependencyInfo dependencyInfo{};
+	dependencyInfo.sType                   = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	dependencyInfo.imageMemoryBarrierCount = 1;
+	dependencyInfo.pImageMemoryBarriers    = &barrier;
+	m_Context.DispatchTable.cmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+}
+
+void App::InvalidateStaticLUTs()
+{
+	m_StaticLUTsDirty   = true;
+	m_SkyviewArrayDirty = true;
+	// the sky-view LUT samples both, kept bands would mix old and new LUTs
+	if (m_SkyviewSchedule)
+		m_SkyviewSchedule->Invalidate();
+}
+
+void App::UpdateStaticLUTs()
+{
+	if (!m_StaticLUTsDirty)
+		return;
+
+	// frames in flight may still sample the old LUTs
+	if (auto const result = m_Context.DispatchTable.deviceWaitIdle();
+		result != VK_SUCCESS)
+		throw std::runtime_error("Failed to wait for device to be idle");
+
+	// the LUT cache key only covers the GPU paths, CPU LUTs are baked every time
+	if (m_Options.LUTs == LUTPath::Cpu)
+	{
+		BakedLUTs const luts{ BakeStaticLUTsOnCpu(0) };
+		UploadStaticLUTs(std::as_bytes(std::span{ luts.Transmittance }), std::as_bytes(std::span{ luts.MultScattering }));
+		std::cout << "static LUTs baked on " << luts.ThreadCount << " CPU threads in "
+				<< luts.TransmittanceMilliseconds + luts.MultScatteringMilliseconds << " ms" << std::endl;
+		m_LUTCacheHit     = false;
+		m_StaticLUTsDirty = false;
+		return;
+	}
+
+	size_t const   transmittanceSize{ GetLUTByteSize(*m_TransmittanceImage) };
+	size_t const   multScatteringSize{ GetLUTByteSize(*m_MultScatteringImage) };
+	bool const     useCache{ !m_Options.LUTCachePath.empty() };
+	uint64_t const cacheKey{ useCache ? CalculateLUTCacheKey() : 0 };
+
+	if (useCache)
+	{
+		if (std::optional<LUTCacheEntry> const entry = LoadLUTCache(m_Options.LUTCachePath, cacheKey, transmittanceSize, multScatteringSize))
+		{
+			UploadStaticLUTs(entry->Transmittance, entry->MultScattering);
+			std::cout << "static LUTs loaded from " << m_Options.LUTCachePath << std::endl;
+			m_LUTCacheHit     = true;
+			m_StaticLUTsDirty = false;
+			return;
 		}
-		m_Context.DispatchTable.cmdEndRendering(commandBuffer);
 	}
 
-	GenerateTransmittanceLUT(commandBuffer);
-	GenerateMultScatteringLUT(commandBuffer);
-	GenerateSkyviewLUT(commandBuffer);
+	// only read back when there is a cache to write them to
+	uptr<vkc::Buffer> readbackBuffer{};
+	if (useCache)
+	{
+		vkc::BufferBuilder readbackBuilder{ m_Context };
+		vkc::Buffer        buffer = readbackBuilder
+							   .SetRequiredMemoryFlags(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+							   .MapMemory()
+							   .Build(VK_BUFFER_USAGE_TRANSFER_DST_BIT, transmittanceSize + multScatteringSize, false);
+		readbackBuffer = std::make_unique<vkc::Buffer>(std::move(buffer));
+	}
+
+	vkc::CommandBuffer& commandBuffer = m_CommandPool->AllocateCommandBuffer(m_Context);
+	m_Context.DispatchTable.resetFences(1, &commandBuffer.GetFence());
+	commandBuffer.Begin(m_Context);
+	m_QueryPool->Reset(commandBuffer);
+	m_QueryPool->RecordWholePipe(commandBuffer
+								 , "transmittance LUT"
+								 , 0
+								 , [this](vkc::CommandBuffer& cmd)
+								 {
+									 if (m_ComputeLUTs)
+										 GenerateTransmittanceLUTCompute(cmd);
+									 else
+										 GenerateTransmittanceLUT(cmd);
+								 }
+								 , commandBuffer);
+	m_QueryPool->RecordWholePipe(commandBuffer
+								 , "multiple scattering LUT"
+								 , 1
+								 , [this](vkc::CommandBuffer& cmd)
+								 {
+									 if (m_ComputeLUTs)
+										 GenerateMultScatteringLUTCompute(cmd);
+									 else
+										 GenerateMultScatteringLUT(cmd);
+								 }
+								 , commandBuffer);
+	m_QueryPool->RecordWholePipe(commandBuffer
+								 , "optical depth LUT"
+								 , 2
+								 , [this](vkc::CommandBuffer& cmd)
+								 {
+									 GenerateOpticalDepthLUT(cmd);
+								 }
+								 , commandBuffer);
+	if (readbackBuffer)
+	{
+		CopyLUTToBuffer(commandBuffer, *m_TransmittanceImage, *readbackBuffer, 0);
+		CopyLUTToBuffer(commandBuffer, *m_MultScatteringImage, *readbackBuffer, transmittanceSize);
+	}
+	commandBuffer.End(m_Context);
+	commandBuffer.Submit(m_Context, m_Context.GraphicsQueue, {}, {});
+	if (auto const result = m_Context.DispatchTable.waitForFences(1, &commandBuffer.GetFence(), VK_TRUE, UINT64_MAX);
+		result != VK_SUCCESS)
+		throw std::runtime_error("Failed to wait for a fence");
+
+	Timings timings;
+	m_QueryPool->GetResults(m_Context, timings);
+	for (auto const& timing: timings | std::views::values)
+		std::cout << timing.GetLabel() << " rebuilt in " << timing.GetDuration() << " ms" << std::endl;
+
+	if (readbackBuffer)
+	{
+		auto const* texels = static_cast<std::byte const*>(readbackBuffer->GetMappedData());
+		SaveLUTCache(m_Options.LUTCachePath
+					 , cacheKey
+					 , { texels, transmittanceSize }
+					 , { texels + transmittanceSize, multScatteringSize });
+		readbackBuffer->Destroy(m_Context);
+	}
+
+	m_LUTCacheHit     = false;
+	m_StaticLUTsDirty = false;
+}
+
+std::array<uint32_t, 8> App::GetSpecializationConstants() const
+{
+	QualitySettings const& quality{ m_Options.Quality };
+	return {
+		static_cast<uint32_t>(m_Spectral)
+		, quality.OpticalDepthSamples
+		, quality.MultipleScatteringSamples
+		, quality.ScatteringSamples
+		, quality.SqrtSamples
+		, static_cast<uint32_t>(quality.AdaptiveScattering)
+		, static_cast<uint32_t>(m_Options.Mode == Command::Sweep)
+		, static_cast<uint32_t>(quality.OpticalDepthLUT)
+	};
+}
+
+void App::AddSpecializationConstants(vkc::ShaderStage& stage) const
+{
+	for (uint32_t const constant: GetSpecializationConstants())
+		stage.AddSpecializationConstant(constant);
+}
+
+uint64_t App::CalculateLUTCacheKey() const
+{
+	// atmosphere and spectral constants are compiled into the shader binaries, hashing those covers them
+	// sample counts are specialized at pipeline creation and hashed on their own
+	uint64_t key{ HashValue(m_Spectral) };
+	key = HashValue(m_ComputeLUTs, key);
+	key = HashValue(m_Options.Quality.OpticalDepthSamples, key);
+	key = HashValue(m_Options.Quality.MultipleScatteringSamples, key);
+	key = HashValue(m_Options.Quality.SqrtSamples, key);
+	std::vector<char const*> const shaders{
+		m_ComputeLUTs
+		? std::vector<char const*>{ "transmittanceLUT_compute", "multiple_scattering_compute" }
+		: std::vector<char const*>{ "fsquad", "transmittanceLUT", "multiple_scattering" }
+	};
+	for (char const* shader: shaders)
+		key = HashBytes(std::as_bytes(GetEmbeddedShader(shader)), key);
+	for (vkc::Image const* image: { m_TransmittanceImage.get(), m_MultScatteringImage.get() })
+	{
+		key = HashValue(image->GetExtent(), key);
+		key = HashValue(image->GetFormat(), key);
+	}
+	return key;
+}
+
+BakedLUTs App::BakeStaticLUTsOnCpu(uint32_t threadCount) const
+{
+	auto const size = [](vkc::Image const& image) { return LUTSize{ image.GetExtent().width, image.GetExtent().height }; };
+	// the counts of the active tier, the same the GPU passes are specialized with
+	LUTSamples const samples{ m_Options.Quality.OpticalDepthSamples, m_Options.Quality.MultipleScatteringSamples, m_Options.Quality.SqrtSamples };
+	return BakeStaticLUTs(m_Spectral, samples, size(*m_TransmittanceImage), size(*m_MultScatteringImage), threadCount);
+}
+
+size_t App::GetLUTByteSize(vkc::Image const& image)
+{
+	size_t constexpr texelSize{ 8 }; // both static LUTs use 16 bit RGBA formats
+	return static_cast<size_t>(image.GetExtent().width) * image.GetExtent().height * texelSize;
+}
+
+void App::CopyLUTToBuffer(vkc::CommandBuffer& commandBuffer, vkc::Image& image, vkc::Buffer& buffer, VkDeviceSize offset)
+{
 	//
 	{
 		vkc::Image::Transition transition{};
 		//
 		{
-			transition.SrcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			transition.DstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
-			transition.DstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
-			transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			transition.SrcAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+			transition.DstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT |
+									   VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+			transition.DstStageMask  = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+			transition.NewLayout     = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
 		}
-		m_TransmittanceImage->MakeTransition(m_Context, commandBuffer, transition);
-		m_MultScatteringImage->MakeTransition(m_Context, commandBuffer, transition);
+		image.MakeTransition(m_Context, commandBuffer, transition);
 	}
+
+	VkBufferImageCopy bufferCopy{};
+	bufferCopy.bufferOffset                = offset;
+	bufferCopy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	bufferCopy.imageSubresource.layerCount = 1;
+	bufferCopy.imageExtent                 = VkExtent3D{ image.GetExtent().width, image.GetExtent().height, 1 };
+	m_Context.DispatchTable.cmdCopyImageToBuffer(commandBuffer, image, image.GetLayout(), buffer, 1, &bufferCopy);
+
 	//
 	{
 		vkc::Image::Transition transition{};
 		//
 		{
-			transition.SrcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			transition.DstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
-			transition.DstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+			transition.SrcAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT;
+			transition.DstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+			transition.DstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
 			transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
 		}
-		m_SkyviewImage->MakeTransition(m_Context, commandBuffer, transition);
+		image.MakeTransition(m_Context, commandBuffer, transition);
+	}
+	//
+	{
+		VkBufferMemoryBarrier barrier{};
+		barrier.sType               = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+		barrier.srcAccessMask       = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask       = VK_ACCESS_HOST_READ_BIT;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.buffer              = buffer;
+		barrier.offset              = 0;
+		barrier.size                = VK_WHOLE_SIZE;
+		m_Context.DispatchTable.cmdPipelineBarrier(commandBuffer
+												   , VK_PIPELINE_STAGE_TRANSFER_BIT
+												   , VK_PIPELINE_STAGE_HOST_BIT
+												   , 0
+												   , 0
+												   , nullptr
+												   , 1
+												   , &barrier
+												   , 0
+												   , nullptr);
+	}
+}
+
+void App::UploadStaticLUTs(std::span<std::byte const> transmittance, std::span<std::byte const> multScattering)
+{
+	vkc::BufferBuilder stagingBuilder{ m_Context };
+	vkc::Buffer        stagingBuffer = stagingBuilder
+								.SetRequiredMemoryFlags(VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT)
+								.MapMemory()
+								.Build(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, transmittance.size() + multScattering.size(), false);
+	auto* staging = static_cast<std::byte*>(stagingBuffer.GetMappedData());
+	std::memcpy(staging, transmittance.data(), transmittance.size());
+	std::memcpy(staging + transmittance.size(), multScattering.data(), multScattering.size());
+
+	vkc::CommandBuffer& commandBuffer = m_CommandPool->AllocateCommandBuffer(m_Context);
+	m_Context.DispatchTable.resetFences(1, &commandBuffer.GetFence());
+	commandBuffer.Begin(m_Context);
+
+	VkDeviceSize offset{};
+	for (vkc::Image* image: { m_TransmittanceImage.get(), m_MultScatteringImage.get() })
+	{
+		//
+		{
+			vkc::Image::Transition transition{};
+			//
+			{
+				transition.SrcAccessMask = VK_ACCESS_2_NONE;
+				transition.DstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+				transition.SrcStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+				transition.DstStageMask  = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+				transition.NewLayout     = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			}
+			image->MakeTransition(m_Context, commandBuffer, transition);
+		}
+
+		VkBufferImageCopy bufferCopy{};
+		bufferCopy.bufferOffset                = offset;
+		bufferCopy.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		bufferCopy.imageSubresource.layerCount = 1;
+		bufferCopy.imageExtent                 = VkExtent3D{ image->GetExtent().width, image->GetExtent().height, 1 };
+		m_Context.DispatchTable.cmdCopyBufferToImage(commandBuffer, stagingBuffer, *image, image->GetLayout(), 1, &bufferCopy);
+		offset += GetLUTByteSize(*image);
+
+		//
+		{
+			vkc::Image::Transition transition{};
+			//
+			{
+				transition.SrcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+				transition.DstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+				transition.SrcStageMask  = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
+				transition.DstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT;
+				transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			}
+			image->MakeTransition(m_Context, commandBuffer, transition);
+		}
 	}
+	// the optical depth LUT is neither baked nor cached, it is cheap enough to regenerate with every upload
+	GenerateOpticalDepthLUT(commandBuffer);
+
+	commandBuffer.End(m_Context);
+	commandBuffer.Submit(m_Context, m_Context.GraphicsQueue, {}, {});
+	if (auto const result = m_Context.DispatchTable.waitForFences(1, &commandBuffer.GetFence(), VK_TRUE, UINT64_MAX);
+		result != VK_SUCCESS)
+		throw std::runtime_error("Failed to wait for a fence");
+
+	stagingBuffer.Destroy(m_Context);
+}
+
+void App::ReportFirstPixel()
+{
+	if (m_FirstPixelReported)
+		return;
+
+	m_FirstPixelReported = true;
+	double const milliseconds{ std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_StartTime).count() };
+	std::cout << "startup to first pixel: " << milliseconds << " ms (LUT cache " << (m_LUTCacheHit ? "hit" : "miss") << ")" << std::endl;
+}
+
+void App::RecreateSwapchain()
+{
+	if (auto const result = m_Context.DispatchTable.deviceWaitIdle();
+		result != VK_SUCCESS)
+		throw std::runtime_error("Failed to wait for device to be idle");
+
+	std::vector<VkImageView> views;
+	views.reserve(m_SwapchainImageViews.size());
+	for (uint32_t index{}; index < m_SwapchainImageViews.size(); ++index)
+		views.emplace_back(m_SwapchainImageViews[index]);
+	m_Context.Swapchain.destroy_image_views(views);
+
+	m_DepthImage->Destroy(m_Context);
+	m_DepthImageView->Destroy(m_Context);
+	DestroyLowResSky();
+
+	CreateSwapchain();
+	CreateDepth();
+	CreateLowResSky();
+	// every tier samples the same render targets
+	WriteRenderTargetDescriptors(m_FrameDescriptorSets);
+	for (TierResources& tier: m_Tiers)
+		WriteRenderTargetDescriptors(tier.FrameDescriptorSets);
+	m_Camera->SetNewAspectRatio(static_cast<float>(m_RenderExtent.width)
+								/ m_RenderExtent.height); // NOLINT(*-narrowing-conversions)
+}
+
+void App::RecordCommandBuffer(vkc::CommandBuffer& commandBuffer, size_t imageIndex, std::span<SkyviewRows const> skyviewRows)
+{
+	commandBuffer.Begin(m_Context);
+	if (m_FrameTimer)
+		m_FrameTimer->BeginFrame(m_Context, commandBuffer, m_CurrentFrame);
+	FrameTimer* const timer{ m_FrameTimer.get() };
+	RecordTimed(timer, commandBuffer, m_FrameScopes.AerialPerspective, [&] { GenerateAerialPerspective(commandBuffer); });
+	RecordTimed(timer, commandBuffer, m_FrameScopes.Geometry, [&] { RecordGeometryPass(commandBuffer, imageIndex); });
+	// transmittance and multiple scattering LUTs are static, see UpdateStaticLUTs
+	RecordTimed(timer, commandBuffer, m_FrameScopes.SkyviewLUT, [&] { RecordSkyviewLUT(commandBuffer, skyviewRows); });
+	RecordTimed(timer, commandBuffer, m_FrameScopes.Sky, [&] { RecordSkyPass(commandBuffer, imageIndex); });
+	commandBuffer.End(m_Context);
+}
+
+void App::RecordGeometryPass(vkc::CommandBuffer& commandBuffer, size_t imageIndex)
+{
+	vkc::Image& swapchainImage = m_SwapchainImages[imageIndex];
 	// swapchain image to attachment optimal
 	{
 		vkc::Image::Transition transition{};
 		//
 		{
-			transition.SrcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+			transition.SrcAccessMask = VK_ACCESS_2_NONE;
 			transition.DstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_NONE;
 			transition.DstStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
 			transition.NewLayout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 		}
@@ -1427,11 +3621,11 @@ void App::RecordCommandBuffer(vkc::CommandBuffer& commandBuffer, size_t imageInd
 		vkc::Image::Transition transition{};
 		//
 		{
-			transition.SrcAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-			transition.DstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
-			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
-			transition.DstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
-			transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+			transition.SrcAccessMask = VK_ACCESS_2_NONE;
+			transition.DstAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_NONE;
+			transition.DstStageMask  = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT;
+			transition.NewLayout     = VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
 		}
 		m_DepthImage->MakeTransition(m_Context, commandBuffer, transition);
 	}
@@ -1442,20 +3636,29 @@ void App::RecordCommandBuffer(vkc::CommandBuffer& commandBuffer, size_t imageInd
 		renderingAttachmentInfo.clearValue  = { { .03f, .03f, .03f, 1.f } };
 		renderingAttachmentInfo.imageLayout = m_SwapchainImages[imageIndex].GetLayout();
 		renderingAttachmentInfo.imageView   = m_SwapchainImageViews[imageIndex];
-		renderingAttachmentInfo.loadOp      = VK_ATTACHMENT_LOAD_OP_LOAD;
+		renderingAttachmentInfo.loadOp      = VK_ATTACHMENT_LOAD_OP_CLEAR;
 		renderingAttachmentInfo.storeOp     = VK_ATTACHMENT_STORE_OP_STORE;
 
+		VkRenderingAttachmentInfo depthAttachmentInfo{};
+		depthAttachmentInfo.sType       = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+		depthAttachmentInfo.clearValue  = { .depthStencil = { 1.0f, 0 } };
+		depthAttachmentInfo.imageLayout = m_DepthImage->GetLayout();
+		depthAttachmentInfo.imageView   = *m_DepthImageView;
+		depthAttachmentInfo.loadOp      = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		depthAttachmentInfo.storeOp     = VK_ATTACHMENT_STORE_OP_STORE;
+
 		VkRenderingInfo renderingInfo{};
 		renderingInfo.sType                = VK_STRUCTURE_TYPE_RENDERING_INFO;
 		renderingInfo.colorAttachmentCount = 1;
 		renderingInfo.pColorAttachments    = &renderingAttachmentInfo;
+		renderingInfo.pDepthAttachment     = &depthAttachmentInfo;
 		renderingInfo.layerCount           = 1;
-		renderingInfo.renderArea           = VkRect2D{ {}, m_Context.Swapchain.extent };
+		renderingInfo.renderArea           = VkRect2D{ {}, m_RenderExtent };
 
 		m_Context.DispatchTable.cmdBeginRendering(commandBuffer, &renderingInfo);
-		//
+		// main pass
 		{
-			m_Context.DispatchTable.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, *m_SkyRenderPipeline);
+			m_Context.DispatchTable.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, *m_Pipeline);
 			m_Context.DispatchTable.cmdBindDescriptorSets(commandBuffer
 														  , VK_PIPELINE_BIND_POINT_GRAPHICS
 														  , *m_PipelineLayout
@@ -1465,9 +3668,16 @@ void App::RecordCommandBuffer(vkc::CommandBuffer& commandBuffer, size_t imageInd
 														  , 0
 														  , nullptr);
 
+			VkDeviceSize offsets[] = { {} };
+			m_Context.DispatchTable.cmdBindVertexBuffers(commandBuffer
+														 , 0
+														 , 1
+														 , *m_VertexBuffer
+														 , offsets);
+
 			VkViewport viewport{};
-			viewport.width    = static_cast<float>(m_Context.Swapchain.extent.width);
-			viewport.height   = static_cast<float>(m_Context.Swapchain.extent.height);
+			viewport.width    = static_cast<float>(m_RenderExtent.width);
+			viewport.height   = static_cast<float>(m_RenderExtent.height);
 			viewport.minDepth = 0.0f;
 			viewport.maxDepth = 1.0f;
 
@@ -1475,35 +3685,64 @@ void App::RecordCommandBuffer(vkc::CommandBuffer& commandBuffer, size_t imageInd
 
 			VkRect2D scissor{};
 			scissor.offset = { 0, 0 };
-			scissor.extent = m_Context.Swapchain.extent;
-			m_Context.DispatchTable.cmdSetScissor(commandBuffer, 0, 1, &scissor);
+			scissor.extent = m_RenderExtent;
 
-			struct PushConstant
-			{
-				glm::vec3 CameraPosition;
-				float     Fov;
-				glm::vec3 CameraForward;
-				float     AspectRatio;
-				float     Time;
-				uint32_t  UseSkyView;
-			};
-			PushConstant pushConstant
-			{
-				m_Camera->GetPosition(), tan(glm::radians(m_Camera->GetFov() * .5f)), m_Camera->GetForward(), m_Camera->GetAspectRatio()
-				, world_time::GetRunTime(), m_UseSkyview
-			};
-
-			m_Context.DispatchTable.cmdPushConstants(commandBuffer
-													 , *m_PipelineLayout
-													 , VK_SHADER_STAGE_FRAGMENT_BIT
-													 , 0
-													 , sizeof(pushConstant)
-													 , &pushConstant);
+			m_Context.DispatchTable.cmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-			m_Context.DispatchTable.cmdDraw(commandBuffer, 3, 1, 0, 0);
+			m_Context.DispatchTable.cmdDraw(commandBuffer, static_cast<uint32_t>(m_VertexBuffer->GetSize() / sizeof(Vertex)), 1, 0, 0);
 		}
 		m_Context.DispatchTable.cmdEndRendering(commandBuffer);
 	}
+}
+
+void App::RecordSkyPass(vkc::CommandBuffer& commandBuffer, size_t imageIndex)
+{
+	vkc::Image& swapchainImage = m_SwapchainImages[imageIndex];
+	// swapchain image to attachment optimal
+	{
+		vkc::Image::Transition transition{};
+		//
+		{
+			transition.SrcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+			transition.DstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+			transition.DstStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+			transition.NewLayout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		}
+		swapchainImage.MakeTransition(m_Context, commandBuffer, transition);
+	}
+	// every full resolution pass depth tests against the depth image, the reduced marches also sample it for their footprint test
+	// the depth read only layout serves both, the full resolution pass alone keeps the attachment layout
+	bool const sampleDepth{ m_LowResSkyImage != nullptr };
+	// depth image to depth read only, or a barrier against the geometry writes
+	{
+		vkc::Image::Transition transition{};
+		//
+		{
+			transition.SrcAccessMask = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+			transition.DstAccessMask = sampleDepth
+										  ? VK_ACCESS_2_SHADER_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT
+										  : VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+			transition.DstStageMask  = sampleDepth
+										  ? VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT
+										  : VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+			transition.NewLayout     = sampleDepth ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL;
+		}
+		m_DepthImage->MakeTransition(m_Context, commandBuffer, transition);
+	}
+	if (m_SkyHistory)
+		RecordTemporalSky(commandBuffer, m_SwapchainImageViews[imageIndex]);
+	else if (m_LowResSkyImage)
+		RecordLowResSky(commandBuffer, m_SwapchainImageViews[imageIndex], m_Options.SkyScale);
+	else
+		DrawFullscreenSky(commandBuffer
+						  , m_SwapchainImageViews[imageIndex]
+						  , m_RenderExtent
+						  , VK_ATTACHMENT_LOAD_OP_LOAD
+						  , *m_SkyRenderPipeline
+						  , 1
+						  , true);
 
 	// swapchain image to present
 	{
@@ -1518,7 +3757,221 @@ void App::RecordCommandBuffer(vkc::CommandBuffer& commandBuffer, size_t imageInd
 		}
 		swapchainImage.MakeTransition(m_Context, commandBuffer, transition);
 	}
-	commandBuffer.End(m_Context);
+}
+
+void App::DrawFullscreenSky
+(
+	vkc::CommandBuffer&  commandBuffer
+	, VkImageView        target
+	, VkExtent2D         extent
+	, VkAttachmentLoadOp loadOp
+	, vkc::Pipeline&     pipeline
+	, uint32_t           skyScale
+	, bool               depthTest
+)
+{
+	VkRenderingAttachmentInfo renderingAttachmentInfo{};
+	renderingAttachmentInfo.sType       = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+	renderingAttachmentInfo.clearValue  = { { .0f, .0f, .0f, .0f } }; // zero alpha, see RecordTemporalSky
+	renderingAttachmentInfo.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	renderingAttachmentInfo.imageView   = target;
+	renderingAttachmentInfo.loadOp      = loadOp;
+	renderingAttachmentInfo.storeOp     = VK_ATTACHMENT_STORE_OP_STORE;
+
+	VkRenderingInfo renderingInfo{};
+	renderingInfo.sType                = VK_STRUCTURE_TYPE_RENDERING_INFO;
+	renderingInfo.colorAttachmentCount = 1;
+	renderingInfo.pColorAttachments    = &renderingAttachmentInfo;
+	renderingInfo.layerCount           = 1;
+	renderingInfo.renderArea           = VkRect2D{ {}, extent };
+
+	// read only, the pipeline does not write depth
+	VkRenderingAttachmentInfo depthAttachmentInfo{};
+	depthAttachmentInfo.sType       = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+	depthAttachmentInfo.imageLayout = m_DepthImage->GetLayout();
+	depthAttachmentInfo.imageView   = *m_DepthImageView;
+	depthAttachmentInfo.loadOp      = VK_ATTACHMENT_LOAD_OP_LOAD;
+	depthAttachmentInfo.storeOp     = VK_ATTACHMENT_STORE_OP_NONE;
+	if (depthTest)
+		renderingInfo.pDepthAttachment = &depthAttachmentInfo;
+
+	m_Context.DispatchTable.cmdBeginRendering(commandBuffer, &renderingInfo);
+	//
+	{
+		m_Context.DispatchTable.cmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+		m_Context.DispatchTable.cmdBindDescriptorSets(commandBuffer
+													  , VK_PIPELINE_BIND_POINT_GRAPHICS
+													  , *m_PipelineLayout
+													  , 0
+													  , 1
+													  , m_FrameDescriptorSets[m_CurrentFrame]
+													  , 0
+													  , nullptr);
+
+		VkViewport viewport{};
+		viewport.width    = static_cast<float>(extent.width);
+		viewport.height   = static_cast<float>(extent.height);
+		viewport.minDepth = 0.0f;
+		viewport.maxDepth = 1.0f;
+
+		m_Context.DispatchTable.cmdSetViewport(commandBuffer, 0, 1, &viewport);
+
+		VkRect2D scissor{};
+		scissor.offset = { 0, 0 };
+		scissor.extent = extent;
+		m_Context.DispatchTable.cmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+		SkyPushConstants pushConstant
+		{
+			m_Camera->GetPosition(), tan(glm::radians(m_Camera->GetFov() * .5f)), m_Camera->GetForward(), m_Camera->GetAspectRatio()
+			, GetSceneTime(), m_UseSkyview, skyScale, m_SkyFrame.Phase
+			, { glm::vec4{ m_SkyFrame.PreviousBasis[0], .0f }
+				, glm::vec4{ m_SkyFrame.PreviousBasis[1], .0f }
+				, glm::vec4{ m_SkyFrame.PreviousBasis[2], .0f } }
+			, m_SkyFrame.HistoryValid
+		};
+
+		m_Context.DispatchTable.cmdPushConstants(commandBuffer
+												 , *m_PipelineLayout
+												 , VK_SHADER_STAGE_FRAGMENT_BIT
+												 , 0
+												 , sizeof(pushConstant)
+												 , &pushConstant);
+
+		m_Context.DispatchTable.cmdDraw(commandBuffer, 3, 1, 0, 0);
+	}
+	m_Context.DispatchTable.cmdEndRendering(commandBuffer);
+}
+
+void App::RecordLowResSky(vkc::CommandBuffer& commandBuffer, VkImageView target, uint32_t skyScale)
+{
+	// low resolution sky to attachment optimal
+	{
+		vkc::Image::Transition transition{};
+		//
+		{
+			transition.SrcAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+			transition.DstAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT; // upsampled by the previous frame
+			transition.DstStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+			transition.NewLayout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		}
+		m_LowResSkyImage->MakeTransition(m_Context, commandBuffer, transition);
+	}
+	VkExtent2D const extent{ (m_RenderExtent.width + skyScale - 1) / skyScale, (m_RenderExtent.height + skyScale - 1) / skyScale };
+	// every texel is written, covered ones with zero weight
+	DrawFullscreenSky(commandBuffer, *m_LowResSkyImageView, extent, VK_ATTACHMENT_LOAD_OP_DONT_CARE, *m_LowResSkyPipeline, skyScale, false);
+	// low resolution sky to shader read only
+	{
+		vkc::Image::Transition transition{};
+		//
+		{
+			transition.SrcAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+			transition.DstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+			transition.DstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+			transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		}
+		m_LowResSkyImage->MakeTransition(m_Context, commandBuffer, transition);
+	}
+	DrawFullscreenSky(commandBuffer, target, m_RenderExtent, VK_ATTACHMENT_LOAD_OP_LOAD, *m_SkyUpsamplePipeline, skyScale, true);
+}
+
+void App::RecordTemporalSky(vkc::CommandBuffer& commandBuffer, VkImageView target)
+{
+	// the first frame after the history images are created reads nothing from the previous one but still binds it
+	vkc::Image& previousHistory{ m_SkyHistoryImages[(m_CurrentFrame + m_SkyHistoryImages.size() - 1) % m_SkyHistoryImages.size()] };
+	if (previousHistory.GetLayout() == VK_IMAGE_LAYOUT_UNDEFINED)
+	{
+		vkc::Image::Transition transition{};
+		//
+		{
+			transition.SrcAccessMask = VK_ACCESS_2_NONE;
+			transition.DstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_NONE;
+			transition.DstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+			transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		}
+		previousHistory.MakeTransition(m_Context, commandBuffer, transition);
+	}
+
+	// shaded pattern and history of this frame to attachment optimal
+	vkc::Image& history{ m_SkyHistoryImages[m_CurrentFrame % m_SkyHistoryImages.size()] };
+	for (vkc::Image* image: { m_LowResSkyImage.get(), &history })
+	{
+		vkc::Image::Transition transition{};
+		//
+		{
+			transition.SrcAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+			transition.DstAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT; // read by the previous frames
+			transition.DstStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+			transition.NewLayout     = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		}
+		image->MakeTransition(m_Context, commandBuffer, transition);
+	}
+	uint32_t const pattern{ m_Options.SkyPattern };
+	DrawFullscreenSky(commandBuffer
+					  , *m_LowResSkyImageView
+					  , m_LowResSkyImage->GetExtent()
+					  , VK_ATTACHMENT_LOAD_OP_DONT_CARE
+					  , *m_LowResSkyPipeline
+					  , pattern
+					  , false);
+	// shaded pattern to shader read only
+	{
+		vkc::Image::Transition transition{};
+		//
+		{
+			transition.SrcAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+			transition.DstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+			transition.DstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+			transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		}
+		m_LowResSkyImage->MakeTransition(m_Context, commandBuffer, transition);
+	}
+	// cleared to zero alpha, geometry fails the depth test and stays invalid history so it is never reprojected into the sky
+	DrawFullscreenSky(commandBuffer
+					  , m_SkyHistoryImageViews[m_CurrentFrame % m_SkyHistoryImageViews.size()]
+					  , m_RenderExtent
+					  , VK_ATTACHMENT_LOAD_OP_CLEAR
+					  , *m_SkyResolvePipeline
+					  , pattern
+					  , true);
+	// history to shader read only, composited now and reprojected by the next frame
+	{
+		vkc::Image::Transition transition{};
+		//
+		{
+			transition.SrcAccessMask = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+			transition.DstAccessMask = VK_ACCESS_2_SHADER_READ_BIT;
+			transition.SrcStageMask  = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+			transition.DstStageMask  = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+			transition.NewLayout     = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		}
+		history.MakeTransition(m_Context, commandBuffer, transition);
+	}
+	DrawFullscreenSky(commandBuffer, target, m_RenderExtent, VK_ATTACHMENT_LOAD_OP_LOAD, *m_SkyUpsamplePipeline, 1, true);
+}
+
+glm::mat3 App::GetSkyRayBasis() const
+{
+	// gGroundRadius of atmosphere_constants.glsl, FindPlanetRelativePosition converts meters to kilometers
+	float constexpr groundRadius{ 6371.f };
+	glm::vec3 const planetUp{ glm::normalize(.001f * m_Camera->GetPosition() + glm::vec3{ .0f, groundRadius, .0f }) };
+	glm::vec3 const forward{ m_Camera->GetForward() };
+	glm::vec3 const right{ glm::normalize(glm::cross(forward, planetUp)) };
+	return glm::mat3{ right, glm::cross(right, forward), forward };
+}
+
+float App::GetSkyShadedFraction() const
+{
+	if (m_SkyHistory)
+		return m_SkyHistory->GetShadedFraction();
+	if (m_LowResSkyImage)
+		return 1.f / static_cast<float>(m_Options.SkyScale * m_Options.SkyScale);
+	return 1.f;
 }
 
 void App::Submit(vkc::CommandBuffer& commandBuffer) const
@@ -1531,6 +3984,7 @@ void App::Submit(vkc::CommandBuffer& commandBuffer) const
 	VkSemaphoreSubmitInfo signalSemaphoreSubmitInfo{};
 	signalSemaphoreSubmitInfo.sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
 	signalSemaphoreSubmitInfo.semaphore = m_RenderFinishedSemaphores[m_CurrentFrame];
+	signalSemaphoreSubmitInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
 
 	VkSemaphoreSubmitInfo waitSemaphoreInfos[]{ waitSemaphoreSubmitInfo };
 	VkSemaphoreSubmitInfo signalSemaphoreInfos[]{ signalSemaphoreSubmitInfo };
@@ -1538,6 +3992,245 @@ void App::Submit(vkc::CommandBuffer& commandBuffer) const
 	commandBuffer.Submit(m_Context, m_Context.GraphicsQueue, waitSemaphoreInfos, signalSemaphoreInfos, m_InFlightFences[m_CurrentFrame]);
 }
 
+void App::RecordAndSubmitAsyncFrame(vkc::CommandBuffer& commandBuffer, size_t imageIndex, std::span<SkyviewRows const> skyviewRows)
+{
+	// bands that are not redrawn keep their texels, so the LUT makes a full ownership round trip every frame
+	// the first frame of an image has nothing to acquire, it was never released by the graphics queue
+	vkc::CommandBuffer& computeCommandBuffer = m_ComputeCommandPool->AllocateCommandBuffer(m_Context);
+	computeCommandBuffer.Begin(m_Context);
+	if (m_ComputeFrameTimer)
+		m_ComputeFrameTimer->BeginFrame(m_Context, computeCommandBuffer, m_CurrentFrame);
+	if (m_SkyviewReleased)
+		TransferSkyviewOwnership(computeCommandBuffer, false, false);
+	RecordTimed(m_ComputeFrameTimer.get()
+				, computeCommandBuffer
+				, m_FrameScopes.SkyviewLUT
+				, [&]
+				{
+					if (IsSkyviewArrayCurrent())
+						ResolveSkyviewArray(computeCommandBuffer, VK_PIPELINE_STAGE_2_NONE);
+					else
+						GenerateSkyviewLUTCompute(computeCommandBuffer, VK_PIPELINE_STAGE_2_NONE, skyviewRows);
+				});
+	TransferSkyviewOwnership(computeCommandBuffer, true, true);
+	computeCommandBuffer.End(m_Context);
+	//
+	{
+		// the sky-view image is shared between frames, the previous sky pass has to stop sampling it first
+		VkSemaphoreSubmitInfo waitSemaphoreSubmitInfo{};
+		waitSemaphoreSubmitInfo.sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+		waitSemaphoreSubmitInfo.semaphore = m_FrameTimeline;
+		waitSemaphoreSubmitInfo.value     = m_FrameNumber - 1;
+		waitSemaphoreSubmitInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT; // covers the acquire barrier as well
+
+		VkSemaphoreSubmitInfo signalSemaphoreSubmitInfo{};
+		signalSemaphoreSubmitInfo.sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+		signalSemaphoreSubmitInfo.semaphore = m_LUTTimeline;
+		signalSemaphoreSubmitInfo.value     = m_FrameNumber;
+		signalSemaphoreSubmitInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT; // covers the release barrier as well
+
+		VkSemaphoreSubmitInfo waitSemaphoreInfos[]{ waitSemaphoreSubmitInfo };
+		VkSemaphoreSubmitInfo signalSemaphoreInfos[]{ signalSemaphoreSubmitInfo };
+
+		m_Context.DispatchTable.resetFences(1, &computeCommandBuffer.GetFence());
+		computeCommandBuffer.Submit(m_Context, m_ComputeQueue, waitSemaphoreInfos, signalSemaphoreInfos);
+	}
+
+	vkc::CommandBuffer& geometryCommandBuffer = m_GeometryCommandPool->AllocateCommandBuffer(m_Context);
+	geometryCommandBuffer.Begin(m_Context);
+	// the geometry batch is submitted first, so it resets the slot for both graphics batches
+	if (m_FrameTimer)
+		m_FrameTimer->BeginFrame(m_Context, geometryCommandBuffer, m_CurrentFrame);
+	FrameTimer* const timer{ m_FrameTimer.get() };
+	RecordTimed(timer, geometryCommandBuffer, m_FrameScopes.AerialPerspective, [&] { GenerateAerialPerspective(geometryCommandBuffer); });
+	RecordTimed(timer, geometryCommandBuffer, m_FrameScopes.Geometry, [&] { RecordGeometryPass(geometryCommandBuffer, imageIndex); });
+	geometryCommandBuffer.End(m_Context);
+
+	commandBuffer.Begin(m_Context);
+	TransferSkyviewOwnership(commandBuffer, true, false);
+	RecordTimed(timer, commandBuffer, m_FrameScopes.Sky, [&] { RecordSkyPass(commandBuffer, imageIndex); });
+	TransferSkyviewOwnership(commandBuffer, false, true);
+	commandBuffer.End(m_Context);
+
+	// both graphics batches go in one submission so the in-flight fence covers the geometry pass as well
+	VkSemaphoreSubmitInfo imageAvailableInfo{};
+	imageAvailableInfo.sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+	imageAvailableInfo.semaphore = m_ImageAvailableSemaphores[m_CurrentFrame];
+	imageAvailableInfo.stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+
+	VkSemaphoreSubmitInfo lutReadyInfo{};
+	lutReadyInfo.sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+	lutReadyInfo.semaphore = m_LUTTimeline;
+	lutReadyInfo.value     = m_FrameNumber;
+	lutReadyInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+	VkSemaphoreSubmitInfo renderFinishedInfo{};
+	renderFinishedInfo.sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+	renderFinishedInfo.semaphore = m_RenderFinishedSemaphores[m_CurrentFrame];
+	renderFinishedInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+
+	VkSemaphoreSubmitInfo frameDoneInfo{};
+	frameDoneInfo.sType     = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO;
+	frameDoneInfo.semaphore = m_FrameTimeline;
+	frameDoneInfo.value     = m_FrameNumber;
+	frameDoneInfo.stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT; // covers the release barrier after the sky pass
+
+	VkSemaphoreSubmitInfo const skySignalInfos[]{ renderFinishedInfo, frameDoneInfo };
+
+	VkCommandBufferSubmitInfo geometryCommandBufferInfo{};
+	geometryCommandBufferInfo.sType         = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+	geometryCommandBufferInfo.commandBuffer = geometryCommandBuffer;
+
+	VkCommandBufferSubmitInfo skyCommandBufferInfo{};
+	skyCommandBufferInfo.sType         = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO;
+	skyCommandBufferInfo.commandBuffer = commandBuffer;
+
+	VkSubmitInfo2 submitInfos[2]{};
+	submitInfos[0].sType                    = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+	submitInfos[0].waitSemaphoreInfoCount   = 1;
+	submitInfos[0].pWaitSemaphoreInfos      = &imageAvailableInfo;
+	submitInfos[0].commandBufferInfoCount   = 1;
+	submitInfos[0].pCommandBufferInfos      = &geometryCommandBufferInfo;
+	submitInfos[1].sType                    = VK_STRUCTURE_TYPE_SUBMIT_INFO_2;
+	submitInfos[1].waitSemaphoreInfoCount   = 1;
+	submitInfos[1].pWaitSemaphoreInfos      = &lutReadyInfo;
+	submitInfos[1].commandBufferInfoCount   = 1;
+	submitInfos[1].pCommandBufferInfos      = &skyCommandBufferInfo;
+	submitInfos[1].signalSemaphoreInfoCount = static_cast<uint32_t>(std::size(skySignalInfos));
+	submitInfos[1].pSignalSemaphoreInfos    = skySignalInfos;
+
+	if (m_Context.DispatchTable.queueSubmit2(m_Context.GraphicsQueue
+											 , static_cast<uint32_t>(std::size(submitInfos))
+											 , submitInfos
+											 , m_InFlightFences[m_CurrentFrame]) != VK_SUCCESS)
+		throw std::runtime_error("Failed to submit the frame");
+	m_SkyviewReleased = true;
+}
+
+void App::ReportSkyviewStaleness() const
+{
+	if (!m_SkyviewSchedule->IsAmortized())
+		return;
+
+	SkyviewSchedule::Staleness const& staleness{ m_SkyviewSchedule->GetWorstStaleness() };
+	std::cout << "sky-view LUT over " << m_SkyviewSchedule->GetFrameCount() << " frames, worst staleness: "
+			<< staleness.Frames << " frames, "
+			<< glm::degrees(staleness.SunAngle) << " degrees of sun, "
+			<< staleness.CameraAltitude << " m of camera altitude, "
+			<< m_SkyviewSchedule->GetForcedRefreshCount() << " forced full refreshes" << std::endl;
+}
+
+void App::ReportSkyHistory() const
+{
+	if (!m_SkyHistory)
+		return;
+
+	std::cout << "temporal sky over " << m_SkyHistory->GetFrameCount() << " frames: " << m_SkyHistory->GetMeanShadedFraction() * 100.
+			<< "% of the pixels ray marched on average, " << m_SkyHistory->GetRejectedCount()
+			<< " frames ray marched in full after a large sun or camera change" << std::endl;
+}
+
+void App::ReportFrameTimings() const
+{
+	if (m_FrameTimer || m_ComputeFrameTimer)
+		std::cout << "GPU passes at the " << GetQualityTierName(m_Options.Tier) << " quality tier:" << std::endl;
+	for (FrameTimer const* timer: { m_FrameTimer.get(), m_ComputeFrameTimer.get() })
+	{
+		if (!timer)
+			continue;
+
+		std::span<FrameTimer::Statistics const> const statistics{ timer->GetStatistics() };
+		for (FrameTimer::Scope scope{}; scope < statistics.size(); ++scope)
+		{
+			FrameTimer::Statistics const& pass{ statistics[scope] };
+			if (pass.Frames == 0)
+				continue;
+			std::cout << "  " << timer->GetLabel(scope) << ": " << pass.TotalMilliseconds / static_cast<double>(pass.Frames) << " ms average, "
+					<< pass.MaxMilliseconds << " ms worst over " << pass.Frames << " frames, "
+					<< pass.Dropped << " frames not ready in time" << std::endl;
+		}
+	}
+}
+
+void App::SelectQualityTier(QualityTier tier)
+{
+	if (tier == m_Options.Tier)
+		return;
+
+	// frames in flight still sample the LUTs of the outgoing tier
+	if (auto const result = m_Context.DispatchTable.deviceWaitIdle();
+		result != VK_SUCCESS)
+		throw std::runtime_error("Failed to wait for device to be idle");
+
+	// the frames still waiting in the timer slots were rendered at the outgoing tier
+	for (FrameTimer* timer: { m_FrameTimer.get(), m_ComputeFrameTimer.get() })
+		if (timer)
+			timer->CollectPending(m_Context);
+	ReportFrameTimings();
+	for (FrameTimer* timer: { m_FrameTimer.get(), m_ComputeFrameTimer.get() })
+		if (timer)
+			timer->ResetStatistics();
+
+	SwapTierResources(m_Tiers[static_cast<size_t>(m_Options.Tier)]);
+	bool const adaptiveScattering{ m_Options.Quality.AdaptiveScattering };
+	bool const opticalDepthLUT{ m_Options.Quality.OpticalDepthLUT };
+	m_Options.Tier                       = tier;
+	m_Options.Quality                    = GetQualitySettings(tier);
+	m_Options.Quality.AdaptiveScattering = adaptiveScattering;
+	m_Options.Quality.OpticalDepthLUT    = opticalDepthLUT;
+	SwapTierResources(m_Tiers[static_cast<size_t>(tier)]);
+	// the history was ray marched at the outgoing tier's sample counts
+	if (m_SkyHistory)
+		m_SkyHistory->Invalidate();
+
+	if (m_TransmittanceImage)
+	{
+		// the static LUTs and the sky-view array of a parked tier are still valid, only the sky-view LUT is behind the camera
+		m_SkyviewSchedule->Invalidate();
+		std::cout << "quality tier " << GetQualityTierName(tier) << std::endl;
+		return;
+	}
+
+	auto const start{ std::chrono::steady_clock::now() };
+	CreateLUTImages();
+	CreateLUTPipelines();
+	CreateComputeLUTPipelines();
+	CreateDescriptorSets();
+	InvalidateStaticLUTs();
+	std::cout << "quality tier " << GetQualityTierName(tier) << " built in "
+			<< std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() << " ms" << std::endl;
+}
+
+void App::SwapTierResources(TierResources& tier)
+{
+	std::swap(m_TransmittanceImage, tier.TransmittanceImage);
+	std::swap(m_TransmittanceImageView, tier.TransmittanceImageView);
+	std::swap(m_MultScatteringImage, tier.MultScatteringImage);
+	std::swap(m_MultScatteringImageView, tier.MultScatteringImageView);
+	std::swap(m_SkyviewImage, tier.SkyviewImage);
+	std::swap(m_SkyviewImageView, tier.SkyviewImageView);
+	std::swap(m_OpticalDepthImage, tier.OpticalDepthImage);
+	std::swap(m_OpticalDepthImageView, tier.OpticalDepthImageView);
+	std::swap(m_SkyviewArrayImage, tier.SkyviewArrayImage);
+	std::swap(m_SkyviewArrayAltitude, tier.SkyviewArrayAltitude);
+	std::swap(m_SkyviewSchedule, tier.Schedule);
+	std::swap(m_TransmittancePipeline, tier.TransmittancePipeline);
+	std::swap(m_MultipleScatteringPipeline, tier.MultipleScatteringPipeline);
+	std::swap(m_SkyviewPipeline, tier.SkyviewPipeline);
+	std::swap(m_SkyRenderPipeline, tier.SkyRenderPipeline);
+	std::swap(m_LowResSkyPipeline, tier.LowResSkyPipeline);
+	std::swap(m_SkyResolvePipeline, tier.SkyResolvePipeline);
+	std::swap(m_TransmittanceComputePipeline, tier.TransmittanceComputePipeline);
+	std::swap(m_MultScatteringComputePipeline, tier.MultScatteringComputePipeline);
+	std::swap(m_SkyviewComputePipeline, tier.SkyviewComputePipeline);
+	std::swap(m_AerialPerspectivePipeline, tier.AerialPerspectivePipeline);
+	std::swap(m_SkyviewBakePipeline, tier.SkyviewBakePipeline);
+	std::swap(m_OpticalDepthPipeline, tier.OpticalDepthPipeline);
+	std::swap(m_FrameDescriptorSets, tier.FrameDescriptorSets);
+	std::swap(m_ComputeDescriptorSets, tier.ComputeDescriptorSets);
+	std::swap(m_SkyviewReleased, tier.SkyviewReleased);
+}
+
 void App::Present(uint32_t imageIndex)
 {
 	VkSwapchainKHR const swapchains[]{ m_Context.Swapchain };
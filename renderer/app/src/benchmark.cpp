@@ -0,0 +1,166 @@
+#include "benchmark.h"
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+namespace
+{
+	// GetSunAltitude starts 5 degrees below the horizon and turns half a circle in 60 seconds
+	float constexpr SUNRISE_TIME{ 2.f };     // about one degree above the horizon
+	float constexpr NOON_TIME{ 31.667f };    // sun at the zenith
+	float constexpr AFTERNOON_TIME{ 12.f };  // about 31 degrees
+
+	std::string Escape(std::string_view text)
+	{
+		std::string result{};
+		for (char const character: text)
+		{
+			if (character == '"' || character == '\\')
+				result += '\\';
+			if (static_cast<unsigned char>(character) < 0x20)
+				continue;
+			result += character;
+		}
+		return result;
+	}
+
+	void WriteVec3(std::ostream& stream, glm::vec3 const& value)
+	{
+		stream << "[" << value.x << ", " << value.y << ", " << value.z << "]";
+	}
+
+	void WritePasses(std::ostream& stream, std::span<PassSamples const> passes, std::string_view indent)
+	{
+		stream << "[";
+		for (size_t index{}; index < passes.size(); ++index)
+		{
+			SampleSummary const summary{ Summarize(passes[index].Milliseconds) };
+			stream << (index ? "," : "") << "\n" << indent << "\t{ \"name\": \"" << Escape(passes[index].Name) << "\""
+					<< ", \"samples\": " << summary.Count
+					<< ", \"min_ms\": " << summary.Min
+					<< ", \"p5_ms\": " << summary.P5
+					<< ", \"median_ms\": " << summary.Median
+					<< ", \"p95_ms\": " << summary.P95
+					<< ", \"p99_ms\": " << summary.P99
+					<< ", \"mad_ms\": " << summary.MedianAbsoluteDeviation
+					<< ", \"median_ci95_ms\": [" << summary.MedianLow << ", " << summary.MedianHigh << "] }";
+		}
+		stream << "\n" << indent << "]";
+	}
+}
+
+std::vector<BenchmarkScenario> GetBenchmarkScenarios()
+{
+	glm::vec3 const horizontal{ 1.f, .0f, .0f };
+	return {
+		{ "ground_sunrise", { .0f, 2.f, .0f }, horizontal, SUNRISE_TIME }
+		, { "ground_noon", { .0f, 2.f, .0f }, horizontal, NOON_TIME }
+		, { "altitude_10km", { .0f, 10000.f, .0f }, horizontal, AFTERNOON_TIME }
+		// 20 km above gAtmosphereRadius, looking down at the limb
+		, { "above_atmosphere", { .0f, 120000.f, .0f }, glm::vec3{ 1.f, -.2f, .0f }, AFTERNOON_TIME }
+	};
+}
+
+SampleSummary Summarize(std::vector<double> samples)
+{
+	if (samples.empty())
+		return {};
+
+	std::ranges::sort(samples);
+	auto const rank = [](std::vector<double> const& sorted, double percentile)
+	{
+		auto const index{ static_cast<size_t>(std::ceil(percentile * static_cast<double>(sorted.size()))) };
+		return sorted[std::clamp(index, size_t{ 1 }, sorted.size()) - 1];
+	};
+
+	SampleSummary summary{};
+	summary.Min    = samples.front();
+	summary.P5     = rank(samples, .05);
+	summary.Median = rank(samples, .5);
+	summary.P95    = rank(samples, .95);
+	summary.P99    = rank(samples, .99);
+	summary.Count  = samples.size();
+
+	std::vector<double> deviations(samples.size());
+	std::ranges::transform(samples, deviations.begin(), [&summary](double sample) { return std::abs(sample - summary.Median); });
+	std::ranges::sort(deviations);
+	summary.MedianAbsoluteDeviation = rank(deviations, .5);
+
+	// the ranks around the median that hold it with 95% probability, normal approximation of the binomial
+	double const count{ static_cast<double>(samples.size()) };
+	double const spread{ 1.96 * std::sqrt(count) / 2. };
+	auto const   low{ static_cast<ptrdiff_t>(std::floor(count / 2. - spread)) };
+	auto const   high{ static_cast<ptrdiff_t>(std::ceil(count / 2. + spread)) };
+	auto const   last{ static_cast<ptrdiff_t>(samples.size()) - 1 };
+	summary.MedianLow  = samples[std::clamp(low, ptrdiff_t{}, last)];
+	summary.MedianHigh = samples[std::clamp(high, ptrdiff_t{}, last)];
+	return summary;
+}
+
+void WriteBenchmarkResults
+(
+	std::filesystem::path const&      path
+	, BenchmarkDevice const&          device
+	, BenchmarkSettings const&        settings
+	, std::span<PassSamples const>    staticPasses
+	, std::span<ScenarioResult const> scenarios
+)
+{
+	if (path.has_parent_path())
+		std::filesystem::create_directories(path.parent_path());
+	std::ofstream file{ path, std::ios::out | std::ios::trunc };
+	if (!file)
+		throw std::runtime_error("failed to write benchmark results " + path.string());
+
+	std::time_t const now{ std::time(nullptr) };
+	std::tm           utc{};
+#ifdef _WIN32
+	gmtime_s(&utc, &now);
+#else
+	gmtime_r(&now, &utc);
+#endif
+
+	file << std::setprecision(6);
+	file << "{\n"
+			<< "\t\"timestamp\": \"" << std::put_time(&utc, "%Y-%m-%dT%H:%M:%SZ") << "\",\n"
+			<< "\t\"device\": { \"name\": \"" << Escape(device.Name) << "\""
+			<< ", \"vendor_id\": " << device.VendorID
+			<< ", \"device_id\": " << device.DeviceID
+			<< ", \"driver_version\": " << device.DriverVersion
+			<< ", \"api_version\": " << device.ApiVersion << " },\n"
+			<< "\t\"settings\": { \"width\": " << settings.Width
+			<< ", \"height\": " << settings.Height
+			<< ", \"samples\": " << settings.Samples
+			<< ", \"batch\": " << settings.BatchRepetitions
+			<< ", \"warmup\": " << settings.BatchWarmup
+			<< ", \"spectral\": " << (settings.Spectral ? "true" : "false")
+			<< ", \"compute_luts\": " << (settings.ComputeLUTs ? "true" : "false")
+			<< ", \"quality\": \"" << Escape(settings.Quality) << "\""
+			<< ", \"adaptive_march\": " << (settings.AdaptiveMarch ? "true" : "false")
+			<< ", \"optical_depth_lut\": " << (settings.OpticalDepthLUT ? "true" : "false") << " },\n"
+			<< "\t\"static_passes\": ";
+	WritePasses(file, staticPasses, "\t");
+	file << ",\n\t\"scenarios\": [";
+	for (size_t index{}; index < scenarios.size(); ++index)
+	{
+		BenchmarkScenario const& scenario{ scenarios[index].Scenario };
+		file << (index ? "," : "") << "\n\t\t{\n"
+				<< "\t\t\t\"name\": \"" << Escape(scenario.Name) << "\",\n"
+				<< "\t\t\t\"camera\": ";
+		WriteVec3(file, scenario.CameraPosition);
+		file << ",\n\t\t\t\"forward\": ";
+		WriteVec3(file, scenario.CameraForward);
+		file << ",\n\t\t\t\"time\": " << scenario.Time << ",\n"
+				<< "\t\t\t\"passes\": ";
+		WritePasses(file, scenarios[index].Passes, "\t\t\t");
+		file << "\n\t\t}";
+	}
+	file << "\n\t]\n}\n";
+
+	if (!file)
+		throw std::runtime_error("failed to write benchmark results " + path.string());
+}
@@ -0,0 +1,54 @@
+#include "compute_pipeline.h"
+
+#include <stdexcept>
+#include <vector>
+
+VkPipeline CreateComputePipeline
+(
+	vkc::Context const&         context
+	, PipelineCache&            cache
+	, std::span<uint32_t const> code
+	, VkPipelineLayout          layout
+	, std::span<uint32_t const> specializationConstants
+)
+{
+	VkShaderModuleCreateInfo moduleCreateInfo{};
+	moduleCreateInfo.sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	moduleCreateInfo.codeSize = code.size_bytes();
+	moduleCreateInfo.pCode    = code.data();
+
+	VkShaderModule shaderModule{};
+	if (context.DispatchTable.createShaderModule(&moduleCreateInfo, nullptr, &shaderModule) != VK_SUCCESS)
+		throw std::runtime_error("failed to create compute shader module");
+
+	std::vector<VkSpecializationMapEntry> mapEntries(specializationConstants.size());
+	for (uint32_t index{}; index < mapEntries.size(); ++index)
+	{
+		mapEntries[index].constantID = index;
+		mapEntries[index].offset     = index * static_cast<uint32_t>(sizeof(uint32_t));
+		mapEntries[index].size       = sizeof(uint32_t);
+	}
+
+	VkSpecializationInfo specializationInfo{};
+	specializationInfo.mapEntryCount = static_cast<uint32_t>(mapEntries.size());
+	specializationInfo.pMapEntries   = mapEntries.data();
+	specializationInfo.dataSize      = specializationConstants.size_bytes();
+	specializationInfo.pData         = specializationConstants.data();
+
+	VkComputePipelineCreateInfo createInfo{};
+	createInfo.sType                     = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	createInfo.stage.sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	createInfo.stage.stage               = VK_SHADER_STAGE_COMPUTE_BIT;
+	createInfo.stage.module              = shaderModule;
+	createInfo.stage.pName               = "main";
+	createInfo.stage.pSpecializationInfo = &specializationInfo;
+	createInfo.layout                    = layout;
+
+	VkPipeline     pipeline{};
+	VkResult const result = cache.CreateComputePipelines(context, { &createInfo, 1 }, &pipeline);
+	context.DispatchTable.destroyShaderModule(shaderModule, nullptr);
+	if (result != VK_SUCCESS)
+		throw std::runtime_error("failed to create compute pipeline");
+
+	return pipeline;
+}
@@ -0,0 +1,21 @@
+#include "embedded_shaders.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+std::span<uint32_t const> GetEmbeddedShader(std::string_view name)
+{
+	std::span<EmbeddedShader const> const shaders{ GetEmbeddedShaders() };
+	auto const                            shader{ std::ranges::find(shaders, name, &EmbeddedShader::Name) };
+	if (shader == shaders.end())
+		throw std::runtime_error("no embedded shader " + std::string(name));
+	return shader->Code;
+}
+
+std::vector<char> CopyEmbeddedShader(std::string_view name)
+{
+	std::span<uint32_t const> const code{ GetEmbeddedShader(name) };
+	char const* const               bytes{ reinterpret_cast<char const*>(code.data()) };
+	return { bytes, bytes + code.size_bytes() };
+}
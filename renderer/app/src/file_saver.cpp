@@ -1,6 +1,7 @@
 #include "file_saver.h"
 #include <array>
-#include <iostream>
+#include <stdexcept>
+#include <string>
 #pragma warning(push)
 #pragma warning(disable : 4702 4706 4267 4244 4245 4305 4800)
 #define TINYEXR_IMPLEMENTATION
@@ -11,29 +12,22 @@
 
 void SaveEXRFile(void const* data, int width, int height, std::filesystem::path const& outputPath)
 {
-	auto      pixelData = static_cast<uint16_t const*>(data); // received data is 16 bits, RGBA16 format
 	EXRHeader exrHeader;
 	InitEXRHeader(&exrHeader);
 
 	EXRImage exrImage;
 	InitEXRImage(&exrImage);
 
-	static int constexpr  channelCount{ 4 };
-	std::vector<uint16_t> images[channelCount]{};
-	for (int image{}; image < channelCount; ++image)
-		images[image].resize(width * height);
+	static int constexpr channelCount{ 4 };
 
-	for (int pixel{}; pixel < width * height; ++pixel)
-	{
-		for (int channel{}; channel < channelCount; ++channel)
-			images[channel][pixel] = pixelData[channelCount * pixel + channel];
-	}
-
-	uint16_t* imagePtr[channelCount];
+	// tinyexr only reads the planes, they point straight into the received data
+	auto const     planes{ static_cast<unsigned char*>(const_cast<void*>(data)) };
+	size_t const   planeSize{ static_cast<size_t>(width) * height * sizeof(uint16_t) };
+	unsigned char* imagePtr[channelCount];
 	for (int image{}; image < channelCount; ++image)
-		imagePtr[image] = &images[image][0];
+		imagePtr[image] = planes + image * planeSize;
 
-	exrImage.images            = reinterpret_cast<unsigned char**>(imagePtr);
+	exrImage.images            = imagePtr;
 	exrImage.num_channels      = channelCount;
 	exrImage.width             = width;
 	exrImage.height            = height;
@@ -57,18 +51,19 @@ void SaveEXRFile(void const* data, int width, int height, std::filesystem::path
 	char const* error = nullptr;
 
 	int const ret = SaveEXRImageToFile(&exrImage, &exrHeader, outputPath.string().c_str(), &error);
+	free(exrHeader.channels);
+	free(exrHeader.pixel_types);
+	free(exrHeader.requested_pixel_types);
 	if (ret != TINYEXR_SUCCESS)
 	{
-		std::cerr << error << std::endl;
+		std::string const message{ error ? error : "tinyexr error " + std::to_string(ret) };
 		FreeEXRErrorMessage(error); // free's buffer for an error message
-		return;
+		throw std::runtime_error(message);
 	}
-	free(exrHeader.channels);
-	free(exrHeader.pixel_types);
-	free(exrHeader.requested_pixel_types);
 }
 
 void SavePNGFile(void const* data, int width, int height, std::filesystem::path const& outputPath)
 {
-	stbi_write_png(outputPath.string().c_str(), width, height, 4, data, width * 4);
+	if (!stbi_write_png(outputPath.string().c_str(), width, height, 4, data, width * 4))
+		throw std::runtime_error("stb_image_write failed");
 }
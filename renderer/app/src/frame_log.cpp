@@ -0,0 +1,96 @@
+#include "frame_log.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <stdexcept>
+
+namespace
+{
+	auto constexpr IDLE_SLEEP{ std::chrono::milliseconds{ 10 } };
+	auto constexpr FLUSH_INTERVAL{ std::chrono::seconds{ 1 } };
+}
+
+FrameLog::FrameLog(std::filesystem::path const& path, std::span<std::string const> passNames, size_t capacity)
+	: m_Ring(std::bit_ceil(std::max(capacity, size_t{ 2 })))
+	, m_Mask{ m_Ring.size() - 1 }
+	, m_PassCount{ passNames.size() }
+{
+	if (passNames.size() > FrameRecord::MAX_GPU_PASSES)
+		throw std::runtime_error("frame log holds at most " + std::to_string(FrameRecord::MAX_GPU_PASSES) + " GPU passes");
+
+	if (path.has_parent_path())
+		std::filesystem::create_directories(path.parent_path());
+	m_File.open(path, std::ios::out | std::ios::trunc);
+	if (!m_File)
+		throw std::runtime_error("failed to open frame log " + path.string());
+
+	m_File << "frame,cpu ms,fence wait ms,acquire ms,present ms,sky shaded fraction";
+	for (std::string const& name: passNames)
+		m_File << ",gpu " << name << " ms";
+	m_File << '\n';
+
+	m_Writer = std::thread{ &FrameLog::Work, this };
+}
+
+FrameLog::~FrameLog()
+{
+	m_Stopping.store(true, std::memory_order_release);
+	m_Writer.join();
+
+	m_File << "# dropped " << m_Dropped << " frames on a full ring\n";
+}
+
+bool FrameLog::Push(FrameRecord const& record) noexcept
+{
+	size_t const head{ m_Head.load(std::memory_order_relaxed) };
+	if (head - m_Tail.load(std::memory_order_acquire) == m_Ring.size())
+	{
+		++m_Dropped;
+		return false;
+	}
+
+	m_Ring[head & m_Mask] = record;
+	m_Head.store(head + 1, std::memory_order_release);
+	return true;
+}
+
+void FrameLog::Work()
+{
+	auto lastFlush{ std::chrono::steady_clock::now() };
+	while (true)
+	{
+		// the stop flag is read before the head, records pushed before stopping are always drained
+		bool const   stopping{ m_Stopping.load(std::memory_order_acquire) };
+		size_t const head{ m_Head.load(std::memory_order_acquire) };
+		size_t       tail{ m_Tail.load(std::memory_order_relaxed) };
+		for (; tail != head; ++tail)
+		{
+			Write(m_Ring[tail & m_Mask]);
+			m_Tail.store(tail + 1, std::memory_order_release);
+		}
+
+		if (auto const now{ std::chrono::steady_clock::now() }; now - lastFlush >= FLUSH_INTERVAL || stopping)
+		{
+			m_File.flush();
+			lastFlush = now;
+		}
+		if (stopping)
+			return;
+		std::this_thread::sleep_for(IDLE_SLEEP);
+	}
+}
+
+void FrameLog::Write(FrameRecord const& record)
+{
+	m_File << record.Frame << ',' << record.CpuMilliseconds << ',' << record.FenceWaitMilliseconds << ','
+			<< record.AcquireMilliseconds << ',' << record.PresentMilliseconds << ',' << record.SkyShadedFraction;
+	for (size_t pass{}; pass < m_PassCount; ++pass)
+	{
+		m_File << ',';
+		if (!std::isnan(record.GpuMilliseconds[pass]))
+			m_File << record.GpuMilliseconds[pass];
+	}
+	m_File << '\n';
+}
@@ -0,0 +1,138 @@
+#include "frame_timer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <ratio>
+#include <stdexcept>
+
+#include "tracer.h"
+
+FrameTimer::FrameTimer(vkc::Context const& context, float timestampPeriod, uint32_t framesInFlight, uint32_t maxScopes)
+	: m_Slots(framesInFlight)
+	, m_Results(static_cast<size_t>(maxScopes) * 2 * 2)
+	, m_MaxScopes{ maxScopes }
+	, m_TimestampPeriod{ timestampPeriod }
+{
+	// the tracer keeps views of the labels, reserving keeps them in place
+	m_Labels.reserve(maxScopes);
+	m_Statistics.reserve(maxScopes);
+
+	VkQueryPoolCreateInfo createInfo{};
+	createInfo.sType      = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	createInfo.queryType  = VK_QUERY_TYPE_TIMESTAMP;
+	createInfo.queryCount = maxScopes * 2; // begin and end of every scope
+	for (Slot& slot: m_Slots)
+	{
+		if (context.DispatchTable.createQueryPool(&createInfo, nullptr, &slot.QueryPool) != VK_SUCCESS)
+			throw std::runtime_error("failed to create a frame timing query pool");
+		slot.Recorded.resize(maxScopes);
+	}
+}
+
+void FrameTimer::Destroy(vkc::Context const& context) const
+{
+	for (Slot const& slot: m_Slots)
+		context.DispatchTable.destroyQueryPool(slot.QueryPool, nullptr);
+}
+
+FrameTimer::Scope FrameTimer::Intern(std::string_view label)
+{
+	if (auto const found = std::ranges::find(m_Labels, label);
+		found != m_Labels.end())
+		return static_cast<Scope>(found - m_Labels.begin());
+
+	if (m_Labels.size() == m_MaxScopes)
+		throw std::runtime_error("frame timer has no scope left for " + std::string(label));
+	m_Labels.emplace_back(label);
+	m_Statistics.emplace_back();
+	return static_cast<Scope>(m_Labels.size() - 1);
+}
+
+void FrameTimer::BeginFrame(vkc::Context const& context, vkc::CommandBuffer const& commandBuffer, uint32_t frame)
+{
+	Slot& slot{ m_Slots[frame] };
+	for (Statistics& statistics: m_Statistics)
+		statistics.Updated = false;
+	// a slot that was never submitted holds queries that were never reset, reading them is invalid
+	if (slot.Submitted)
+		Collect(context, slot);
+
+	vkCmdResetQueryPool(commandBuffer, slot.QueryPool, 0, m_MaxScopes * 2);
+	std::ranges::fill(slot.Recorded, false);
+	slot.Submitted = true;
+	m_Current      = &slot;
+}
+
+void FrameTimer::CollectPending(vkc::Context const& context)
+{
+	// a collected slot is not read again, BeginFrame only resets it
+	for (Slot& slot: m_Slots)
+		if (slot.Submitted)
+		{
+			Collect(context, slot);
+			slot.Submitted = false;
+		}
+}
+
+void FrameTimer::ResetStatistics()
+{
+	std::ranges::fill(m_Statistics, Statistics{});
+}
+
+void FrameTimer::Begin(vkc::CommandBuffer const& commandBuffer, Scope scope) const
+{
+	assert(m_Current && "BeginFrame was not recorded");
+	vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_Current->QueryPool, scope * 2);
+}
+
+void FrameTimer::End(vkc::CommandBuffer const& commandBuffer, Scope scope)
+{
+	assert(m_Current && "BeginFrame was not recorded");
+	assert(!m_Current->Recorded[scope] && "scope was already recorded this frame");
+	vkCmdWriteTimestamp2(commandBuffer, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, m_Current->QueryPool, scope * 2 + 1);
+	m_Current->Recorded[scope] = true;
+}
+
+void FrameTimer::Collect(vkc::Context const& context, Slot& slot)
+{
+	// without WAIT the call returns VK_NOT_READY when anything is missing, availability says which pairs are complete
+	uint32_t const queryCount{ static_cast<uint32_t>(m_Labels.size()) * 2 };
+	if (queryCount == 0)
+		return;
+	VkResult const result{
+		context.DispatchTable.getQueryPoolResults(slot.QueryPool
+												  , 0
+												  , queryCount
+												  , queryCount * 2 * sizeof(uint64_t)
+												  , m_Results.data()
+												  , 2 * sizeof(uint64_t)
+												  , VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT)
+	};
+	if (result != VK_SUCCESS && result != VK_NOT_READY)
+		return;
+
+	static double constexpr nsToMs{ 1. / static_cast<double>(std::micro::den) };
+	for (Scope scope{}; scope < m_Labels.size(); ++scope)
+	{
+		if (!slot.Recorded[scope])
+			continue;
+
+		Statistics&     statistics{ m_Statistics[scope] };
+		uint64_t const* begin{ &m_Results[scope * 4] };
+		uint64_t const* end{ begin + 2 };
+		if (!begin[1] || !end[1])
+		{
+			++statistics.Dropped;
+			continue;
+		}
+
+		double const milliseconds{ static_cast<double>(end[0] - begin[0]) * m_TimestampPeriod * nsToMs };
+		++statistics.Frames;
+		statistics.TotalMilliseconds += milliseconds;
+		statistics.MaxMilliseconds  = std::max(statistics.MaxMilliseconds, milliseconds);
+		statistics.LastMilliseconds = milliseconds;
+		statistics.Updated          = true;
+		if (m_Tracer)
+			m_Tracer->AddGpu(m_Labels[scope], m_TracerQueue, begin[0], end[0]);
+	}
+}
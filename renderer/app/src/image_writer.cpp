@@ -0,0 +1,123 @@
+#include "image_writer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iostream>
+
+#include "file_saver.h"
+
+ImageWriter::ImageWriter(uint32_t workerCount, size_t maxQueued)
+	: m_MaxQueued{ std::max<size_t>(maxQueued, 1) }
+{
+	if (workerCount == 0)
+		workerCount = std::max(std::thread::hardware_concurrency(), 1u);
+
+	m_Workers.reserve(workerCount);
+	for (uint32_t index{}; index < workerCount; ++index)
+		m_Workers.emplace_back(&ImageWriter::Work, this);
+}
+
+ImageWriter::~ImageWriter()
+{
+	//
+	{
+		std::lock_guard const lock{ m_Mutex };
+		m_Stopping = true;
+	}
+	m_JobAvailable.notify_all();
+	for (std::thread& worker: m_Workers)
+		worker.join();
+}
+
+void ImageWriter::Submit
+(
+	std::span<std::byte const> pixels
+	, int                      width
+	, int                      height
+	, bool                     hdr
+	, std::filesystem::path    path
+	, std::function<void()>    release
+)
+{
+	path += hdr ? ".exr" : ".png";
+	//
+	{
+		std::unique_lock lock{ m_Mutex };
+		if (m_Queue.size() >= m_MaxQueued)
+		{
+			auto const start{ std::chrono::steady_clock::now() };
+			m_SlotAvailable.wait(lock, [this] { return m_Queue.size() < m_MaxQueued; });
+			m_Statistics.BlockedSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		}
+		m_Queue.emplace_back(Job{ pixels, width, height, hdr, std::move(path), std::move(release) });
+	}
+	m_JobAvailable.notify_one();
+}
+
+void ImageWriter::Flush()
+{
+	std::unique_lock lock{ m_Mutex };
+	m_Idle.wait(lock, [this] { return m_Queue.empty() && m_Busy == 0; });
+}
+
+ImageWriter::Statistics ImageWriter::GetStatistics() const
+{
+	std::lock_guard const lock{ m_Mutex };
+	return m_Statistics;
+}
+
+void ImageWriter::Work()
+{
+	while (true)
+	{
+		Job job{};
+		//
+		{
+			std::unique_lock lock{ m_Mutex };
+			m_JobAvailable.wait(lock, [this] { return m_Stopping || !m_Queue.empty(); });
+			// the queue is drained before stopping, nothing submitted is dropped
+			if (m_Queue.empty())
+				return;
+
+			job = std::move(m_Queue.front());
+			m_Queue.pop_front();
+			++m_Busy;
+		}
+		m_SlotAvailable.notify_one();
+
+		auto const start{ std::chrono::steady_clock::now() };
+		bool       failed{};
+		try
+		{
+			std::filesystem::create_directories(job.Path.parent_path());
+			if (job.Hdr)
+				SaveEXRFile(job.Pixels.data(), job.Width, job.Height, job.Path);
+			else
+				SavePNGFile(job.Pixels.data(), job.Width, job.Height, job.Path);
+		}
+		catch (std::exception const& error)
+		{
+			std::cerr << "failed to write " << job.Path << ": " << error.what() << std::endl;
+			failed = true;
+		}
+
+		double const seconds{ std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() };
+		if (job.Release)
+			job.Release();
+
+		bool idle{};
+		//
+		{
+			std::lock_guard const lock{ m_Mutex };
+			--m_Busy;
+			++m_Statistics.Images;
+			if (failed)
+				++m_Statistics.Failed;
+			m_Statistics.EncodeSeconds += seconds;
+			idle = m_Queue.empty() && m_Busy == 0;
+		}
+		if (idle)
+			m_Idle.notify_all();
+	}
+}
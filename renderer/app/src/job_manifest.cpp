@@ -0,0 +1,86 @@
+#include "job_manifest.h"
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_set>
+
+namespace
+{
+	RenderJob ParseJob(std::string const& line, LaunchOptions const& defaults)
+	{
+		std::istringstream stream{ line };
+		RenderJob          job{ {}, defaults.CameraPosition, defaults.CameraForward, defaults.Fov, defaults.Time, defaults.Hdr, defaults.UseSkyview };
+		stream >> job.Name;
+		if (job.Name.starts_with("--"))
+			throw std::runtime_error("expected a job name before " + job.Name);
+
+		std::string option{};
+		while (stream >> option)
+		{
+			if (option == "--hdr")
+			{
+				job.Hdr = true;
+				continue;
+			}
+			if (option == "--skyview")
+			{
+				job.UseSkyview = true;
+				continue;
+			}
+
+			std::string value{};
+			if (!(stream >> value))
+				throw std::runtime_error("missing value for " + option);
+
+			if (option == "--camera")
+				job.CameraPosition = ParseVec3(value, option);
+			else if (option == "--forward")
+				job.CameraForward = ParseVec3(value, option);
+			else if (option == "--fov")
+				job.Fov = ParseFloat(value, option);
+			else if (option == "--time")
+				job.Time = ParseFloat(value, option);
+			else
+				throw std::runtime_error("unknown job option " + option);
+		}
+
+		if (glm::length(job.CameraForward) < 1e-6f)
+			throw std::runtime_error("--forward must not be a zero vector");
+		return job;
+	}
+}
+
+std::vector<RenderJob> LoadJobManifest(std::filesystem::path const& path, LaunchOptions const& defaults)
+{
+	std::ifstream file{ path };
+	if (!file)
+		throw std::runtime_error("failed to open job manifest " + path.string());
+
+	std::vector<RenderJob>          jobs{};
+	std::unordered_set<std::string> names{};
+	std::string                     line{};
+	for (size_t lineNumber{ 1 }; std::getline(file, line); ++lineNumber)
+	{
+		size_t const first{ line.find_first_not_of(" \t\r") };
+		if (first == std::string::npos || line[first] == '#')
+			continue;
+
+		try
+		{
+			RenderJob job{ ParseJob(line, defaults) };
+			// every job writes its own file, a repeated name would silently overwrite an earlier image
+			if (!names.insert(job.Name).second)
+				throw std::runtime_error("duplicate job name " + job.Name);
+			jobs.emplace_back(std::move(job));
+		}
+		catch (std::runtime_error const& error)
+		{
+			throw std::runtime_error(path.string() + ":" + std::to_string(lineNumber) + ": " + error.what());
+		}
+	}
+
+	if (jobs.empty())
+		throw std::runtime_error("job manifest " + path.string() + " has no jobs");
+	return jobs;
+}
@@ -0,0 +1,305 @@
+#include "launch_options.h"
+
+#include <charconv>
+#include <cmath>
+#include <stdexcept>
+#include <string_view>
+
+namespace
+{
+	int ParsePositiveInt(std::string_view text, std::string_view option)
+	{
+		int value{};
+		auto const [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+		if (error != std::errc{} || end != text.data() + text.size() || value <= 0)
+			throw std::runtime_error("invalid positive integer \"" + std::string(text) + "\" for " + std::string(option));
+		return value;
+	}
+
+	uint32_t ParseNonNegativeInt(std::string_view text, std::string_view option)
+	{
+		uint32_t value{};
+		auto const [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+		if (error != std::errc{} || end != text.data() + text.size())
+			throw std::runtime_error("invalid non-negative integer \"" + std::string(text) + "\" for " + std::string(option));
+		return value;
+	}
+
+	glm::uvec3 ParseResolution(std::string_view text, std::string_view option)
+	{
+		glm::vec3  value{ ParseVec3(text, option) };
+		glm::uvec3 result{};
+		for (int component{}; component < 3; ++component)
+		{
+			if (value[component] < 1.f || std::floor(value[component]) != value[component])
+				throw std::runtime_error("expected positive integers x,y,z for " + std::string(option));
+			result[component] = static_cast<uint32_t>(value[component]);
+		}
+		return result;
+	}
+
+	Command ParseCommand(std::string_view name)
+	{
+		if (name == "render")
+			return Command::Render;
+		if (name == "profile")
+			return Command::Profile;
+		if (name == "all-configs")
+			return Command::AllConfigs;
+		if (name == "batch")
+			return Command::Batch;
+		if (name == "lut-bake")
+			return Command::LUTBake;
+		throw std::runtime_error("unknown command \"" + std::string(name) + "\"");
+	}
+
+	LUTPath ParseLUTPath(std::string_view name)
+	{
+		if (name == "fragment")
+			return LUTPath::Fragment;
+		if (name == "compute")
+			return LUTPath::Compute;
+		if (name == "cpu")
+			return LUTPath::Cpu;
+		throw std::runtime_error("unknown LUT path \"" + std::string(name) + "\"");
+	}
+
+	QualityTier ParseQualityTier(std::string_view name)
+	{
+		for (uint32_t index{}; index < QUALITY_TIER_COUNT; ++index)
+			if (name == GetQualityTierName(static_cast<QualityTier>(index)))
+				return static_cast<QualityTier>(index);
+		throw std::runtime_error("unknown quality tier \"" + std::string(name) + "\"");
+	}
+}
+
+QualitySettings GetQualitySettings(QualityTier tier)
+{
+	switch (tier)
+	{
+	case QualityTier::Low:
+		return { 12, 8, 16, 10, { 128, 32 }, { 16, 16 }, { 96, 48 } };
+	case QualityTier::Medium:
+		return { 24, 12, 24, 14, { 192, 48 }, { 32, 32 }, { 160, 80 } };
+	case QualityTier::High:
+		return {};
+	case QualityTier::Reference:
+		return { 160, 80, 160, 40, { 512, 128 }, { 64, 64 }, { 400, 200 } };
+	}
+	throw std::runtime_error("unknown quality tier");
+}
+
+std::string_view GetQualityTierName(QualityTier tier)
+{
+	switch (tier)
+	{
+	case QualityTier::Low:
+		return "low";
+	case QualityTier::Medium:
+		return "medium";
+	case QualityTier::High:
+		return "high";
+	case QualityTier::Reference:
+		return "reference";
+	}
+	throw std::runtime_error("unknown quality tier");
+}
+
+float ParseFloat(std::string_view text, std::string_view option)
+{
+	float value{};
+	auto const [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+	if (error != std::errc{} || end != text.data() + text.size())
+		throw std::runtime_error("invalid number \"" + std::string(text) + "\" for " + std::string(option));
+	return value;
+}
+
+glm::vec3 ParseVec3(std::string_view text, std::string_view option)
+{
+	glm::vec3 result{};
+	for (int component{}; component < 3; ++component)
+	{
+		size_t const separator{ text.find(',') };
+		if ((component < 2) == (separator == std::string_view::npos))
+			throw std::runtime_error("expected x,y,z for " + std::string(option));
+
+		result[component] = ParseFloat(text.substr(0, separator), option);
+		if (separator != std::string_view::npos)
+			text.remove_prefix(separator + 1);
+	}
+	return result;
+}
+
+LaunchOptions ParseLaunchOptions(int argc, char const* const argv[])
+{
+	LaunchOptions options{};
+	// the march switches are applied after --quality, which replaces the whole QualitySettings
+	bool adaptiveMarch{ false };
+	bool opticalDepthLUT{ false };
+
+	int index{ 1 };
+	if (index < argc && !std::string_view{ argv[index] }.starts_with("--"))
+		options.Mode = ParseCommand(argv[index++]);
+
+	for (; index < argc; ++index)
+	{
+		std::string_view const option{ argv[index] };
+
+		if (option == "--hdr")
+		{
+			options.Hdr = true;
+			continue;
+		}
+		if (option == "--skyview")
+		{
+			options.UseSkyview = true;
+			continue;
+		}
+		if (option == "--no-lut-cache")
+		{
+			options.LUTCachePath.clear();
+			continue;
+		}
+		if (option == "--no-pipeline-cache")
+		{
+			options.PipelineCachePath.clear();
+			continue;
+		}
+		if (option == "--adaptive-march")
+		{
+			adaptiveMarch = true;
+			continue;
+		}
+		if (option == "--optical-depth-lut")
+		{
+			opticalDepthLUT = true;
+			continue;
+		}
+		if (option == "--benchmark-resolutions")
+		{
+			options.BenchmarkResolutions = true;
+			continue;
+		}
+
+		if (index + 1 >= argc)
+			throw std::runtime_error("missing value for " + std::string(option));
+		std::string_view const value{ argv[++index] };
+
+		if (option == "--width")
+			options.Width = ParsePositiveInt(value, option);
+		else if (option == "--height")
+			options.Height = ParsePositiveInt(value, option);
+		else if (option == "--camera")
+			options.CameraPosition = ParseVec3(value, option);
+		else if (option == "--forward")
+			options.CameraForward = ParseVec3(value, option);
+		else if (option == "--fov")
+			options.Fov = ParseFloat(value, option);
+		else if (option == "--time")
+			options.Time = ParseFloat(value, option);
+		else if (option == "--output")
+			options.OutputDirectory = value;
+		else if (option == "--lut-cache")
+			options.LUTCachePath = value;
+		else if (option == "--pipeline-cache")
+			options.PipelineCachePath = value;
+		else if (option == "--froxels")
+			options.AerialPerspectiveResolution = ParseResolution(value, option);
+		else if (option == "--skyview-rows")
+			options.SkyviewRowsPerFrame = static_cast<uint32_t>(ParsePositiveInt(value, option));
+		else if (option == "--skyview-bake")
+			options.SkyviewArraySlices = static_cast<uint32_t>(ParsePositiveInt(value, option));
+		else if (option == "--sky-scale")
+		{
+			options.SkyScale = static_cast<uint32_t>(ParsePositiveInt(value, option));
+			if (options.SkyScale > 4)
+				throw std::runtime_error("--sky-scale must be 1 to 4");
+		}
+		else if (option == "--sky-temporal")
+		{
+			options.SkyPattern = static_cast<uint32_t>(ParsePositiveInt(value, option));
+			if (options.SkyPattern != 2 && options.SkyPattern != 4)
+				throw std::runtime_error("--sky-temporal must be 2 or 4");
+		}
+		else if (option == "--jobs")
+			options.JobManifest = value;
+		else if (option == "--frame-log")
+			options.FrameLogPath = value;
+		else if (option == "--trace")
+			options.TracePath = value;
+		else if (option == "--results")
+			options.BenchmarkResults = value;
+		else if (option == "--samples")
+			options.BenchmarkSamples = static_cast<uint32_t>(ParsePositiveInt(value, option));
+		else if (option == "--profile-batch")
+			options.Profiling.Repetitions = static_cast<uint32_t>(ParsePositiveInt(value, option));
+		else if (option == "--profile-warmup")
+			options.Profiling.Warmup = ParseNonNegativeInt(value, option);
+		else if (option == "--lut-path")
+			options.LUTs = ParseLUTPath(value);
+		else if (option == "--quality")
+		{
+			options.Tier    = ParseQualityTier(value);
+			options.Quality = GetQualitySettings(options.Tier);
+		}
+		else
+			throw std::runtime_error("unknown option " + std::string(option));
+	}
+
+	options.Quality.AdaptiveScattering = adaptiveMarch;
+	options.Quality.OpticalDepthLUT    = opticalDepthLUT;
+
+	if (glm::length(options.CameraForward) < 1e-6f)
+		throw std::runtime_error("--forward must not be a zero vector");
+	if (options.Mode == Command::Batch && options.JobManifest.empty())
+		throw std::runtime_error("batch requires --jobs <manifest>");
+	if (options.SkyScale > 1 && options.SkyPattern > 1)
+		throw std::runtime_error("--sky-scale and --sky-temporal cannot be combined");
+	if (options.Mode == Command::LUTBake && options.LUTs == LUTPath::Cpu)
+		throw std::runtime_error("lut-bake compares against the GPU LUTs, --lut-path cpu has nothing to compare to");
+
+	return options;
+}
+
+std::string GetUsage()
+{
+	return
+		"usage: VulkanResearch [command] [options]\n"
+		"commands (omit to open the interactive window):\n"
+		"  render               render a single image offscreen and save it\n"
+		"  profile              profile every pass and dump timings to csv\n"
+		"  all-configs          render sdr and hdr images with and without sky-view LUT\n"
+		"  batch                render every job of a manifest, see --jobs\n"
+		"  lut-bake             bake the static LUTs on the CPU per thread count and diff them against the GPU\n"
+		"options:\n"
+		"  --width <px>         render width, default 1920\n"
+		"  --height <px>        render height, default 1080\n"
+		"  --camera <x,y,z>     camera position in meters, default 0,1000,0\n"
+		"  --forward <x,y,z>    camera view direction, default 1,0,0\n"
+		"  --fov <degrees>      vertical field of view, default 45\n"
+		"  --time <seconds>     fixed time driving the sun altitude, default run time\n"
+		"  --output <dir>       directory for images and dumps, default current\n"
+		"  --hdr                save exr instead of png (render)\n"
+		"  --skyview            start with the sky-view LUT enabled\n"
+		"  --lut-cache <file>   transmittance and multiple scattering cache, default lut_cache.bin\n"
+		"  --no-lut-cache       always generate the static LUTs on the GPU\n"
+		"  --pipeline-cache <file> driver pipeline cache, default pipeline_cache.bin\n"
+		"  --no-pipeline-cache  do not load or save the pipeline cache\n"
+		"  --jobs <file>        batch job manifest, one \"name [--camera] [--forward] [--fov] [--time] [--hdr] [--skyview]\" per line\n"
+		"  --frame-log <file>   per-frame cpu, fence, acquire, present and gpu pass times as csv (interactive)\n"
+		"  --trace <file>       cpu and gpu timeline as Chrome trace json for Perfetto (interactive)\n"
+		"  --results <file>     benchmark json, relative to --output, default benchmark.json\n"
+		"  --samples <n>        benchmark samples timed per pass and scenario, default 200\n"
+		"  --benchmark-resolutions run the benchmark at 1920x1080, 2560x1440 and 3840x2160, one results file each\n"
+		"  --profile-batch <n>  time n repetitions per submission (profile, benchmark), default one submission per sample\n"
+		"  --profile-warmup <n> untimed repetitions ahead of every batch, 0 for none, default 2\n"
+		"  --lut-path <path>    fragment, compute or cpu LUT generation, default compute\n"
+		"  --adaptive-march     scale the sky ray march steps with the air along each ray and stop once it is opaque\n"
+		"  --optical-depth-lut  take the sky ray march transmittance from a precomputed optical depth LUT\n"
+		"  --quality <tier>     low, medium, high or reference sample counts and LUT sizes, default high, F2 cycles them (interactive)\n"
+		"  --froxels <x,y,z>    aerial perspective volume resolution, default 32,32,32\n"
+		"  --skyview-rows <n>   sky-view LUT rows redrawn per frame (interactive), default all\n"
+		"  --skyview-bake <n>   pre-bake the sky-view LUT for n sun elevations at the launch camera\n"
+		"  --sky-scale <n>      ray march the sky at 1/n resolution and upsample it around the geometry (interactive), 1 to 4, default 1\n"
+		"  --sky-temporal <n>   ray march a checkerboard (2) or one pixel of every 2x2 block (4) per frame and reproject the rest (interactive)\n";
+}
@@ -0,0 +1,535 @@
+#include "lut_baker.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <thread>
+
+#include "glm/glm.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VULKANRESEARCH_LUTBAKER_SSE
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	// one value per wavelength, the vec4 of the shaders
+	struct Float4
+	{
+#ifdef VULKANRESEARCH_LUTBAKER_SSE
+		__m128 V;
+
+		Float4()
+			: V{ _mm_setzero_ps() }
+		{
+		}
+
+		explicit Float4(__m128 value)
+			: V{ value }
+		{
+		}
+
+		explicit Float4(float value)
+			: V{ _mm_set1_ps(value) }
+		{
+		}
+
+		Float4(float x, float y, float z, float w)
+			: V{ _mm_setr_ps(x, y, z, w) }
+		{
+		}
+
+		[[nodiscard]] std::array<float, 4> ToArray() const
+		{
+			std::array<float, 4> result{};
+			_mm_storeu_ps(result.data(), V);
+			return result;
+		}
+
+		friend Float4 operator+(Float4 lhs, Float4 rhs) { return Float4{ _mm_add_ps(lhs.V, rhs.V) }; }
+		friend Float4 operator-(Float4 lhs, Float4 rhs) { return Float4{ _mm_sub_ps(lhs.V, rhs.V) }; }
+		friend Float4 operator*(Float4 lhs, Float4 rhs) { return Float4{ _mm_mul_ps(lhs.V, rhs.V) }; }
+		friend Float4 operator/(Float4 lhs, Float4 rhs) { return Float4{ _mm_div_ps(lhs.V, rhs.V) }; }
+#else
+		std::array<float, 4> V{};
+
+		Float4() = default;
+
+		explicit Float4(float value)
+			: V{ value, value, value, value }
+		{
+		}
+
+		Float4(float x, float y, float z, float w)
+			: V{ x, y, z, w }
+		{
+		}
+
+		[[nodiscard]] std::array<float, 4> ToArray() const
+		{
+			return V;
+		}
+
+		template<typename Operation>
+		static Float4 Apply(Float4 lhs, Float4 rhs, Operation operation)
+		{
+			return Float4{ operation(lhs.V[0], rhs.V[0]), operation(lhs.V[1], rhs.V[1]), operation(lhs.V[2], rhs.V[2]), operation(lhs.V[3], rhs.V[3]) };
+		}
+
+		friend Float4 operator+(Float4 lhs, Float4 rhs) { return Apply(lhs, rhs, std::plus{}); }
+		friend Float4 operator-(Float4 lhs, Float4 rhs) { return Apply(lhs, rhs, std::minus{}); }
+		friend Float4 operator*(Float4 lhs, Float4 rhs) { return Apply(lhs, rhs, std::multiplies{}); }
+		friend Float4 operator/(Float4 lhs, Float4 rhs) { return Apply(lhs, rhs, std::divides{}); }
+#endif
+
+		friend Float4 operator*(Float4 lhs, float rhs) { return lhs * Float4{ rhs }; }
+		friend Float4 operator*(float lhs, Float4 rhs) { return Float4{ lhs } * rhs; }
+		friend Float4 operator+(Float4 lhs, float rhs) { return lhs + Float4{ rhs }; }
+
+		Float4& operator+=(Float4 rhs) { return *this = *this + rhs; }
+		Float4& operator*=(Float4 rhs) { return *this = *this * rhs; }
+	};
+
+	// Cephes expf, relative error around 1e-7 over the clamped range, which is below what the 16 bit LUT formats keep
+	Float4 Exp(Float4 x)
+	{
+#ifdef VULKANRESEARCH_LUTBAKER_SSE
+		__m128 const one{ _mm_set1_ps(1.f) };
+		__m128       value{ _mm_min_ps(_mm_max_ps(x.V, _mm_set1_ps(-88.3762626647949f)), _mm_set1_ps(88.3762626647949f)) };
+
+		// n = floor(x / ln2 + .5), truncation rounds negative values up so one is taken back where it did
+		__m128       fx{ _mm_add_ps(_mm_mul_ps(value, _mm_set1_ps(1.44269504088896341f)), _mm_set1_ps(.5f)) };
+		__m128 const truncated{ _mm_cvtepi32_ps(_mm_cvttps_epi32(fx)) };
+		fx = _mm_sub_ps(truncated, _mm_and_ps(_mm_cmpgt_ps(truncated, fx), one));
+
+		// x - n * ln2 in two parts to keep precision
+		value = _mm_sub_ps(value, _mm_mul_ps(fx, _mm_set1_ps(.693359375f)));
+		value = _mm_sub_ps(value, _mm_mul_ps(fx, _mm_set1_ps(-2.12194440e-4f)));
+
+		__m128 y{ _mm_set1_ps(1.9875691500e-4f) };
+		for (float const coefficient: { 1.3981999507e-3f, 8.3334519073e-3f, 4.1665795894e-2f, 1.6666665459e-1f, 5.0000001201e-1f })
+			y = _mm_add_ps(_mm_mul_ps(y, value), _mm_set1_ps(coefficient));
+		y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(y, _mm_mul_ps(value, value)), value), one);
+
+		// 2^n built directly in the exponent bits
+		__m128i const exponent{ _mm_slli_epi32(_mm_add_epi32(_mm_cvttps_epi32(fx), _mm_set1_epi32(0x7f)), 23) };
+		return Float4{ _mm_mul_ps(y, _mm_castsi128_ps(exponent)) };
+#else
+		std::array<float, 4> const values{ x.ToArray() };
+		return Float4{ std::exp(values[0]), std::exp(values[1]), std::exp(values[2]), std::exp(values[3]) };
+#endif
+	}
+
+	// atmosphere_constants.glsl, spectral_constants.glsl and math_constants.glsl
+	float constexpr PI{ 3.14159265358f };
+	float constexpr GROUND_RADIUS{ 6371.f };
+	float constexpr ATMOSPHERE_RADIUS{ 6471.f };
+	float constexpr GROUND_ALBEDO{ .3f };
+	float constexpr MIE_SCATTERING_COEF{ 3.996e-3f };
+	float constexpr MIE_ABSORPTION_COEF{ 4.4e-3f };
+	float constexpr OZONE_MEAN{ 347.f };
+
+	std::array constexpr RAYLEIGH_SCATTERING_COEF{ 5.802e-3f, 13.558e-3f, 33.1e-3f, .0f };
+	std::array constexpr OZONE_ABSORPTION_COEF{ .650e-3f, 1.881e-3f, .085e-3f, .0f };
+	std::array constexpr MOLECULAR_SCATTERING_COEF{ 6.605e-3f, 1.067e-2f, 1.842e-2f, 3.156e-2f };
+	std::array constexpr OZONE_ABSORPTION_CROSS_SECTION{ 3.472e-25f, 3.914e-25f, 1.349e-25f, 11.03e-27f };
+
+	Float4 Load(std::array<float, 4> const& values)
+	{
+		return Float4{ values[0], values[1], values[2], values[3] };
+	}
+
+	// math_functions.glsl
+	float RayIntersectSphere(glm::vec3 const& origin, glm::vec3 const& direction, float radius)
+	{
+		float const b{ glm::dot(origin, direction) };
+		float const c{ glm::dot(origin, origin) - radius * radius };
+		if (c > .0f && b > .0f)
+			return -1.f;
+		float const discriminant{ b * b - c };
+		if (discriminant < .0f)
+			return -1.f;
+		if (discriminant > b * b)
+			return -b + std::sqrt(discriminant);
+		return -b - std::sqrt(discriminant);
+	}
+
+	float SafeAcos(float x)
+	{
+		return std::acos(std::clamp(x, -1.f, 1.f));
+	}
+
+	glm::vec3 FindSphericalDirection(float theta, float phi)
+	{
+		return glm::vec3{ std::sin(phi) * std::sin(theta), std::cos(phi), std::sin(phi) * std::cos(theta) };
+	}
+
+	// atmosphere_functions.glsl and spectral_functions.glsl
+	float FindAltitude(glm::vec3 const& position)
+	{
+		return std::max(1e-4f, glm::length(position) - GROUND_RADIUS);
+	}
+
+	float MiePhase(float cosTheta)
+	{
+		float constexpr strength{ .8f };
+		float const     numerator{ 3.f * (1.f - strength * strength) * (1.f + cosTheta * cosTheta) };
+		float const     denominator{
+			8.f * PI * (2.f + strength * strength) * std::pow(1.f + strength * strength - 2.f * strength * cosTheta, 1.5f)
+		};
+		return numerator / denominator;
+	}
+
+	float RayleighPhase(float cosTheta)
+	{
+		return 3.f * (1.f + cosTheta * cosTheta) / (16.f * PI);
+	}
+
+	float MieScattering(float altitude)
+	{
+		return MIE_SCATTERING_COEF * std::exp(-altitude / 1.2f);
+	}
+
+	template<bool Spectral>
+	Float4 ScatteringCoef(float altitude)
+	{
+		if constexpr (Spectral)
+			return Load(MOLECULAR_SCATTERING_COEF) * std::exp(-.07771971f * std::pow(altitude, 1.16364243f));
+		else
+			return Load(RAYLEIGH_SCATTERING_COEF) * std::exp(-altitude / 8.f);
+	}
+
+	// the rgb extinction leaves w at zero like vec4(ExtinctionCoef(altitude), .0f)
+	template<bool Spectral>
+	Float4 ExtinctionCoef(float altitude)
+	{
+		float const mieExtinction{ (MIE_SCATTERING_COEF + MIE_ABSORPTION_COEF) * std::exp(-altitude / 1.2f) };
+		if constexpr (Spectral)
+		{
+			float const t{ std::log(altitude) - 3.22261f };
+			float const density{ 3.78547397e20f * (1.f / altitude) * std::exp(-t * t * 5.55555555f) };
+			return Load(OZONE_ABSORPTION_CROSS_SECTION) * (OZONE_MEAN * density) + ScatteringCoef<true>(altitude) + mieExtinction;
+		}
+		else
+		{
+			float const ozoneDensity{ std::max(.0f, 1.f - std::abs(altitude - 25.f) / 15.f) };
+			return ScatteringCoef<false>(altitude) + Load(OZONE_ABSORPTION_COEF) * ozoneDensity + Float4{ mieExtinction, mieExtinction, mieExtinction, .0f };
+		}
+	}
+
+	// CalculateTransmittance in transmittance_lut.glsl
+	// the step transmittances are multiplied, so their exponents are summed and exponentiated once
+	template<bool Spectral>
+	Float4 CalculateTransmittance(glm::vec3 const& position, float cosTheta, int samples)
+	{
+		float const     sinTheta{ std::sqrt(std::max(.0f, 1.f - cosTheta * cosTheta)) };
+		glm::vec3 const direction{ glm::normalize(glm::vec3{ .0f, cosTheta, sinTheta }) };
+		if (RayIntersectSphere(position, direction, GROUND_RADIUS) > .0f)
+			return Float4{};
+
+		float const distanceToAtmosphere{ RayIntersectSphere(position, direction, ATMOSPHERE_RADIUS) };
+
+		float  t{};
+		Float4 exponent{};
+		for (int step{}; step < samples; ++step)
+		{
+			float const newT{ (static_cast<float>(step) + .3f) / static_cast<float>(samples) * distanceToAtmosphere };
+			float const deltaT{ newT - t };
+			t = newT;
+
+			exponent += ExtinctionCoef<Spectral>(FindAltitude(position + t * direction)) * deltaT;
+		}
+		return Exp(exponent * -1.f);
+	}
+
+	// texture() on the transmittance LUT: bilinear, u repeats and v clamps like the LUT sampler
+	class TransmittanceSampler final
+	{
+	public:
+		TransmittanceSampler(std::span<uint16_t const> texels, LUTSize size)
+			: m_Size{ size }
+		{
+			// the GPU samples the UNORM texels, not the unquantized values
+			m_Texels.reserve(static_cast<size_t>(size.Width) * size.Height);
+			for (size_t texel{}; texel < texels.size(); texel += 4)
+				m_Texels.emplace_back(texels[texel] / 65535.f, texels[texel + 1] / 65535.f, texels[texel + 2] / 65535.f, texels[texel + 3] / 65535.f);
+		}
+
+		// SampleLUT in atmosphere_functions.glsl
+		[[nodiscard]] Float4 Sample(float altitude, float cosTheta) const
+		{
+			float const u{ std::clamp(.5f + .5f * cosTheta, .0f, 1.f) };
+			float const v{ std::clamp(altitude / (ATMOSPHERE_RADIUS - GROUND_RADIUS), .0f, 1.f) };
+
+			float const x{ u * static_cast<float>(m_Size.Width) - .5f };
+			float const y{ v * static_cast<float>(m_Size.Height) - .5f };
+			float const x0{ std::floor(x) };
+			float const y0{ std::floor(y) };
+			float const fx{ x - x0 };
+			float const fy{ y - y0 };
+
+			int const  width{ static_cast<int>(m_Size.Width) };
+			int const  height{ static_cast<int>(m_Size.Height) };
+			auto const wrap  = [width](int index) { return (index % width + width) % width; };
+			auto const clamp = [height](int index) { return std::clamp(index, 0, height - 1); };
+			int const  left{ wrap(static_cast<int>(x0)) };
+			int const  right{ wrap(static_cast<int>(x0) + 1) };
+			int const  bottom{ clamp(static_cast<int>(y0)) };
+			int const  top{ clamp(static_cast<int>(y0) + 1) };
+
+			Float4 const lower{ Fetch(left, bottom) * (1.f - fx) + Fetch(right, bottom) * fx };
+			Float4 const upper{ Fetch(left, top) * (1.f - fx) + Fetch(right, top) * fx };
+			return lower * (1.f - fy) + upper * fy;
+		}
+
+	private:
+		[[nodiscard]] Float4 Fetch(int x, int y) const
+		{
+			return m_Texels[static_cast<size_t>(y) * m_Size.Width + x];
+		}
+
+		std::vector<Float4> m_Texels;
+		LUTSize             m_Size;
+	};
+
+	// CalculateMultipleScattering and MultScatteringLUTTexel in multiple_scattering_lut.glsl
+	template<bool Spectral>
+	Float4 CalculateMultipleScattering
+	(
+		TransmittanceSampler const&   transmittanceLUT
+		, glm::vec3 const&            position
+		, glm::vec3 const&            sunDirection
+		, int                         sqrtSamples
+		, int                         samples
+	)
+	{
+		Float4      totalLuminance{};
+		Float4      fms{};
+		float const invSamples{ 1.f / static_cast<float>(sqrtSamples * sqrtSamples) };
+
+		for (int x{}; x < sqrtSamples; ++x)
+			for (int y{}; y < sqrtSamples; ++y)
+			{
+				float const     theta{ PI * (static_cast<float>(x) + .5f) / static_cast<float>(sqrtSamples) };
+				float const     phi{ SafeAcos(1.f - 2.f * (static_cast<float>(y) + .5f) / static_cast<float>(sqrtSamples)) };
+				glm::vec3 const rayDirection{ FindSphericalDirection(theta, phi) };
+
+				float const distanceToExit{ RayIntersectSphere(position, rayDirection, ATMOSPHERE_RADIUS) };
+				float const distanceToGround{ RayIntersectSphere(position, rayDirection, GROUND_RADIUS) };
+				float const tMax{ distanceToGround > .0f ? distanceToGround : distanceToExit };
+
+				float const cosTheta{ glm::dot(rayDirection, sunDirection) };
+				float const miePhase{ MiePhase(cosTheta) };
+				float const rayleighPhase{ RayleighPhase(cosTheta) };
+
+				Float4 luminance{};
+				Float4 luminanceFactor{};
+				Float4 transmittance{ 1.f };
+				float  t{};
+				for (int step{}; step < samples; ++step)
+				{
+					float const newT{ (static_cast<float>(step) + .3f) / static_cast<float>(samples) * tMax };
+					float const deltaT{ newT - t };
+					t = newT;
+
+					glm::vec3 const newPosition{ position + t * rayDirection };
+					float const     newAltitude{ FindAltitude(newPosition) };
+					float const     mieScattering{ MieScattering(newAltitude) };
+					Float4 const    rayleighScattering{ ScatteringCoef<Spectral>(newAltitude) };
+					Float4 const    extinction{ ExtinctionCoef<Spectral>(newAltitude) };
+					Float4 const    stepTransmittance{ Exp(extinction * -deltaT) };
+
+					Float4 const scatteringNoPhase{ rayleighScattering + mieScattering };
+					Float4 const scatteringF{ (scatteringNoPhase - scatteringNoPhase * stepTransmittance) / extinction };
+					luminanceFactor += transmittance * scatteringF;
+
+					float const  sunZenithCosAngle{ glm::dot(sunDirection, glm::normalize(newPosition)) };
+					Float4 const sunTransmittance{ transmittanceLUT.Sample(newAltitude, sunZenithCosAngle) };
+					Float4 const totalInScattering{ (rayleighScattering * rayleighPhase + mieScattering * miePhase) * sunTransmittance };
+
+					Float4 const scatteringIntegral{ (totalInScattering - totalInScattering * stepTransmittance) / extinction };
+
+					luminance += scatteringIntegral * transmittance;
+					transmittance *= stepTransmittance;
+				}
+
+				// ground's contribution to luminance
+				if (distanceToGround > .0f)
+				{
+					glm::vec3 const groundNormal{ glm::normalize(position + distanceToGround * rayDirection) };
+					if (float const groundCosTheta{ glm::dot(groundNormal, sunDirection) }; groundCosTheta > .0f)
+						luminance += transmittance * GROUND_ALBEDO * transmittanceLUT.Sample(FindAltitude(groundNormal * GROUND_RADIUS), groundCosTheta);
+				}
+
+				fms += luminanceFactor * invSamples;
+				totalLuminance += luminance * invSamples;
+			}
+
+		return totalLuminance / (Float4{ 1.f } - fms);
+	}
+
+	// rows are handed out one at a time, LUT rows differ a lot in cost near the ground
+	template<typename Body>
+	void ParallelFor(uint32_t count, uint32_t threadCount, Body const& body)
+	{
+		std::atomic<uint32_t> next{};
+		auto const            work = [&]
+		{
+			for (uint32_t index{ next++ }; index < count; index = next++)
+				body(index);
+		};
+
+		std::vector<std::thread> threads{};
+		threads.reserve(threadCount - 1);
+		for (uint32_t thread{ 1 }; thread < threadCount; ++thread)
+			threads.emplace_back(work);
+		work();
+		for (std::thread& thread: threads)
+			thread.join();
+	}
+
+	uint16_t ToUnorm16(float value)
+	{
+		return static_cast<uint16_t>(std::lround(std::clamp(value, .0f, 1.f) * 65535.f));
+	}
+
+	// round to nearest even, overflow goes to infinity and NaN stays NaN
+	uint16_t ToHalf(float value)
+	{
+		uint32_t bits{};
+		std::memcpy(&bits, &value, sizeof(bits));
+		uint32_t const sign{ (bits >> 16) & 0x8000u };
+		uint32_t const absolute{ bits & 0x7fffffffu };
+
+		if (absolute >= 0x7f800000u)
+			return static_cast<uint16_t>(sign | 0x7c00u | (absolute > 0x7f800000u ? 0x200u : 0u));
+		if (absolute >= 0x477ff000u)
+			return static_cast<uint16_t>(sign | 0x7c00u);
+		if (absolute < 0x38800000u)
+		{
+			// subnormal half, the float is scaled so the addition rounds at the right bit
+			float       magnitude{};
+			std::memcpy(&magnitude, &absolute, sizeof(magnitude));
+			float const scaled{ magnitude + .5f };
+			uint32_t    scaledBits{};
+			std::memcpy(&scaledBits, &scaled, sizeof(scaledBits));
+			return static_cast<uint16_t>(sign | (scaledBits - 0x3f000000u));
+		}
+
+		uint32_t const odd{ (absolute >> 13) & 1u };
+		return static_cast<uint16_t>(sign | ((absolute + 0xc8000fffu + odd) >> 13));
+	}
+
+	template<bool Spectral>
+	void BakeLUTs(BakedLUTs& luts, LUTSamples samples, LUTSize transmittanceSize, LUTSize multScatteringSize)
+	{
+		luts.Transmittance.resize(static_cast<size_t>(transmittanceSize.Width) * transmittanceSize.Height * 4);
+		luts.MultScattering.resize(static_cast<size_t>(multScatteringSize.Width) * multScatteringSize.Height * 4);
+
+		auto start{ std::chrono::steady_clock::now() };
+		ParallelFor(transmittanceSize.Height
+					, luts.ThreadCount
+					, [&](uint32_t row)
+					{
+						// texel centers, as the compute version and the fullscreen triangle interpolate them
+						float const height{ std::lerp(GROUND_RADIUS, ATMOSPHERE_RADIUS, (static_cast<float>(row) + .5f) / static_cast<float>(transmittanceSize.Height)) };
+						for (uint32_t column{}; column < transmittanceSize.Width; ++column)
+						{
+							float const cosTheta{ 2.f * (static_cast<float>(column) + .5f) / static_cast<float>(transmittanceSize.Width) - 1.f };
+							std::array<float, 4> const texel{
+								CalculateTransmittance<Spectral>(glm::vec3{ .0f, height, .0f }, cosTheta, static_cast<int>(samples.OpticalDepth)).ToArray()
+							};
+							for (size_t channel{}; channel < texel.size(); ++channel)
+								luts.Transmittance[(static_cast<size_t>(row) * transmittanceSize.Width + column) * 4 + channel] = ToUnorm16(texel[channel]);
+						}
+					});
+		luts.TransmittanceMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		start = std::chrono::steady_clock::now();
+		TransmittanceSampler const transmittanceLUT{ luts.Transmittance, transmittanceSize };
+		ParallelFor(multScatteringSize.Height
+					, luts.ThreadCount
+					, [&](uint32_t row)
+					{
+						float const height{ std::lerp(GROUND_RADIUS, ATMOSPHERE_RADIUS, (static_cast<float>(row) + .5f) / static_cast<float>(multScatteringSize.Height)) };
+						for (uint32_t column{}; column < multScatteringSize.Width; ++column)
+						{
+							float const          cosTheta{ 2.f * (static_cast<float>(column) + .5f) / static_cast<float>(multScatteringSize.Width) - 1.f };
+							glm::vec3 const      sunDirection{ .0f, cosTheta, std::sin(SafeAcos(cosTheta)) };
+							std::array<float, 4> texel{
+								CalculateMultipleScattering<Spectral>(transmittanceLUT
+																	  , glm::vec3{ .0f, height, .0f }
+																	  , sunDirection
+																	  , static_cast<int>(samples.Sqrt)
+																	  , static_cast<int>(samples.MultipleScattering)).ToArray()
+							};
+							for (size_t channel{}; channel < texel.size(); ++channel)
+								luts.MultScattering[(static_cast<size_t>(row) * multScatteringSize.Width + column) * 4 + channel] = ToHalf(texel[channel]);
+						}
+					});
+		luts.MultScatteringMilliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+BakedLUTs BakeStaticLUTs
+(
+	bool         spectral
+	, LUTSamples samples
+	, LUTSize    transmittance
+	, LUTSize    multScattering
+	, uint32_t   threadCount
+)
+{
+	BakedLUTs luts{};
+	luts.ThreadCount = threadCount == 0 ? std::max(std::thread::hardware_concurrency(), 1u) : threadCount;
+	if (spectral)
+		BakeLUTs<true>(luts, samples, transmittance, multScattering);
+	else
+		BakeLUTs<false>(luts, samples, transmittance, multScattering);
+	return luts;
+}
+
+float FromHalf(uint16_t value)
+{
+	uint32_t const sign{ static_cast<uint32_t>(value & 0x8000u) << 16 };
+	uint32_t const exponent{ (value >> 10) & 0x1fu };
+	uint32_t const mantissa{ value & 0x3ffu };
+
+	float result{};
+	if (exponent == 0)
+		result = std::ldexp(static_cast<float>(mantissa), -24);
+	else if (exponent == 31)
+		result = mantissa ? std::numeric_limits<float>::quiet_NaN() : std::numeric_limits<float>::infinity();
+	else
+		result = std::ldexp(static_cast<float>(mantissa | 0x400u), static_cast<int>(exponent) - 25);
+	return sign ? -result : result;
+}
+
+LUTDifference CompareLUTs(std::span<uint16_t const> expected, std::span<uint16_t const> actual, bool halfFloat, uint32_t channelCount)
+{
+	LUTDifference difference{};
+	double        squaredSum{};
+	size_t        count{};
+	for (size_t index{}; index < std::min(expected.size(), actual.size()); ++index)
+	{
+		if (index % 4 >= channelCount)
+			continue;
+
+		float const expectedValue{ halfFloat ? FromHalf(expected[index]) : expected[index] / 65535.f };
+		float const actualValue{ halfFloat ? FromHalf(actual[index]) : actual[index] / 65535.f };
+		float const absolute{ std::abs(expectedValue - actualValue) };
+
+		difference.MaxAbsolute = std::max(difference.MaxAbsolute, absolute);
+		difference.MaxExpected = std::max(difference.MaxExpected, std::abs(expectedValue));
+		squaredSum += static_cast<double>(absolute) * absolute;
+		++count;
+	}
+	difference.RootMeanSquare = count ? static_cast<float>(std::sqrt(squaredSum / static_cast<double>(count))) : .0f;
+	return difference;
+}
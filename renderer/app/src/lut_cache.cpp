@@ -0,0 +1,96 @@
+#include "lut_cache.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+	uint32_t constexpr MAGIC{ 0x4354554c }; // "LUTC"
+	uint32_t constexpr VERSION{ 1 };
+
+	struct Header
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint64_t Key;
+		uint64_t TransmittanceSize;
+		uint64_t MultScatteringSize;
+	};
+}
+
+uint64_t HashBytes(std::span<std::byte const> bytes, uint64_t seed)
+{
+	uint64_t hash{ seed };
+	for (std::byte const byte: bytes)
+	{
+		hash ^= static_cast<uint64_t>(byte);
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+std::optional<LUTCacheEntry> LoadLUTCache
+(std::filesystem::path const& path, uint64_t key, size_t transmittanceSize, size_t multScatteringSize)
+{
+	if (!std::filesystem::exists(path))
+		return std::nullopt;
+
+	LUTCacheEntry entry{};
+	try
+	{
+		entry.File = MappedFile{ path };
+	}
+	catch (std::runtime_error const& error)
+	{
+		std::cerr << error.what() << std::endl;
+		return std::nullopt;
+	}
+
+	std::span<std::byte const> const data{ entry.File.GetData() };
+	if (data.size() != sizeof(Header) + transmittanceSize + multScatteringSize)
+		return std::nullopt;
+
+	Header header{};
+	std::memcpy(&header, data.data(), sizeof(Header));
+	if (header.Magic != MAGIC ||
+		header.Version != VERSION ||
+		header.Key != key ||
+		header.TransmittanceSize != transmittanceSize ||
+		header.MultScatteringSize != multScatteringSize)
+		return std::nullopt;
+
+	entry.Transmittance  = data.subspan(sizeof(Header), transmittanceSize);
+	entry.MultScattering = data.subspan(sizeof(Header) + transmittanceSize, multScatteringSize);
+	return entry;
+}
+
+void SaveLUTCache
+(
+	std::filesystem::path const& path, uint64_t key
+	, std::span<std::byte const> transmittance, std::span<std::byte const> multScattering
+)
+{
+	Header const header{ MAGIC, VERSION, key, transmittance.size(), multScattering.size() };
+
+	// write next to the target and rename, so a concurrent reader never maps a half written file
+	std::filesystem::path temporaryPath{ path };
+	temporaryPath += ".tmp";
+	//
+	{
+		std::ofstream file{ temporaryPath, std::ios::binary | std::ios::trunc };
+		if (!file)
+		{
+			std::cerr << "failed to write LUT cache " << temporaryPath << std::endl;
+			return;
+		}
+		file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+		file.write(reinterpret_cast<char const*>(transmittance.data()), static_cast<std::streamsize>(transmittance.size()));
+		file.write(reinterpret_cast<char const*>(multScattering.data()), static_cast<std::streamsize>(multScattering.size()));
+	}
+
+	std::error_code error{};
+	std::filesystem::rename(temporaryPath, path, error);
+	if (error)
+		std::cerr << "failed to write LUT cache " << path << ": " << error.message() << std::endl;
+}
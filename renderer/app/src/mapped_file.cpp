@@ -0,0 +1,119 @@
+#include "mapped_file.h"
+
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(std::filesystem::path const& path)
+{
+#ifdef _WIN32
+	HANDLE const file = CreateFileW(path.c_str()
+									, GENERIC_READ
+									, FILE_SHARE_READ
+									, nullptr
+									, OPEN_EXISTING
+									, FILE_ATTRIBUTE_NORMAL
+									, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		throw std::runtime_error("failed to open file " + path.string());
+	m_FileHandle = file;
+
+	LARGE_INTEGER size{};
+	if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+	{
+		Unmap();
+		throw std::runtime_error("failed to query size of " + path.string());
+	}
+	m_Size = static_cast<size_t>(size.QuadPart);
+
+	m_MappingHandle = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!m_MappingHandle)
+	{
+		Unmap();
+		throw std::runtime_error("failed to create file mapping for " + path.string());
+	}
+
+	m_Data = MapViewOfFile(m_MappingHandle, FILE_MAP_READ, 0, 0, 0);
+	if (!m_Data)
+	{
+		Unmap();
+		throw std::runtime_error("failed to map " + path.string());
+	}
+#else
+	int const file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+		throw std::runtime_error("failed to open file " + path.string());
+
+	struct stat status{};
+	if (fstat(file, &status) != 0 || status.st_size == 0)
+	{
+		close(file);
+		throw std::runtime_error("failed to query size of " + path.string());
+	}
+	m_Size = static_cast<size_t>(status.st_size);
+
+	void* const data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file); // mapping stays valid after the descriptor is closed
+	if (data == MAP_FAILED)
+		throw std::runtime_error("failed to map " + path.string());
+	m_Data = data;
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+	Unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+	: m_Data{ std::exchange(other.m_Data, nullptr) }
+	, m_Size{ std::exchange(other.m_Size, 0) }
+#ifdef _WIN32
+	, m_FileHandle{ std::exchange(other.m_FileHandle, nullptr) }
+	, m_MappingHandle{ std::exchange(other.m_MappingHandle, nullptr) }
+#endif
+{}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		Unmap();
+		m_Data = std::exchange(other.m_Data, nullptr);
+		m_Size = std::exchange(other.m_Size, 0);
+#ifdef _WIN32
+		m_FileHandle    = std::exchange(other.m_FileHandle, nullptr);
+		m_MappingHandle = std::exchange(other.m_MappingHandle, nullptr);
+#endif
+	}
+	return *this;
+}
+
+void MappedFile::Unmap()
+{
+#ifdef _WIN32
+	if (m_Data)
+		UnmapViewOfFile(m_Data);
+	if (m_MappingHandle)
+		CloseHandle(m_MappingHandle);
+	if (m_FileHandle)
+		CloseHandle(m_FileHandle);
+	m_FileHandle    = nullptr;
+	m_MappingHandle = nullptr;
+#else
+	if (m_Data)
+		munmap(const_cast<void*>(m_Data), m_Size);
+#endif
+	m_Data = nullptr;
+	m_Size = 0;
+}
@@ -0,0 +1,233 @@
+#include "pipeline_cache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "mapped_file.h"
+
+namespace
+{
+	uint32_t constexpr MAGIC{ 0x43504c50 }; // "PLPC"
+	uint32_t constexpr VERSION{ 1 };
+
+	// the driver checks its own header as well, this one also rejects data from an older driver version
+	struct Header
+	{
+		uint32_t Magic;
+		uint32_t Version;
+		uint32_t VendorID;
+		uint32_t DeviceID;
+		uint32_t DriverVersion;
+		uint8_t  PipelineCacheUUID[VK_UUID_SIZE];
+		uint64_t DataSize;
+	};
+
+	Header MakeHeader(VkPhysicalDeviceProperties const& properties, uint64_t dataSize)
+	{
+		Header header{ MAGIC, VERSION, properties.vendorID, properties.deviceID, properties.driverVersion, {}, dataSize };
+		std::memcpy(header.PipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE);
+		return header;
+	}
+
+	bool operator==(Header const& lhs, Header const& rhs)
+	{
+		return lhs.Magic == rhs.Magic &&
+			   lhs.Version == rhs.Version &&
+			   lhs.VendorID == rhs.VendorID &&
+			   lhs.DeviceID == rhs.DeviceID &&
+			   lhs.DriverVersion == rhs.DriverVersion &&
+			   std::memcmp(lhs.PipelineCacheUUID, rhs.PipelineCacheUUID, VK_UUID_SIZE) == 0 &&
+			   lhs.DataSize == rhs.DataSize;
+	}
+}
+
+thread_local PipelineCache::Scope* PipelineCache::Scope::m_Active{};
+
+PipelineCache::PipelineCache(vkc::Context const& context, VkPhysicalDeviceProperties const& properties, std::filesystem::path path)
+	: m_Path{ std::move(path) }
+	, m_Properties{ properties }
+{
+	MappedFile                 file{};
+	std::span<std::byte const> initialData{};
+	if (!m_Path.empty() && std::filesystem::exists(m_Path))
+	{
+		try
+		{
+			file = MappedFile{ m_Path };
+		}
+		catch (std::runtime_error const& error)
+		{
+			std::cerr << error.what() << std::endl;
+		}
+
+		std::span<std::byte const> const data{ file.GetData() };
+		Header                           header{};
+		if (data.size() >= sizeof(Header))
+			std::memcpy(&header, data.data(), sizeof(Header));
+
+		Header const expected{ MakeHeader(properties, data.size() - std::min(data.size(), sizeof(Header))) };
+		if (header == expected)
+		{
+			initialData = data.subspan(sizeof(Header));
+			m_Loaded    = true;
+			std::cout << "pipeline cache loaded from " << m_Path << std::endl;
+		}
+		else
+			std::cout << "pipeline cache " << m_Path << " does not match this device or driver, starting empty" << std::endl;
+	}
+
+	VkPipelineCacheCreateInfo createInfo{};
+	createInfo.sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	createInfo.initialDataSize = initialData.size();
+	createInfo.pInitialData    = initialData.data();
+	if (context.DispatchTable.createPipelineCache(&createInfo, nullptr, &m_Cache) != VK_SUCCESS)
+		throw std::runtime_error("failed to create pipeline cache");
+}
+
+VkResult PipelineCache::CreateComputePipelines
+(
+	vkc::Context const&                            context
+	, std::span<VkComputePipelineCreateInfo const> createInfos
+	, VkPipeline*                                  pipelines
+)
+{
+	return CreatePipelines(context.DispatchTable.fp_vkCreateComputePipelines
+						   , context.Device
+						   , VK_NULL_HANDLE
+						   , static_cast<uint32_t>(createInfos.size())
+						   , createInfos.data()
+						   , nullptr
+						   , pipelines);
+}
+
+void PipelineCache::Save(vkc::Context const& context) const
+{
+	if (m_Path.empty())
+		return;
+
+	size_t size{};
+	if (context.DispatchTable.getPipelineCacheData(m_Cache, &size, nullptr) != VK_SUCCESS)
+	{
+		std::cerr << "failed to query pipeline cache size" << std::endl;
+		return;
+	}
+	std::vector<std::byte> data(size);
+	if (context.DispatchTable.getPipelineCacheData(m_Cache, &size, data.data()) != VK_SUCCESS)
+	{
+		std::cerr << "failed to read pipeline cache" << std::endl;
+		return;
+	}
+	data.resize(size);
+
+	Header const header{ MakeHeader(m_Properties, data.size()) };
+
+	// write next to the target and rename, same as the LUT cache
+	std::filesystem::path temporaryPath{ m_Path };
+	temporaryPath += ".tmp";
+	//
+	{
+		std::ofstream file{ temporaryPath, std::ios::binary | std::ios::trunc };
+		if (!file)
+		{
+			std::cerr << "failed to write pipeline cache " << temporaryPath << std::endl;
+			return;
+		}
+		file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+		file.write(reinterpret_cast<char const*>(data.data()), static_cast<std::streamsize>(data.size()));
+	}
+
+	std::error_code error{};
+	std::filesystem::rename(temporaryPath, m_Path, error);
+	if (error)
+		std::cerr << "failed to write pipeline cache " << m_Path << ": " << error.message() << std::endl;
+}
+
+void PipelineCache::Destroy(vkc::Context const& context) const
+{
+	context.DispatchTable.destroyPipelineCache(m_Cache, nullptr);
+}
+
+PipelineCache::Scope::Scope(PipelineCache& cache, vkc::Context& context)
+	: m_Cache{ cache }
+	, m_Context{ context }
+	, m_Create{ context.DispatchTable.fp_vkCreateGraphicsPipelines }
+	, m_Previous{ m_Active }
+{
+	m_Active                                           = this;
+	context.DispatchTable.fp_vkCreateGraphicsPipelines = &CreateGraphicsPipelines;
+}
+
+PipelineCache::Scope::~Scope()
+{
+	m_Context.DispatchTable.fp_vkCreateGraphicsPipelines = m_Create;
+	m_Active                                             = m_Previous;
+}
+
+VkResult PipelineCache::Scope::CreateGraphicsPipelines
+(
+	VkDevice                              device
+	, VkPipelineCache                     cache
+	, uint32_t                            count
+	, VkGraphicsPipelineCreateInfo const* createInfos
+	, VkAllocationCallbacks const*        allocator
+	, VkPipeline*                         pipelines
+)
+{
+	Scope const& scope{ *m_Active };
+	return scope.m_Cache.CreatePipelines(scope.m_Create, device, cache, count, createInfos, allocator, pipelines);
+}
+
+template<typename CreateInfo, typename CreateFunction>
+VkResult PipelineCache::CreatePipelines
+(
+	CreateFunction                 create
+	, VkDevice                     device
+	, VkPipelineCache              cache
+	, uint32_t                     count
+	, CreateInfo const*            createInfos
+	, VkAllocationCallbacks const* allocator
+	, VkPipeline*                  pipelines
+)
+{
+	if (cache != VK_NULL_HANDLE)
+		return create(device, cache, count, createInfos, allocator, pipelines);
+
+	// creation feedback is chained in front of whatever the caller passed, the caller's structs stay untouched
+	std::vector<CreateInfo>                              chainedInfos(createInfos, createInfos + count);
+	std::vector<VkPipelineCreationFeedback>              feedbacks(count);
+	std::vector<std::vector<VkPipelineCreationFeedback>> stageFeedbacks(count);
+	std::vector<VkPipelineCreationFeedbackCreateInfo>    feedbackInfos(count);
+	for (uint32_t index{}; index < count; ++index)
+	{
+		uint32_t stageCount{ 1 };
+		if constexpr (std::is_same_v<CreateInfo, VkGraphicsPipelineCreateInfo>)
+			stageCount = chainedInfos[index].stageCount;
+		stageFeedbacks[index].resize(stageCount);
+
+		feedbackInfos[index].sType                              = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO;
+		feedbackInfos[index].pNext                              = chainedInfos[index].pNext;
+		feedbackInfos[index].pPipelineCreationFeedback          = &feedbacks[index];
+		feedbackInfos[index].pipelineStageCreationFeedbackCount = stageCount;
+		feedbackInfos[index].pPipelineStageCreationFeedbacks    = stageFeedbacks[index].data();
+		chainedInfos[index].pNext                               = &feedbackInfos[index];
+	}
+
+	auto const     start{ std::chrono::steady_clock::now() };
+	VkResult const result{ create(device, m_Cache, count, chainedInfos.data(), allocator, pipelines) };
+
+	Statistics& statistics{ m_Statistics };
+	statistics.Milliseconds += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	statistics.Pipelines += count;
+	for (VkPipelineCreationFeedback const& feedback: feedbacks)
+		if ((feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT) &&
+			(feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT))
+			++statistics.Hits;
+
+	return result;
+}
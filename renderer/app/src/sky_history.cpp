@@ -0,0 +1,44 @@
+#include "sky_history.h"
+
+#include <cmath>
+
+namespace
+{
+	// consecutive frames alternate the diagonals of the 2x2 block so every pixel is at most 3 frames old
+	uint32_t constexpr BLOCK_PHASES[]{ 0, 3, 1, 2 };
+}
+
+SkyHistory::SkyHistory(uint32_t pattern, float maxSunDrift, float maxCameraDrift, float maxRotation)
+	: m_Pattern{ pattern }
+	, m_MaxSunDrift{ maxSunDrift }
+	, m_MaxCameraDrift{ maxCameraDrift }
+	, m_MinForwardCos{ std::cos(maxRotation) }
+{
+}
+
+SkyHistory::Frame SkyHistory::Advance(float sunAltitude, glm::vec3 cameraPosition, glm::mat3 const& basis)
+{
+	uint32_t const step{ static_cast<uint32_t>(m_Frame % m_Pattern) };
+	Frame          frame{ m_Pattern == 4 ? BLOCK_PHASES[step] : step };
+	// the first frame and the frames after Invalidate are not counted as rejected
+	if (m_Previous)
+	{
+		frame.PreviousBasis = m_Previous->Basis;
+		frame.HistoryValid  = std::abs(sunAltitude - m_Previous->SunAltitude) <= m_MaxSunDrift
+							  && glm::distance(cameraPosition, m_Previous->CameraPosition) <= m_MaxCameraDrift
+							  && glm::dot(basis[2], m_Previous->Basis[2]) >= m_MinForwardCos;
+		if (!frame.HistoryValid)
+			++m_RejectedCount;
+	}
+
+	++m_Frame;
+	m_Previous  = State{ sunAltitude, cameraPosition, basis };
+	m_LastFrame = frame;
+	m_ShadedFractionSum += GetShadedFraction();
+	return frame;
+}
+
+void SkyHistory::Invalidate()
+{
+	m_Previous.reset();
+}
@@ -0,0 +1,77 @@
+#include "skyview_schedule.h"
+
+#include <algorithm>
+#include <cmath>
+
+SkyviewSchedule::SkyviewSchedule(uint32_t rowCount, uint32_t rowsPerFrame, float maxSunDrift, float maxAltitudeDrift)
+	: m_MaxSunDrift{ maxSunDrift }
+	, m_MaxAltitudeDrift{ maxAltitudeDrift }
+{
+	if (rowsPerFrame == 0 || rowsPerFrame >= rowCount)
+		return;
+
+	for (uint32_t first{}; first < rowCount; first += rowsPerFrame)
+		m_Bands.emplace_back(Band{ SkyviewRows{ first, std::min(rowsPerFrame, rowCount - first) } });
+
+	// the LUT maps elevation zero to the middle row, see ConvertToElevation in skyview_lut.glsl
+	m_HorizonBand = rowCount / 2 / rowsPerFrame;
+}
+
+std::vector<SkyviewRows> SkyviewSchedule::Advance(float sunAltitude, float cameraAltitude)
+{
+	++m_Frame;
+	if (!IsAmortized())
+		return {};
+
+	bool const forceFull = std::ranges::any_of(m_Bands
+											   , [this, sunAltitude, cameraAltitude](Band const& band)
+											   {
+												   return !band.Valid ||
+														  std::abs(sunAltitude - band.SunAltitude) > m_MaxSunDrift ||
+														  std::abs(cameraAltitude - band.CameraAltitude) > m_MaxAltitudeDrift;
+											   });
+	if (forceFull)
+	{
+		// the first fill is not counted as forced
+		if (std::ranges::all_of(m_Bands, &Band::Valid))
+			++m_ForcedRefreshCount;
+		for (Band& band: m_Bands)
+			Refresh(band, sunAltitude, cameraAltitude);
+		return {};
+	}
+
+	std::vector<SkyviewRows> rows{ m_Bands[m_HorizonBand].Rows };
+	Refresh(m_Bands[m_HorizonBand], sunAltitude, cameraAltitude);
+
+	if (m_NextBand == m_HorizonBand)
+		m_NextBand = (m_NextBand + 1) % m_Bands.size();
+	if (m_NextBand != m_HorizonBand)
+	{
+		rows.emplace_back(m_Bands[m_NextBand].Rows);
+		Refresh(m_Bands[m_NextBand], sunAltitude, cameraAltitude);
+	}
+	m_NextBand = (m_NextBand + 1) % m_Bands.size();
+
+	// what the sky pass samples this frame, after the refreshed bands are redrawn
+	for (Band const& band: m_Bands)
+	{
+		m_WorstStaleness.Frames         = std::max(m_WorstStaleness.Frames, m_Frame - band.Frame);
+		m_WorstStaleness.SunAngle       = std::max(m_WorstStaleness.SunAngle, std::abs(sunAltitude - band.SunAltitude));
+		m_WorstStaleness.CameraAltitude = std::max(m_WorstStaleness.CameraAltitude, std::abs(cameraAltitude - band.CameraAltitude));
+	}
+	return rows;
+}
+
+void SkyviewSchedule::Invalidate()
+{
+	for (Band& band: m_Bands)
+		band.Valid = false;
+}
+
+void SkyviewSchedule::Refresh(Band& band, float sunAltitude, float cameraAltitude) const
+{
+	band.Frame          = m_Frame;
+	band.SunAltitude    = sunAltitude;
+	band.CameraAltitude = cameraAltitude;
+	band.Valid          = true;
+}
@@ -0,0 +1,183 @@
+#include "sweep.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <stdexcept>
+
+#include "lut_baker.h"
+
+namespace
+{
+	uint32_t Scale(uint32_t value, float scale, uint32_t minimum)
+	{
+		return std::max(minimum, static_cast<uint32_t>(std::lround(static_cast<float>(value) * scale)));
+	}
+
+	QualitySettings ScaleQuality(float sampleScale, float extentScale)
+	{
+		QualitySettings const defaults{};
+		QualitySettings       quality{};
+		quality.OpticalDepthSamples       = Scale(defaults.OpticalDepthSamples, sampleScale, 1);
+		quality.MultipleScatteringSamples = Scale(defaults.MultipleScatteringSamples, sampleScale, 1);
+		quality.ScatteringSamples         = Scale(defaults.ScatteringSamples, sampleScale, 1);
+		// the direction count is the square, it follows the other counts
+		quality.SqrtSamples = Scale(defaults.SqrtSamples, std::sqrt(sampleScale), 2);
+		for (auto [extent, defaultExtent]: { std::pair{ &quality.TransmittanceExtent, defaults.TransmittanceExtent }
+											 , std::pair{ &quality.MultScatteringExtent, defaults.MultScatteringExtent }
+											 , std::pair{ &quality.SkyviewExtent, defaults.SkyviewExtent } })
+			*extent = glm::uvec2{ Scale(defaultExtent.x, extentScale, 4), Scale(defaultExtent.y, extentScale, 4) };
+		return quality;
+	}
+
+	void WriteExtent(std::ostream& stream, glm::uvec2 extent)
+	{
+		stream << extent.x << 'x' << extent.y;
+	}
+}
+
+QualitySettings GetSweepReference()
+{
+	return GetQualitySettings(QualityTier::Reference);
+}
+
+std::vector<QualitySettings> GetSweepConfigurations()
+{
+	std::vector<QualitySettings> configurations{};
+	for (float const sampleScale: { .25f, .5f, 1.f, 2.f })
+		for (float const extentScale: { .5f, 1.f, 2.f })
+			for (bool const adaptive: { false, true })
+			{
+				configurations.emplace_back(ScaleQuality(sampleScale, extentScale));
+				configurations.back().AdaptiveScattering = adaptive;
+			}
+	for (float const sampleScale: { .25f, .5f, 1.f, 2.f })
+	{
+		configurations.emplace_back(ScaleQuality(sampleScale, 1.f));
+		configurations.back().OpticalDepthLUT = true;
+	}
+	return configurations;
+}
+
+double MeanScatteringSteps(std::span<std::vector<uint16_t> const> renders, size_t pixelCount)
+{
+	double steps{};
+	size_t count{};
+	for (std::vector<uint16_t> const& view: renders)
+		for (size_t index{ pixelCount * 3 }; index < pixelCount * 4; ++index)
+			if (double const value{ FromHalf(view[index]) }; value > 0.)
+			{
+				steps += value;
+				++count;
+			}
+	return count ? steps / static_cast<double>(count) : 0.;
+}
+
+ImageError CompareRenders
+(
+	std::span<std::vector<uint16_t> const>   reference
+	, std::span<std::vector<uint16_t> const> renders
+	, size_t                                 pixelCount
+)
+{
+	if (reference.size() != renders.size())
+		throw std::runtime_error("sweep renders do not match the reference views");
+
+	size_t const rgbCount{ pixelCount * 3 }; // the planes are R, G, B, A, alpha is skipped
+	double       referenceSum{};
+	for (std::vector<uint16_t> const& view: reference)
+		for (size_t index{}; index < rgbCount; ++index)
+			referenceSum += FromHalf(view[index]);
+	double const floor{ .01 * referenceSum / static_cast<double>(rgbCount * reference.size()) };
+
+	ImageError error{};
+	double     squaredSum{};
+	for (size_t view{}; view < reference.size(); ++view)
+		for (size_t index{}; index < rgbCount; ++index)
+		{
+			double const expected{ FromHalf(reference[view][index]) };
+			double const difference{ std::abs(FromHalf(renders[view][index]) - expected) };
+			squaredSum += difference * difference;
+			error.MaxRelative = std::max(error.MaxRelative, difference / std::max(std::abs(expected), floor));
+		}
+	error.RootMeanSquare = std::sqrt(squaredSum / static_cast<double>(rgbCount * reference.size()));
+	return error;
+}
+
+std::vector<SweepRow> EvaluateMeasurement(QualityMeasurement const& reference, QualityMeasurement const& measurement)
+{
+	double const staticLUTs{
+		measurement.TransmittanceMilliseconds + measurement.MultScatteringMilliseconds
+		+ (measurement.Quality.OpticalDepthLUT ? measurement.OpticalDepthMilliseconds : 0.)
+	};
+	return {
+		{
+			measurement.Quality
+			, true
+			, staticLUTs
+			, measurement.SkyviewLUTMilliseconds + measurement.SkyviewRenderMilliseconds
+			, std::numeric_limits<double>::quiet_NaN()
+			, CompareRenders(reference.RaymarchImages, measurement.SkyviewImages, measurement.PixelCount)
+			, false
+		}
+		, {
+			measurement.Quality
+			, false
+			, staticLUTs
+			, measurement.RaymarchRenderMilliseconds
+			, MeanScatteringSteps(measurement.RaymarchImages, measurement.PixelCount)
+			, CompareRenders(reference.RaymarchImages, measurement.RaymarchImages, measurement.PixelCount)
+			, false
+		}
+	};
+}
+
+void MarkParetoFront(std::span<SweepRow> rows)
+{
+	for (SweepRow& row: rows)
+		row.Pareto = std::ranges::none_of(rows
+										  , [&row](SweepRow const& other)
+										  {
+											  return other.Skyview == row.Skyview
+													 && other.FrameMilliseconds <= row.FrameMilliseconds
+													 && other.Error.RootMeanSquare <= row.Error.RootMeanSquare
+													 && (other.FrameMilliseconds < row.FrameMilliseconds
+														 || other.Error.RootMeanSquare < row.Error.RootMeanSquare);
+										  });
+}
+
+void WriteSweepTable(std::filesystem::path const& path, std::span<SweepRow const> rows)
+{
+	if (path.has_parent_path())
+		std::filesystem::create_directories(path.parent_path());
+	std::ofstream file{ path, std::ios::out | std::ios::trunc };
+	if (!file)
+		throw std::runtime_error("failed to write sweep table " + path.string());
+
+	file << std::setprecision(6);
+	file << "path,optical depth samples,multiple scattering samples,scattering samples,sqrt samples,adaptive march,optical depth LUT,"
+			"transmittance LUT,multiple scattering LUT,sky-view LUT,static LUTs ms,frame ms,mean steps,rmse,max relative error,pareto\n";
+	for (SweepRow const& row: rows)
+	{
+		QualitySettings const& quality{ row.Quality };
+		file << (row.Skyview ? "sky-view" : "ray march") << ','
+				<< quality.OpticalDepthSamples << ',' << quality.MultipleScatteringSamples << ','
+				<< quality.ScatteringSamples << ',' << quality.SqrtSamples << ',' << (quality.AdaptiveScattering ? 1 : 0) << ','
+				<< (quality.OpticalDepthLUT ? 1 : 0) << ',';
+		WriteExtent(file, quality.TransmittanceExtent);
+		file << ',';
+		WriteExtent(file, quality.MultScatteringExtent);
+		file << ',';
+		WriteExtent(file, quality.SkyviewExtent);
+		file << ',' << row.StaticLUTMilliseconds << ',' << row.FrameMilliseconds << ',';
+		// empty on the sky-view path, its steps are taken in the LUT
+		if (!std::isnan(row.MeanSteps))
+			file << row.MeanSteps;
+		file << ',' << row.Error.RootMeanSquare << ',' << row.Error.MaxRelative << ',' << (row.Pareto ? 1 : 0) << '\n';
+	}
+
+	if (!file)
+		throw std::runtime_error("failed to write sweep table " + path.string());
+}
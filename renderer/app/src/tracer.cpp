@@ -0,0 +1,134 @@
+#include "tracer.h"
+
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#endif
+
+namespace
+{
+	// chrome trace processes, one for the render thread and one with a track per queue
+	uint32_t constexpr CPU_PROCESS{ 1 };
+	uint32_t constexpr GPU_PROCESS{ 2 };
+
+	void WriteName(std::ostream& stream, std::string_view name)
+	{
+		stream << '"';
+		for (char const character: name)
+		{
+			if (character == '"' || character == '\\')
+				stream << '\\';
+			stream << character;
+		}
+		stream << '"';
+	}
+
+	void WriteMetadata(std::ostream& stream, char const* type, uint32_t process, uint32_t thread, std::string_view name)
+	{
+		stream << "{\"ph\":\"M\",\"name\":\"" << type << "\",\"pid\":" << process << ",\"tid\":" << thread << ",\"args\":{\"name\":";
+		WriteName(stream, name);
+		stream << "}}";
+	}
+}
+
+Tracer::Tracer(size_t maxEvents)
+	: m_MaxEvents{ maxEvents }
+	, m_Start{ Clock::now() }
+{
+	m_Events.reserve(maxEvents);
+}
+
+Tracer::Clock::time_point Tracer::FromHostTimeDomain(uint64_t value)
+{
+#ifdef _WIN32
+	// the standard library builds steady_clock on the performance counter
+	LARGE_INTEGER frequency{};
+	QueryPerformanceFrequency(&frequency);
+	auto const     frequencyValue{ static_cast<uint64_t>(frequency.QuadPart) };
+	uint64_t const whole{ value / frequencyValue * 1'000'000'000 };
+	uint64_t const part{ value % frequencyValue * 1'000'000'000 / frequencyValue };
+	return Clock::time_point{ std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds{ whole + part }) };
+#else
+	// libstdc++ and libc++ build steady_clock on CLOCK_MONOTONIC
+	return Clock::time_point{ std::chrono::duration_cast<Clock::duration>(std::chrono::nanoseconds{ value }) };
+#endif
+}
+
+void Tracer::AddCpu(std::string_view name, Clock::time_point begin, Clock::time_point end)
+{
+	if (m_Events.size() == m_MaxEvents)
+	{
+		++m_Dropped;
+		return;
+	}
+	m_Events.emplace_back(name
+						  , 0
+						  , false
+						  , std::chrono::duration_cast<std::chrono::nanoseconds>(begin - m_Start).count()
+						  , std::chrono::duration_cast<std::chrono::nanoseconds>(end - m_Start).count());
+}
+
+void Tracer::AddGpu(std::string_view name, uint32_t queue, uint64_t beginTicks, uint64_t endTicks)
+{
+	if (m_Events.size() == m_MaxEvents)
+	{
+		++m_Dropped;
+		return;
+	}
+	m_Events.emplace_back(name, queue, true, static_cast<int64_t>(beginTicks), static_cast<int64_t>(endTicks));
+}
+
+double Tracer::ToMicroseconds(Event const& event, int64_t value) const
+{
+	if (!event.Gpu)
+		return static_cast<double>(value) / 1000.;
+
+	// ticks are converted relative to the calibration point, so only differences of the 64 bit values are taken
+	double const calibrationNanoseconds{ std::chrono::duration<double, std::nano>(m_Calibration.CpuTime - m_Start).count() };
+	double const ticks{ static_cast<double>(value - static_cast<int64_t>(m_Calibration.GpuTicks)) };
+	return (calibrationNanoseconds + ticks * m_Calibration.NanosecondsPerTick) / 1000.;
+}
+
+void Tracer::Write(std::filesystem::path const& path, std::vector<std::string_view> const& queueNames) const
+{
+	if (path.has_parent_path())
+		std::filesystem::create_directories(path.parent_path());
+	std::ofstream file{ path, std::ios::out | std::ios::trunc };
+	if (!file)
+		throw std::runtime_error("failed to write trace " + path.string());
+
+	file << std::fixed << std::setprecision(3);
+	file << "{\"displayTimeUnit\":\"ms\",\"otherData\":{\"calibration_uncertainty_us\":"
+			<< m_Calibration.UncertaintyNanoseconds / 1000. << ",\"dropped_events\":" << m_Dropped << "},\n\"traceEvents\":[\n";
+	WriteMetadata(file, "process_name", CPU_PROCESS, 0, "CPU");
+	file << ",\n";
+	WriteMetadata(file, "thread_name", CPU_PROCESS, 0, "render thread");
+	file << ",\n";
+	WriteMetadata(file, "process_name", GPU_PROCESS, 0, "GPU");
+	for (uint32_t queue{}; queue < queueNames.size(); ++queue)
+	{
+		file << ",\n";
+		WriteMetadata(file, "thread_name", GPU_PROCESS, queue, queueNames[queue]);
+	}
+
+	for (Event const& event: m_Events)
+	{
+		double const begin{ ToMicroseconds(event, event.Begin) };
+		file << ",\n{\"ph\":\"X\",\"name\":";
+		WriteName(file, event.Name);
+		file << ",\"pid\":" << (event.Gpu ? GPU_PROCESS : CPU_PROCESS)
+				<< ",\"tid\":" << (event.Gpu ? event.Queue : 0)
+				<< ",\"ts\":" << begin
+				<< ",\"dur\":" << ToMicroseconds(event, event.End) - begin << "}";
+	}
+	file << "\n]}\n";
+
+	if (!file)
+		throw std::runtime_error("failed to write trace " + path.string());
+}
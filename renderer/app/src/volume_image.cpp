@@ -0,0 +1,82 @@
+#include "volume_image.h"
+
+#include <stdexcept>
+
+VolumeImage::VolumeImage(vkc::Context const& context, VkExtent3D extent, uint32_t layerCount, VkFormat format, VkImageUsageFlags usage)
+	: m_Extent{ extent }
+	, m_LayerCount{ layerCount }
+	, m_Format{ format }
+{
+	bool const is3D{ extent.depth > 1 };
+
+	VkImageCreateInfo imageCreateInfo{};
+	imageCreateInfo.sType         = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageCreateInfo.imageType     = is3D ? VK_IMAGE_TYPE_3D : VK_IMAGE_TYPE_2D;
+	imageCreateInfo.format        = format;
+	imageCreateInfo.extent        = extent;
+	imageCreateInfo.mipLevels     = 1;
+	imageCreateInfo.arrayLayers   = layerCount;
+	imageCreateInfo.samples       = VK_SAMPLE_COUNT_1_BIT;
+	imageCreateInfo.tiling        = VK_IMAGE_TILING_OPTIMAL;
+	imageCreateInfo.usage         = usage;
+	imageCreateInfo.sharingMode   = VK_SHARING_MODE_EXCLUSIVE;
+	imageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	VmaAllocationCreateInfo allocationCreateInfo{};
+	allocationCreateInfo.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+
+	if (vmaCreateImage(context.Allocator, &imageCreateInfo, &allocationCreateInfo, &m_Image, &m_Allocation, nullptr) != VK_SUCCESS)
+		throw std::runtime_error("failed to create volume image");
+
+	VkImageViewCreateInfo viewCreateInfo{};
+	viewCreateInfo.sType            = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewCreateInfo.image            = m_Image;
+	viewCreateInfo.viewType         = is3D ? VK_IMAGE_VIEW_TYPE_3D : VK_IMAGE_VIEW_TYPE_2D_ARRAY;
+	viewCreateInfo.format           = format;
+	viewCreateInfo.subresourceRange = VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, layerCount };
+
+	if (context.DispatchTable.createImageView(&viewCreateInfo, nullptr, &m_View) != VK_SUCCESS)
+	{
+		vmaDestroyImage(context.Allocator, m_Image, m_Allocation);
+		throw std::runtime_error("failed to create volume image view");
+	}
+}
+
+void VolumeImage::Destroy(vkc::Context const& context) const
+{
+	context.DispatchTable.destroyImageView(m_View, nullptr);
+	vmaDestroyImage(context.Allocator, m_Image, m_Allocation);
+}
+
+void VolumeImage::MakeTransition
+(
+	vkc::Context const&     context
+	, VkCommandBuffer       commandBuffer
+	, VkPipelineStageFlags2 srcStageMask
+	, VkAccessFlags2        srcAccessMask
+	, VkPipelineStageFlags2 dstStageMask
+	, VkAccessFlags2        dstAccessMask
+	, VkImageLayout         newLayout
+)
+{
+	VkImageMemoryBarrier2 barrier{};
+	barrier.sType               = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
+	barrier.srcStageMask        = srcStageMask;
+	barrier.srcAccessMask       = srcAccessMask;
+	barrier.dstStageMask        = dstStageMask;
+	barrier.dstAccessMask       = dstAccessMask;
+	barrier.oldLayout           = m_Layout;
+	barrier.newLayout           = newLayout;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image               = m_Image;
+	barrier.subresourceRange    = VkImageSubresourceRange{ VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, m_LayerCount };
+
+	VkDependencyInfo dependencyInfo{};
+	dependencyInfo.sType                   = VK_STRUCTURE_TYPE_DEPENDENCY_INFO;
+	dependencyInfo.imageMemoryBarrierCount = 1;
+	dependencyInfo.pImageMemoryBarriers    = &barrier;
+	context.DispatchTable.cmdPipelineBarrier2(commandBuffer, &dependencyInfo);
+
+	m_Layout = newLayout;
+}
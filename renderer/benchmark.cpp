@@ -0,0 +1,47 @@
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include "app/inc/app.h"
+
+// same options as the main executable without a command, always runs the scenario suite in app/inc/benchmark.h
+int main(int argc, char* argv[])
+{
+	LaunchOptions options{};
+	try
+	{
+		options = ParseLaunchOptions(argc, argv);
+		if (options.Mode != Command::Interactive)
+			throw std::runtime_error("the benchmark takes options only, no command");
+	}
+	catch (std::runtime_error const& error)
+	{
+		std::cerr << error.what() << '\n' << GetUsage();
+		return 1;
+	}
+	options.Mode = Command::Benchmark;
+
+	if (!options.BenchmarkResolutions)
+	{
+		App app{ options };
+
+		app.Run();
+		return 0;
+	}
+
+	// one App per resolution since the render targets are sized at creation, results get the resolution appended to the name
+	std::filesystem::path const results{ options.BenchmarkResults };
+	for (auto const [width, height]: { std::pair{ 1920, 1080 }, std::pair{ 2560, 1440 }, std::pair{ 3840, 2160 } })
+	{
+		options.Width            = width;
+		options.Height           = height;
+		options.BenchmarkResults = results.parent_path()
+								   / (results.stem().string() + "_" + std::to_string(width) + "x" + std::to_string(height)
+									  + results.extension().string());
+
+		App app{ options };
+
+		app.Run();
+	}
+	return 0;
+}
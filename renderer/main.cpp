@@ -1,9 +1,21 @@
+#include <iostream>
 
 #include "app/inc/app.h"
 
-int main()
+int main(int argc, char* argv[])
 {
-	App app{ 1920, 1080 };
+	LaunchOptions options{};
+	try
+	{
+		options = ParseLaunchOptions(argc, argv);
+	}
+	catch (std::runtime_error const& error)
+	{
+		std::cerr << error.what() << '\n' << GetUsage();
+		return 1;
+	}
+
+	App app{ options };
 
 	app.Run();
 	return 0;
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <iostream>
+#include <optional>
+
+#include "app/inc/app.h"
+
+// same options as the main executable without a command, renders every configuration of app/inc/sweep.h
+// and writes sweep.csv to --output, one App per configuration since the sample counts are baked into the pipelines
+int main(int argc, char* argv[])
+{
+	LaunchOptions options{};
+	try
+	{
+		options = ParseLaunchOptions(argc, argv);
+		if (options.Mode != Command::Interactive)
+			throw std::runtime_error("the sweep takes options only, no command");
+	}
+	catch (std::runtime_error const& error)
+	{
+		std::cerr << error.what() << '\n' << GetUsage();
+		return 1;
+	}
+	options.Mode = Command::Sweep;
+	// every configuration has to build its own LUTs
+	options.LUTCachePath.clear();
+
+	options.Quality = GetSweepReference();
+	QualityMeasurement const reference{ App{ options }.MeasureQuality() };
+	std::cout << "sweep reference measured" << std::endl;
+
+	// the default quality with every march, kept to compare the adaptive and the LUT march against the fixed one
+	QualitySettings adaptiveDefaults{};
+	adaptiveDefaults.AdaptiveScattering = true;
+	QualitySettings lutDefaults{};
+	lutDefaults.OpticalDepthLUT = true;
+	std::optional<QualityMeasurement> fixedMeasurement{};
+	std::optional<QualityMeasurement> adaptiveMeasurement{};
+	std::optional<QualityMeasurement> lutMeasurement{};
+	ImageError                        lutBound{}; // worst LUT march configuration against the reference
+
+	std::vector<SweepRow>              rows{};
+	std::vector<QualitySettings> const configurations{ GetSweepConfigurations() };
+	for (size_t index{}; index < configurations.size(); ++index)
+	{
+		options.Quality = configurations[index];
+		QualityMeasurement measurement{ App{ options }.MeasureQuality() };
+		for (SweepRow const& row: EvaluateMeasurement(reference, measurement))
+		{
+			rows.emplace_back(row);
+			if (row.Quality.OpticalDepthLUT && !row.Skyview)
+			{
+				lutBound.RootMeanSquare = std::max(lutBound.RootMeanSquare, row.Error.RootMeanSquare);
+				lutBound.MaxRelative    = std::max(lutBound.MaxRelative, row.Error.MaxRelative);
+			}
+		}
+		if (options.Quality == QualitySettings{})
+			fixedMeasurement = std::move(measurement);
+		else if (options.Quality == adaptiveDefaults)
+			adaptiveMeasurement = std::move(measurement);
+		else if (options.Quality == lutDefaults)
+			lutMeasurement = std::move(measurement);
+		std::cout << "sweep configuration " << index + 1 << "/" << configurations.size() << " done" << std::endl;
+	}
+	MarkParetoFront(rows);
+
+	if (fixedMeasurement && adaptiveMeasurement)
+	{
+		SweepRow const adaptive{ EvaluateMeasurement(*fixedMeasurement, *adaptiveMeasurement)[1] };
+		std::cout << "adaptive ray march at the default quality: " << adaptive.MeanSteps << " mean steps per pixel against "
+				<< MeanScatteringSteps(fixedMeasurement->RaymarchImages, fixedMeasurement->PixelCount) << ", "
+				<< adaptiveMeasurement->RaymarchRenderMilliseconds << " ms against " << fixedMeasurement->RaymarchRenderMilliseconds
+				<< " ms, against the fixed march rmse " << adaptive.Error.RootMeanSquare << " and max relative error "
+				<< adaptive.Error.MaxRelative << std::endl;
+	}
+	if (fixedMeasurement && lutMeasurement)
+	{
+		std::vector<SweepRow> const lut{ EvaluateMeasurement(*fixedMeasurement, *lutMeasurement) };
+		std::cout << "optical depth LUT march at the default quality: " << lutMeasurement->RaymarchRenderMilliseconds << " ms against "
+				<< fixedMeasurement->RaymarchRenderMilliseconds << " ms, sky-view LUT " << lutMeasurement->SkyviewLUTMilliseconds
+				<< " ms against " << fixedMeasurement->SkyviewLUTMilliseconds << " ms, optical depth LUT built in "
+				<< lutMeasurement->OpticalDepthMilliseconds << " ms, against the analytic march rmse " << lut[1].Error.RootMeanSquare
+				<< " and max relative error " << lut[1].Error.MaxRelative << std::endl;
+		std::cout << "optical depth LUT march against the reference, worst of every sample count: rmse " << lutBound.RootMeanSquare
+				<< " and max relative error " << lutBound.MaxRelative << std::endl;
+	}
+
+	std::filesystem::path const path{ options.OutputDirectory / "sweep.csv" };
+	WriteSweepTable(path, rows);
+	std::cout << "sweep table written to " << path << ", pareto front:" << std::endl;
+	for (SweepRow const& row: rows)
+		if (row.Pareto)
+			std::cout << "  " << (row.Skyview ? "sky-view " : "ray march") << " " << row.FrameMilliseconds << " ms, rmse "
+					<< row.Error.RootMeanSquare << ", scattering samples " << row.Quality.ScatteringSamples << ", sky-view LUT "
+					<< row.Quality.SkyviewExtent.x << "x" << row.Quality.SkyviewExtent.y << std::endl;
+	return 0;
+}